@@ -0,0 +1,130 @@
+// fan-out under contention: mutex+condvar deque vs mpmc, from 2 to 64 threads
+// (half producers, half consumers, same total number of messages each run)
+// build: cc -O2 bench/bench_mpmc.c -o bench_mpmc -pthread
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../std/deque.h"
+#include "../std/queue.h"
+
+#define MESSAGES 2000000
+#define CAPACITY 1024
+#define MAX_THREADS 64
+
+typedef mpmc(u64) mpmc_u64;
+typedef deque(u64) deque_u64;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// producers push per_producer values, then each consumer gets one stop value
+static const u64 STOP = (u64) -1;
+static u64 per_producer;
+static u64 sums[MAX_THREADS];
+
+
+// baseline: bounded deque behind a mutex with not-full/not-empty condvars
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+    deque_u64 d;
+} locked = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, null };
+
+static void locked_push(u64 x) {
+    pthread_mutex_lock(&locked.lock);
+    while (deque_len(locked.d) == CAPACITY) pthread_cond_wait(&locked.not_full, &locked.lock);
+    deque_push_back(locked.d, x);
+    pthread_cond_signal(&locked.not_empty);
+    pthread_mutex_unlock(&locked.lock);
+}
+
+static u64 locked_pop() {
+    pthread_mutex_lock(&locked.lock);
+    while (deque_is_empty(locked.d)) pthread_cond_wait(&locked.not_empty, &locked.lock);
+    u64 x = deque_pop_front(locked.d);
+    pthread_cond_signal(&locked.not_full);
+    pthread_mutex_unlock(&locked.lock);
+    return x;
+}
+
+static void* locked_producer(void* arg) {
+    (void) arg;
+    for (u64 i = 1; i <= per_producer; i++) locked_push(i);
+    return null;
+}
+
+static void* locked_consumer(void* arg) {
+    u64 sum = 0, x;
+    while ((x = locked_pop()) != STOP) sum += x;
+    sums[(usize) arg] = sum;
+    return null;
+}
+
+
+// mpmc with the blocking push/pop
+
+static mpmc_u64 q;
+
+static void* mpmc_producer(void* arg) {
+    (void) arg;
+    for (u64 i = 1; i <= per_producer; i++) mpmc_push(q, i);
+    return null;
+}
+
+static void* mpmc_consumer(void* arg) {
+    u64 sum = 0, x;
+    for (;;) {
+        mpmc_pop(q, x);
+        if (x == STOP) break;
+        sum += x;
+    }
+    sums[(usize) arg] = sum;
+    return null;
+}
+
+
+static double run(int threads, void* (*producer)(void*), void* (*consumer)(void*), void (*stop)(u64)) {
+    int half = threads / 2;
+    pthread_t p[MAX_THREADS], c[MAX_THREADS];
+    per_producer = MESSAGES / half;
+    memset(sums, 0, sizeof(sums));
+    double t = now();
+    for (int i = 0; i < half; i++) pthread_create(&c[i], null, consumer, (void*) (usize) i);
+    for (int i = 0; i < half; i++) pthread_create(&p[i], null, producer, null);
+    for (int i = 0; i < half; i++) pthread_join(p[i], null);
+    for (int i = 0; i < half; i++) stop(STOP);
+    for (int i = 0; i < half; i++) pthread_join(c[i], null);
+    t = now() - t;
+    u64 sum = 0;
+    for (int i = 0; i < half; i++) sum += sums[i];
+    if (sum != (u64) half * per_producer * (per_producer + 1) / 2) printf("bad sum with %d threads\n", threads);
+    return t;
+}
+
+static void mpmc_stop(u64 x) {
+    mpmc_push(q, x);
+}
+
+int main() {
+    deque_init(locked.d);
+    deque_reserve(locked.d, CAPACITY);
+    mpmc_init(q, CAPACITY);
+    printf("%-8s %14s %14s\n", "threads", "mutex+deque", "mpmc");
+    for (int threads = 2; threads <= MAX_THREADS; threads *= 2) {
+        double a = run(threads, locked_producer, locked_consumer, locked_push);
+        double b = run(threads, mpmc_producer, mpmc_consumer, mpmc_stop);
+        printf("%-8d %9.1f M/s %9.1f M/s\n", threads, MESSAGES / a / 1e6, MESSAGES / b / 1e6);
+    }
+    mpmc_free(q);
+    deque_free(locked.d);
+    return 0;
+}
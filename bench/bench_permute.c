@@ -0,0 +1,108 @@
+// bulk permutations at several element sizes: reverse (old byte-at-a-time swaps vs the
+// word/SIMD kernel), rotate, swap_ranges, and gather/scatter through a random permutation
+// build: cc -O2 bench/bench_permute.c -o bench_permute
+// run:   ./bench_permute [total bytes]   (default 64 MB, use something cache-sized to see the kernels)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../std/vec.h"
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// what vec_reverse did before: vec_swap per pair, one byte at a time
+static void byte_reverse(void* data, usize n, usize memsz) {
+    for (usize i = 0, j = n - 1; i < n / 2; i++, j--) {
+        unsigned char* a = (unsigned char*) data + i * memsz;
+        unsigned char* b = (unsigned char*) data + j * memsz;
+        for (usize k = 0; k < memsz; k++) {
+            unsigned char t = a[k];
+            a[k] = b[k];
+            b[k] = t;
+        }
+    }
+}
+
+typedef struct { u8 b[3]; } u24;
+typedef struct { u64 a, b; } u128;
+typedef struct { u64 a, b, c; } u192;
+
+static usize bytes = 64u << 20;
+static u32* perm;
+static usize perm_n;
+
+// random permutation of [0, n) for gather/scatter, reused across element sizes
+static void make_perm(usize n) {
+    if (perm_n == n) return;
+    free(perm);
+    perm = malloc(n * sizeof(u32));
+    for (usize i = 0; i < n; i++) perm[i] = i;
+    srand(1);
+    for (usize i = n - 1; i > 0; i--) {
+        usize j = ((usize) rand() * RAND_MAX + rand()) % (i + 1);
+        u32 t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+    }
+    perm_n = n;
+}
+
+static void report(const char* name, usize memsz, double t, usize n) {
+    printf("%-7zu %-24s %9.2f ms  %7.2f GB/s\n", memsz, name, t * 1e3, n * memsz / t / 1e9);
+}
+
+// one row per operation for element type T
+#define BENCH(T)                                                                      \
+  do {                                                                                \
+    usize n = bytes / sizeof(T);                                                      \
+    vec(T) v;                                                                         \
+    vec(T) w;                                                                         \
+    vec_init(v);                                                                      \
+    vec_init(w);                                                                      \
+    vec_reserve(v, n);                                                                \
+    v->len = n;                                                                       \
+    memset(v->data, 1, n * sizeof(T));                                                \
+    make_perm(n);                                                                     \
+    double t = now();                                                                 \
+    byte_reverse(v->data, n, sizeof(T));                                              \
+    report("reverse (byte swaps)", sizeof(T), now() - t, n);                          \
+    t = now();                                                                        \
+    vec_reverse(v);                                                                   \
+    report("vec_reverse", sizeof(T), now() - t, n);                                   \
+    t = now();                                                                        \
+    vec_rotate(v, n / 3);                                                             \
+    report("vec_rotate (n/3)", sizeof(T), now() - t, n);                              \
+    t = now();                                                                        \
+    vec_rotate(v, 5);                                                                 \
+    report("vec_rotate (5)", sizeof(T), now() - t, n);                                \
+    t = now();                                                                        \
+    vec_swap_ranges(v, 0, n / 2, n / 2);                                              \
+    report("vec_swap_ranges (n/2)", sizeof(T), now() - t, n);                         \
+    t = now();                                                                        \
+    vec_gather(w, v, perm, n);                                                        \
+    report("vec_gather", sizeof(T), now() - t, n);                                    \
+    t = now();                                                                        \
+    vec_scatter(v, w, perm);                                                          \
+    report("vec_scatter", sizeof(T), now() - t, n);                                   \
+    vec_free(v);                                                                      \
+    vec_free(w);                                                                      \
+  } while (0)
+
+int main(int argc, char** argv) {
+    if (argc > 1) bytes = strtoull(argv[1], null, 10);
+    printf("%zu MB per run\n%-7s %-24s %12s  %12s\n", bytes >> 20, "memsz", "operation", "time", "bandwidth");
+    BENCH(u8);
+    BENCH(u32);
+    BENCH(u64);
+    BENCH(u24);
+    BENCH(u128);
+    BENCH(u192);
+    free(perm);
+    return 0;
+}
@@ -0,0 +1,102 @@
+// churn benchmark: pool vs malloc for map entries and str headers
+// build both ways and compare the map/str numbers:
+//   cc -O2 bench/bench_pool.c -o bench_pool -pthread
+//   cc -O2 -DSTD_USE_POOL bench/bench_pool.c -o bench_pool_on -pthread
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../std/map.h"
+#include "../std/pool.h"
+#include "../std/str.h"
+
+#define LIVE 100000
+#define CYCLES 2000000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned rng = 1;
+
+static unsigned next() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+int main() {
+    // raw churn: keep LIVE objects alive, replace a random one each cycle
+    usize entry_size = STD_MAP_SIZEOF_ENTRY((map_double) null);
+    void** live = malloc(LIVE * sizeof(void*));
+    double t;
+
+    rng = 1;
+    for (int i = 0; i < LIVE; i++) live[i] = malloc(entry_size);
+    t = now();
+    for (int i = 0; i < CYCLES; i++) {
+        unsigned j = next() % LIVE;
+        free(live[j]);
+        live[j] = malloc(entry_size);
+    }
+    printf("malloc/free churn (%zu B):       %8.1f ms\n", entry_size, (now() - t) * 1e3);
+    for (int i = 0; i < LIVE; i++) free(live[i]);
+
+    rng = 1;
+    pool p = pool_new(entry_size);
+    for (int i = 0; i < LIVE; i++) live[i] = pool_alloc(p);
+    t = now();
+    for (int i = 0; i < CYCLES; i++) {
+        unsigned j = next() % LIVE;
+        pool_release(p, live[j]);
+        live[j] = pool_alloc(p);
+    }
+    printf("pool churn (%zu B):              %8.1f ms\n", entry_size, (now() - t) * 1e3);
+    pool_free(p);
+
+#ifdef STD_USE_POOL
+    const char* mode = "STD_USE_POOL";
+#else
+    const char* mode = "malloc";
+#endif
+
+    // map churn: insert/remove cycles over a working set of keys
+    char key[32];
+    map_double m;
+    map_init(m);
+    for (int i = 0; i < LIVE; i++) {
+        sprintf(key, "key-%d", i);
+        map_insert(m, key, (double) i);
+    }
+    rng = 1;
+    t = now();
+    for (int i = 0; i < CYCLES; i++) {
+        sprintf(key, "key-%u", next() % LIVE);
+        map_remove(m, key);
+        map_insert(m, key, (double) i);
+    }
+    printf("map insert/remove churn (%s): %8.1f ms\n", mode, (now() - t) * 1e3);
+    map_free(m);
+
+    // str churn: short-lived strings
+    str* strs = malloc(LIVE * sizeof(str));
+    for (int i = 0; i < LIVE; i++) strs[i] = str_new();
+    rng = 1;
+    t = now();
+    for (int i = 0; i < CYCLES; i++) {
+        unsigned j = next() % LIVE;
+        str_free(strs[j]);
+        strs[j] = str_from("churn");
+    }
+    printf("str new/free churn (%s):      %8.1f ms\n", mode, (now() - t) * 1e3);
+    for (int i = 0; i < LIVE; i++) str_free(strs[i]);
+
+    free(strs);
+    free(live);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// quantiles of a metrics vector: full qsort vs vec_nth_element, plus vec_partial_sort and
+// topk for the largest k
+// build: cc -O2 bench/bench_select.c -o bench_select
+// run:   ./bench_select [n]   (default 10M doubles)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../std/sort.h"
+#include "../std/span.h"
+#include "../std/vec.h"
+
+typedef topk(double) topk_double;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv) {
+    usize n = argc > 1 ? strtoull(argv[1], null, 10) : 10000000;
+    usize k = 1000;
+    vec_double src, v;
+    vec_init(src);
+    vec_init(v);
+    vec_reserve(src, n);
+    vec_reserve(v, n);
+    srand(1);
+    for (usize i = 0; i < n; i++) {
+        // skewed like latencies: mostly small, a long tail
+        double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+        vec_push(src, 1.0 / (u * u));
+    }
+    v->len = n;
+    usize p50 = (n - 1) / 2, p99 = (usize) (0.99 * (n - 1)), p999 = (usize) (0.999 * (n - 1));
+
+    memcpy(v->data, src->data, n * sizeof(double));
+    double t = now();
+    qsort(v->data, n, sizeof(double), cmp_double);
+    double q50 = v->data[p50], q99 = v->data[p99], q999 = v->data[p999];
+    printf("%-34s %9.2f ms\n", "qsort, p50/p99/p99.9", (now() - t) * 1e3);
+
+    memcpy(v->data, src->data, n * sizeof(double));
+    t = now();
+    vec_nth_element(v, p50);
+    double s50 = v->data[p50];
+    // p99 and p99.9 sit above p50, so only the upper half needs looking at
+    span_double upper;
+    span_from(upper, v, p50, n - p50);
+    vec_nth_element(&upper, p99 - p50);
+    double s99 = v->data[p99];
+    upper = span_drop(upper, p99 - p50);
+    vec_nth_element(&upper, p999 - p99);
+    double s999 = v->data[p999];
+    printf("%-34s %9.2f ms\n", "vec_nth_element, p50/p99/p99.9", (now() - t) * 1e3);
+
+    memcpy(v->data, src->data, n * sizeof(double));
+    t = now();
+    vec_partial_sort(v, k);
+    printf("%-34s %9.2f ms\n", "vec_partial_sort, smallest 1000", (now() - t) * 1e3);
+
+    topk_double top;
+    topk_init(top, k);
+    t = now();
+    for (usize i = 0; i < n; i++) {
+        topk_push(top, src->data[i]);
+    }
+    topk_sort(top);
+    printf("%-34s %9.2f ms\n", "topk_push, largest 1000", (now() - t) * 1e3);
+
+    if (q50 != s50 || q99 != s99 || q999 != s999) printf("MISMATCH\n");
+    topk_free(top);
+    vec_free(src);
+    vec_free(v);
+    return 0;
+}
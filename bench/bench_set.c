@@ -0,0 +1,109 @@
+// sorted set operations on posting-list-like vecs: intersection (scalar two-pointer merge vs
+// the block kernel vs galloping vs set_intersect's pick), union and difference, at size
+// ratios from 1:1 to 1:10000, for u32 and u64, plus set_union_k over 16 lists
+// build: cc -O2 bench/bench_set.c -o bench_set
+// run:   ./bench_set [long set size]   (default 1M)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../std/set.h"
+#include "../std/vec.h"
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static usize big = 1000000;
+
+// the two-pointer merge a query engine usually starts with
+#define SCALAR_INTERSECT(out, a, b)                                                   \
+  do {                                                                                \
+    usize i = 0, j = 0, k = 0;                                                        \
+    vec_reserve(out, a->len < b->len ? a->len : b->len);                              \
+    while (i < a->len && j < b->len) {                                                \
+      if (a->data[i] < b->data[j]) i++;                                               \
+      else if (b->data[j] < a->data[i]) j++;                                          \
+      else out->data[k++] = a->data[i++], j++;                                        \
+    }                                                                                 \
+    out->len = k;                                                                     \
+  } while (0)
+
+// n distinct sorted values spread over [0, universe)
+#define RANDOM_SET(v, n, universe)                                                    \
+  do {                                                                                \
+    vec_clear(v);                                                                     \
+    for (u64 x = 0, left = (n); left > 0 && x < (universe); x++) {                    \
+      if ((u64) rand() % ((universe) - x) < left) {                                   \
+        vec_push(v, x);                                                               \
+        left--;                                                                       \
+      }                                                                               \
+    }                                                                                 \
+  } while (0)
+
+// times op over enough repeats to take a while, in ns per element of the long set
+#define TIME(op)                                                                \
+  do {                                                                                \
+    usize reps = 0;                                                                   \
+    double t = now(), e;                                                              \
+    do {                                                                              \
+      op;                                                                             \
+      reps++;                                                                         \
+    } while ((e = now() - t) < 0.05);                                                 \
+    printf(" %9.3f", e / reps / big * 1e9);                                           \
+  } while (0)
+
+// one row per size ratio for element type T
+#define BENCH(T)                                                                      \
+  do {                                                                                \
+    vec_##T a, b, out;                                                                \
+    vec_init(a);                                                                      \
+    vec_init(b);                                                                      \
+    vec_init(out);                                                                    \
+    printf("\n%s, ns per element of the long set\n", #T);                             \
+    printf("%-8s %9s %9s %9s %9s %9s %9s %9s\n", "ratio", "scalar", "simd", "gallop", \
+           "auto", "union", "a-b", "b-a");                                            \
+    srand(1);                                                                         \
+    RANDOM_SET(b, big, (u64) big * 4);                                                \
+    usize ratios[] = { 1, 3, 10, 30, 100, 1000, 10000 };                              \
+    for (usize r = 0; r < sizeof(ratios) / sizeof(*ratios); r++) {                   \
+      RANDOM_SET(a, big / ratios[r], (u64) big * 4);                                  \
+      usize hits;                                                                     \
+      printf("1:%-6zu", ratios[r]);                                                   \
+      TIME(SCALAR_INTERSECT(out, a, b));                                    \
+      hits = out->len;                                                                \
+      TIME(set_intersect_simd(out, a, b));                                    \
+      TIME(set_intersect_gallop(out, a, b));                                \
+      TIME(set_intersect(out, a, b));                                         \
+      if (out->len != hits) printf(" MISMATCH");                                      \
+      TIME(set_union(out, a, b));                                            \
+      TIME(set_difference(out, a, b));                                         \
+      TIME(set_difference(out, b, a));                                         \
+      printf("\n");                                                                   \
+    }                                                                                 \
+    vec_##T sets[16];                                                                 \
+    for (int i = 0; i < 16; i++) {                                                    \
+      vec_init(sets[i]);                                                              \
+      RANDOM_SET(sets[i], big / 16, (u64) big * 4);                                   \
+    }                                                                                 \
+    printf("set_union_k, 16 lists of %zu:", big / 16);                                \
+    TIME(set_union_k(out, sets, 16));                                      \
+    printf("\n");                                                                     \
+    for (int i = 0; i < 16; i++) {                                                    \
+      vec_free(sets[i]);                                                              \
+    }                                                                                 \
+    vec_free(a);                                                                      \
+    vec_free(b);                                                                      \
+    vec_free(out);                                                                    \
+  } while (0)
+
+int main(int argc, char** argv) {
+    if (argc > 1) big = strtoull(argv[1], null, 10);
+    BENCH(u32);
+    BENCH(u64);
+    return 0;
+}
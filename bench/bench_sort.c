@@ -0,0 +1,99 @@
+// vec_sort (qsort) vs vec_stable_sort on random, sorted, reversed, sorted with 1% appended
+// and 16 interleaved sorted runs, for ints and 16-byte records sorted by key
+// build: cc -O2 bench/bench_sort.c -o bench_sort
+// run:   ./bench_sort [n]   (default 4M)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../std/sort.h"
+#include "../std/vec.h"
+
+typedef struct {
+    u64 key;
+    u64 id;
+} Record;
+
+typedef vec(Record) vec_record;
+
+#define by_key(a, b) ((a).key < (b).key)
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_int(const void* a, const void* b) {
+    int x = *(const int*) a, y = *(const int*) b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_record(const void* a, const void* b) {
+    u64 x = ((const Record*) a)->key, y = ((const Record*) b)->key;
+    return (x > y) - (x < y);
+}
+
+static const char* shapes[] = { "random", "sorted", "reversed", "sorted + 1%", "16 runs" };
+
+// key i of n for each shape
+static u64 key(usize i, usize n, int shape) {
+    switch (shape) {
+    case 0: return (u64) rand() * RAND_MAX + rand();
+    case 1: return i;
+    case 2: return n - i;
+    case 3: return i < n - n / 100 ? i : (u64) rand() % n;
+    default: return i % (n / 16) * 16 + i / (n / 16);
+    }
+}
+
+int main(int argc, char** argv) {
+    usize n = argc > 1 ? strtoull(argv[1], null, 10) : 4000000;
+    vec_int v, tmp;
+    vec_record r, rtmp;
+    vec_init(v);
+    vec_init(tmp);
+    vec_init(r);
+    vec_init(rtmp);
+    vec_reserve(v, n);
+    vec_reserve(r, n);
+    int* vs = malloc(n * sizeof(int));
+    Record* rs = malloc(n * sizeof(Record));
+    printf("%-12s %14s %14s %14s %14s\n", "", "int qsort", "int stable", "record qsort", "record stable");
+    for (int shape = 0; shape < 5; shape++) {
+        srand(1);
+        for (usize i = 0; i < n; i++) {
+            vs[i] = (int) key(i, n, shape);
+            rs[i] = (Record) { key(i, n, shape), i };
+        }
+        v->len = r->len = n;
+        printf("%-12s", shapes[shape]);
+
+        memcpy(v->data, vs, n * sizeof(int));
+        double t = now();
+        vec_sort(v, cmp_int);
+        printf(" %11.2f ms", (now() - t) * 1e3);
+        memcpy(v->data, vs, n * sizeof(int));
+        t = now();
+        vec_stable_sort(v, tmp);
+        printf(" %11.2f ms", (now() - t) * 1e3);
+
+        memcpy(r->data, rs, n * sizeof(Record));
+        t = now();
+        vec_sort(r, cmp_record);
+        printf(" %11.2f ms", (now() - t) * 1e3);
+        memcpy(r->data, rs, n * sizeof(Record));
+        t = now();
+        vec_stable_sort_by(r, rtmp, by_key);
+        printf(" %11.2f ms\n", (now() - t) * 1e3);
+    }
+    free(vs);
+    free(rs);
+    vec_free(v);
+    vec_free(tmp);
+    vec_free(r);
+    vec_free(rtmp);
+    return 0;
+}
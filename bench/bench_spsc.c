@@ -0,0 +1,228 @@
+// handoff between two pinned threads: mutex-guarded vec vs spsc, single and batched,
+// plus round-trip latency through a pair of spsc queues
+// build: cc -O2 bench/bench_spsc.c -o bench_spsc -pthread
+// run:   ./bench_spsc [producer cpu] [consumer cpu]   (default 0 and 1)
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../std/queue.h"
+#include "../std/vec.h"
+
+#define MESSAGES 10000000
+#define BATCH 64
+#define ROUND_TRIPS 200000
+
+typedef spsc(u64) spsc_u64;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cpus[2] = { 0, 1 };
+static int pin = 1;
+
+static void pin_to(int cpu) {
+    if (!pin) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// with both threads on one core a spinning side has to give its slice away
+static void relax() {
+    if (!pin) sched_yield();
+}
+
+static void run(void* (*producer)(void*), void* (*consumer)(void*), void* arg, const char* name) {
+    pthread_t p, c;
+    double t = now();
+    pthread_create(&c, null, consumer, arg);
+    pthread_create(&p, null, producer, arg);
+    pthread_join(p, null);
+    pthread_join(c, null);
+    t = now() - t;
+    printf("%-28s %8.1f ms  %7.1f M msg/s\n", name, t * 1e3, MESSAGES / t / 1e6);
+}
+
+
+// baseline: vec behind a mutex, the consumer swaps the whole vec out
+
+typedef struct {
+    pthread_mutex_t lock;
+    vec_u64 v;
+} locked;
+
+static void* locked_producer(void* arg) {
+    locked* l = arg;
+    pin_to(cpus[0]);
+    for (u64 i = 0; i < MESSAGES; i++) {
+        pthread_mutex_lock(&l->lock);
+        vec_push(l->v, i);
+        pthread_mutex_unlock(&l->lock);
+    }
+    return null;
+}
+
+static void* locked_consumer(void* arg) {
+    locked* l = arg;
+    pin_to(cpus[1]);
+    vec_u64 mine;
+    vec_init(mine);
+    u64 got = 0, sum = 0;
+    while (got < MESSAGES) {
+        pthread_mutex_lock(&l->lock);
+        vec_u64 full = l->v;
+        l->v = mine;
+        pthread_mutex_unlock(&l->lock);
+        for (usize i = 0; i < full->len; i++) sum += full->data[i];
+        got += full->len;
+        if (full->len == 0) relax();
+        full->len = 0;
+        mine = full;
+    }
+    vec_free(mine);
+    if (sum != (u64) MESSAGES * (MESSAGES - 1) / 2) printf("mutex+vec: bad sum\n");
+    return null;
+}
+
+
+// spsc, one element per push/pop
+
+static void* single_producer(void* arg) {
+    spsc_u64 q = arg;
+    pin_to(cpus[0]);
+    for (u64 i = 0; i < MESSAGES;) {
+        if (spsc_push(q, i) == 0) i++;
+        else relax();
+    }
+    return null;
+}
+
+static void* single_consumer(void* arg) {
+    spsc_u64 q = arg;
+    pin_to(cpus[1]);
+    u64 sum = 0, x;
+    for (u64 got = 0; got < MESSAGES;) {
+        if (spsc_pop(q, x) == 0) {
+            sum += x;
+            got++;
+        } else {
+            relax();
+        }
+    }
+    if (sum != (u64) MESSAGES * (MESSAGES - 1) / 2) printf("spsc single: bad sum\n");
+    return null;
+}
+
+
+// spsc, BATCH elements per push_n/pop_n
+
+static void* batch_producer(void* arg) {
+    spsc_u64 q = arg;
+    pin_to(cpus[0]);
+    u64 buf[BATCH];
+    for (u64 i = 0; i < MESSAGES;) {
+        usize n = MESSAGES - i < BATCH ? MESSAGES - i : BATCH;
+        for (usize k = 0; k < n; k++) buf[k] = i + k;
+        usize done = 0;
+        while (done < n) {
+            usize k = spsc_push_n(q, buf + done, n - done);
+            if (k == 0) relax();
+            done += k;
+        }
+        i += n;
+    }
+    return null;
+}
+
+static void* batch_consumer(void* arg) {
+    spsc_u64 q = arg;
+    pin_to(cpus[1]);
+    u64 buf[BATCH], sum = 0;
+    for (u64 got = 0; got < MESSAGES;) {
+        usize n = spsc_pop_n(q, buf, BATCH);
+        if (n == 0) relax();
+        for (usize k = 0; k < n; k++) sum += buf[k];
+        got += n;
+    }
+    if (sum != (u64) MESSAGES * (MESSAGES - 1) / 2) printf("spsc batch: bad sum\n");
+    return null;
+}
+
+
+// latency: ping goes one way, the other side sends it straight back
+
+typedef struct {
+    spsc_u64 there;
+    spsc_u64 back;
+} pingpong;
+
+static void* ping(void* arg) {
+    pingpong* pp = arg;
+    pin_to(cpus[0]);
+    u64 x;
+    double t = now();
+    for (u64 i = 0; i < ROUND_TRIPS; i++) {
+        while (spsc_push(pp->there, i) != 0) relax();
+        while (spsc_pop(pp->back, x) != 0) relax();
+        if (x != i) printf("ping-pong: out of order\n");
+    }
+    t = now() - t;
+    printf("%-28s %8.1f ns per round trip\n", "spsc ping-pong", t / ROUND_TRIPS * 1e9);
+    return null;
+}
+
+static void* pong(void* arg) {
+    pingpong* pp = arg;
+    pin_to(cpus[1]);
+    u64 x;
+    for (u64 i = 0; i < ROUND_TRIPS; i++) {
+        while (spsc_pop(pp->there, x) != 0) relax();
+        while (spsc_push(pp->back, x) != 0) relax();
+    }
+    return null;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        cpus[0] = atoi(argv[1]);
+        cpus[1] = atoi(argv[2]);
+    }
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+        pin = 0;
+        printf("only one cpu online, threads aren't pinned and numbers are mostly scheduler\n");
+    }
+
+    locked l = { PTHREAD_MUTEX_INITIALIZER, null };
+    vec_init(l.v);
+    run(locked_producer, locked_consumer, &l, "mutex+vec");
+    vec_free(l.v);
+
+    spsc_u64 q;
+    spsc_init(q, 4096);
+    run(single_producer, single_consumer, q, "spsc push/pop");
+    run(batch_producer, batch_consumer, q, "spsc push_n/pop_n (64)");
+    spsc_free(q);
+
+    pingpong pp;
+    spsc_init(pp.there, 16);
+    spsc_init(pp.back, 16);
+    pthread_t a, b;
+    pthread_create(&b, null, pong, &pp);
+    pthread_create(&a, null, ping, &pp);
+    pthread_join(a, null);
+    pthread_join(b, null);
+    spsc_free(pp.there);
+    spsc_free(pp.back);
+    return 0;
+}
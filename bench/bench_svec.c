@@ -0,0 +1,67 @@
+// allocation counts and timing: vec vs svec on many short-lived small vectors
+// build: cc -O2 bench/bench_svec.c -o bench_svec
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// count every allocation the containers make
+#ifndef STD_USE_ALLOCATOR
+#define STD_USE_ALLOCATOR
+#endif
+#include "../std/svec.h"
+
+static unsigned long allocs = 0;
+
+static void* counted_alloc(void* ctx, usize n) { (void) ctx; allocs++; return malloc(n); }
+static void* counted_realloc(void* ctx, void* p, usize o, usize n) { (void) ctx, (void) o; allocs++; return realloc(p, n); }
+static void counted_free(void* ctx, void* p, usize n) { (void) ctx, (void) n; free(p); }
+
+static allocator counting = { counted_alloc, counted_realloc, counted_free, null };
+
+#define VECS 1000000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    // typical workload: most vectors hold fewer than 8 elements, a few hold more
+    int* sizes = (int*) malloc(VECS * sizeof(int));
+    srand(1);
+    for (int i = 0; i < VECS; i++) {
+        sizes[i] = (rand() % 100 < 95) ? rand() % 8 : 8 + rand() % 24;
+    }
+    long sink = 0;
+    std_allocator_set(&counting);
+
+    allocs = 0;
+    double t = now();
+    for (int i = 0; i < VECS; i++) {
+        vec_int v;
+        vec_init(v);
+        for (int j = 0; j < sizes[i]; j++) vec_push(v, j);
+        sink += vec_len(v);
+        vec_free(v);
+    }
+    printf("vec(int):      %8.1f ms  %9lu allocations  (%.2f per vector)\n",
+           (now() - t) * 1e3, allocs, (double) allocs / VECS);
+
+    allocs = 0;
+    t = now();
+    for (int i = 0; i < VECS; i++) {
+        svec(int, 8) v;
+        svec_init(v);
+        for (int j = 0; j < sizes[i]; j++) svec_push(v, j);
+        sink += svec_len(v);
+        svec_free(v);
+    }
+    printf("svec(int, 8):  %8.1f ms  %9lu allocations  (%.2f per vector)\n",
+           (now() - t) * 1e3, allocs, (double) allocs / VECS);
+
+    free(sizes);
+    return sink == 0;
+}
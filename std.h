@@ -4,10 +4,30 @@
 /*
 
 std.h - small header-only standard library of pure C data types I use for my own stuff, includes:
-    - array.h - generic fixed-length array
+    - array.h - generic fixed-length array, optionally cache-line aligned or on huge pages
     - vec.h - generic dynamic array kinda similar to std::vector
+    - mvec.h - vec backed by a memory-mapped file, persistent and shareable between processes
+    - deque.h - generic double-ended queue on a ring buffer
+    - queue.h - bounded lock-free queues: spsc with batch push/pop, and mpmc with futex-based blocking
+    - heap.h - 4-ary heap priority queue on vec, plus an indexed heap with decrease-key
+    - sort.h - adaptive stable sort (timsort-style), selection (nth element), partial sort and streaming top-k, with inlined comparisons
+    - set.h - sorted set intersection (AVX2 blocks or galloping), union, difference and k-way union of u32/u64 vecs
+    - bitset.h - bit vector with fast popcount, set-bit iteration and a rank/select index
+    - bloom.h - blocked bloom filter (one cache line per lookup) for str/c_str or raw byte keys, with map helpers
+    - svec.h - small vector with inline storage for the first N elements
+    - span.h - non-owning view (pointer and length) over a range of a vec or array
+    - soa.h - struct-of-arrays container generator, one column per field
     - map.h - generic hashmap with string keys
+    - slotmap.h - slot map: stable generational handles to densely packed values
     - str.h - string library
+    - ser.h - binary dump/load of vec, array and array_str through a FILE* or fd, or mapped in place
+    - alloc.h - pluggable allocator interface (opt-in with STD_USE_ALLOCATOR)
+    - arena.h - chunked bump allocator with mark/reset
+    - pool.h - fixed-size object pool (opt-in backing for map entries and str headers with STD_USE_POOL)
+    - par.h - parallel for_each/transform/reduce/scan over vec and array on the thread.h pool
+    - thread.h - work-stealing thread pool: task spawn/wait, parallel for, cpu affinity
+    - num.h - vectorized sum/min/max/dot/axpy kernels for float, double and int vecs and arrays
+    - cpu.h - cpu feature probe (AVX2, FMA, POPCNT, SSE4.2) shared by the vector kernels, cached atomically
     - types.h - some type aliases I like to use
 
 - The generic classes define basic primitive types
@@ -19,10 +39,30 @@ std.h - small header-only standard library of pure C data types I use for my own
 */
 
 #include "std/types.h"
+#include "std/alloc.h"
 
+#include "std/arena.h"
 #include "std/array.h"
+#include "std/bitset.h"
+#include "std/bloom.h"
+#include "std/cpu.h"
+#include "std/deque.h"
+#include "std/heap.h"
 #include "std/map.h"
+#include "std/mvec.h"
+#include "std/num.h"
+#include "std/par.h"
+#include "std/pool.h"
+#include "std/queue.h"
+#include "std/ser.h"
+#include "std/set.h"
+#include "std/slotmap.h"
+#include "std/soa.h"
+#include "std/sort.h"
+#include "std/span.h"
 #include "std/str.h"
+#include "std/svec.h"
+#include "std/thread.h"
 #include "std/vec.h"
 
 #endif // STD_H
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef STD_ALLOC_H
+#define STD_ALLOC_H
+
+#include "types.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+alloc.h - pluggable allocator interface
+
+allocator - vtable of alloc/realloc/free functions plus a context pointer
+
+By default every container calls malloc, calloc, realloc and free directly and none of
+this costs anything. Define STD_USE_ALLOCATOR before including any std header to route
+all container memory through an allocator instead: each container remembers the allocator
+it was created with, and containers created without one use the thread-local default.
+
+** Default allocator **
+std_allocator_heap                  -- allocator backed by malloc/realloc/free
+std_allocator_get()                 -- the calling thread's default allocator
+std_allocator_set(a)                -- set the calling thread's default, returns the previous one
+std_allocator_of(c)                 -- the allocator container c was created with
+
+** Per-container (STD_USE_ALLOCATOR only) **
+vec_init_with(v, a)                 -- see vec.h
+svec_init_with(v, a)                -- see svec.h
+array_init_with(a, n, al)           -- see array.h
+map_init_with(m, a)                 -- see map.h
+str_new_with(a)                     -- see str.h
+str_alloc_with(n, a)                -- see str.h
+str_from_with(cs, a)                -- see str.h
+
+Allocators get the size of the block on realloc and free, so arenas and pools
+don't need to keep their own headers.
+
+*/
+
+typedef struct allocator {
+    void* (*alloc)(void* ctx, usize size);
+    void* (*realloc)(void* ctx, void* ptr, usize old_size, usize new_size);
+    void  (*free)(void* ctx, void* ptr, usize size);
+    void* ctx;
+} allocator;
+
+
+#ifdef STD_USE_ALLOCATOR
+
+// allocator field inside a container
+#define STD_ALLOC_FIELD             allocator* alloc;
+
+// leading allocator parameter / argument of internal functions
+#define STD_ALLOC_PARAM             allocator* alloc,
+#define STD_ALLOC_FWD               alloc,
+#define STD_ALLOC_ARG(c)            (c)->alloc,
+#define STD_ALLOC_DEFAULT           std_allocator_get(),
+
+// remember the allocator a container was created with
+#define std_alloc_init(c, a)        ((c)->alloc = (a))
+
+// the allocator a container was created with
+#define std_allocator_of(c)         ((c)->alloc)
+
+#define std_malloc(a, n)            ((a)->alloc((a)->ctx, (n)))
+#define std_calloc(a, n, sz)        __std_calloc((a), (n), (sz))
+#define std_realloc(a, p, o, n)     ((a)->realloc((a)->ctx, (p), (o), (n)))
+#define std_free(a, p, n)           __std_free((a), (p), (n))
+#define std_strdup(a, s)            __std_strdup((a), (s))
+
+#else
+
+#define STD_ALLOC_FIELD
+#define STD_ALLOC_PARAM
+#define STD_ALLOC_FWD
+#define STD_ALLOC_ARG(c)
+#define STD_ALLOC_DEFAULT
+
+#define std_alloc_init(c, a)        ((void)0)
+#define std_allocator_of(c)         std_allocator_get()
+
+#define std_malloc(a, n)            malloc(n)
+#define std_calloc(a, n, sz)        calloc(n, sz)
+#define std_realloc(a, p, o, n)     realloc(p, n)
+#define std_free(a, p, n)           free(p)
+#define std_strdup(a, s)            strdup(s)
+
+#endif // STD_USE_ALLOCATOR
+
+
+void* __std_heap_alloc(void* ctx, usize size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+void* __std_heap_realloc(void* ctx, void* ptr, usize old_size, usize new_size) {
+    (void)ctx;
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
+
+void __std_heap_free(void* ctx, void* ptr, usize size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+allocator std_allocator_heap = {
+    __std_heap_alloc,
+    __std_heap_realloc,
+    __std_heap_free,
+    null
+};
+
+_Thread_local allocator* __std_allocator_default = &std_allocator_heap;
+
+
+// the calling thread's default allocator
+allocator* std_allocator_get() {
+    return __std_allocator_default;
+}
+
+// set the calling thread's default, returns the previous one
+allocator* std_allocator_set(allocator* a) {
+    allocator* prev = __std_allocator_default;
+    __std_allocator_default = (a == null) ? &std_allocator_heap : a;
+    return prev;
+}
+
+
+void* __std_calloc(allocator* a, usize n, usize size) {
+    void* ptr = a->alloc(a->ctx, n * size);
+    if (ptr != null) memset(ptr, 0, n * size);
+    return ptr;
+}
+
+void __std_free(allocator* a, void* ptr, usize size) {
+    if (ptr != null) a->free(a->ctx, ptr, size);
+}
+
+char* __std_strdup(allocator* a, const char* s) {
+    usize n = strlen(s) + 1;
+    char* ptr = a->alloc(a->ctx, n);
+    if (ptr != null) memcpy(ptr, s, n);
+    return ptr;
+}
+
+
+#endif // STD_ALLOC_H
@@ -0,0 +1,220 @@
+#ifndef STD_ARENA_H
+#define STD_ARENA_H
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "types.h"
+
+// arena.h - chunked bump allocator
+// (everything allocated from an arena is freed at once by arena_reset or arena_free)
+
+// Types
+
+typedef struct __arena_chunk {
+    struct __arena_chunk* next;
+    usize cap;
+    alignas(max_align_t) char data[];
+}* arena_chunk;
+
+// arena type
+typedef struct __arena {
+    arena_chunk first;      // first chunk, kept across resets
+    arena_chunk cur;        // chunk currently being bumped
+    usize pos;              // bump offset into cur
+    usize chunk_size;       // minimum size of a new chunk
+    allocator alloc;        // allocator view of this arena, see arena_allocator
+}* arena;
+
+// saved position in an arena
+typedef struct {
+    arena_chunk chunk;
+    usize pos;
+} arena_mark;
+
+// default size of a chunk
+#define STD_ARENA_CHUNK_SIZE (64 * 1024)
+
+// default alignment of arena_alloc
+#define STD_ARENA_ALIGN alignof(max_align_t)
+
+// Methods
+
+arena       arena_new(usize chunk_size);                        // new arena, chunk_size 0 uses STD_ARENA_CHUNK_SIZE
+void        arena_free(arena a);                                // free the arena and all its chunks
+void*       arena_alloc(arena a, usize n);                      // allocate n bytes, aligned to STD_ARENA_ALIGN
+void*       arena_alloc_aligned(arena a, usize n, usize align); // allocate n bytes, align must be a power of 2
+void*       arena_calloc(arena a, usize n, usize size);         // allocate n * size zeroed bytes
+arena_mark  arena_save(arena a);                                // save the current position
+void        arena_restore(arena a, arena_mark m);               // free everything allocated since m was saved
+void        arena_reset(arena a);                               // free everything, keeps chunks for reuse, O(1)
+usize       arena_used(arena a);                                // bytes in use across all chunks
+allocator*  arena_allocator(arena a);                           // allocator that allocates from this arena
+
+/*
+
+With STD_USE_ALLOCATOR, containers can be built directly in an arena:
+
+    arena a = arena_new(0);
+    vec(int) v;
+    vec_init_with(v, arena_allocator(a));
+    str s = str_from_with("hello", arena_allocator(a));
+
+or make the arena the thread's default so temporaries from str_split, str_slice,
+str_format etc. land in it too:
+
+    allocator* prev = std_allocator_set(arena_allocator(a));
+    array_str parts = str_split(line, ',');
+    ...
+    std_allocator_set(prev);
+    arena_reset(a);                 // parts and all its strings are gone
+
+Arena memory is never freed one object at a time: *_free on an arena-backed container
+only gives back its memory if it was the last thing allocated.
+
+*/
+
+
+// DEFINITIONS
+
+
+arena_chunk __arena_chunk_new(usize cap) {
+    arena_chunk c = (arena_chunk) malloc(sizeof(struct __arena_chunk) + cap);
+    if (c == null) return null;
+    c->next = null;
+    c->cap = cap;
+    return c;
+}
+
+void* __arena_allocator_alloc(void* ctx, usize size) {
+    return arena_alloc((arena) ctx, size);
+}
+
+void* __arena_allocator_realloc(void* ctx, void* ptr, usize old_size, usize new_size) {
+    arena a = (arena) ctx;
+    if (ptr == null) {
+        return arena_alloc(a, new_size);
+    }
+    // last allocation: grow or shrink in place
+    char* end = a->cur->data + a->pos;
+    if ((char*) ptr + old_size == end && (char*) ptr - a->cur->data + new_size <= a->cur->cap) {
+        a->pos = (char*) ptr - a->cur->data + new_size;
+        return ptr;
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+    void* p = arena_alloc(a, new_size);
+    if (p != null) memcpy(p, ptr, old_size);
+    return p;
+}
+
+void __arena_allocator_free(void* ctx, void* ptr, usize size) {
+    arena a = (arena) ctx;
+    // only the last allocation can be given back
+    if ((char*) ptr + size == a->cur->data + a->pos) {
+        a->pos = (char*) ptr - a->cur->data;
+    }
+}
+
+// new arena, chunk_size 0 uses STD_ARENA_CHUNK_SIZE
+arena arena_new(usize chunk_size) {
+    arena a = (arena) calloc(1, sizeof(struct __arena));
+    a->chunk_size = chunk_size == 0 ? STD_ARENA_CHUNK_SIZE : chunk_size;
+    a->first = __arena_chunk_new(a->chunk_size);
+    a->cur = a->first;
+    a->pos = 0;
+    a->alloc.alloc = __arena_allocator_alloc;
+    a->alloc.realloc = __arena_allocator_realloc;
+    a->alloc.free = __arena_allocator_free;
+    a->alloc.ctx = a;
+    return a;
+}
+
+// free the arena and all its chunks
+void arena_free(arena a) {
+    arena_chunk c = a->first;
+    while (c != null) {
+        arena_chunk next = c->next;
+        free(c);
+        c = next;
+    }
+    free(a);
+}
+
+// allocate n bytes, align must be a power of 2
+void* arena_alloc_aligned(arena a, usize n, usize align) {
+    arena_chunk c = a->cur;
+    usize pos = a->pos;
+    for (;;) {
+        uintptr_t base = (uintptr_t) c->data;
+        usize start = ((base + pos + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        if (start + n <= c->cap) {
+            a->cur = c;
+            a->pos = start + n;
+            return c->data + start;
+        }
+        // try the next chunk left over from before a reset, otherwise link in a new one
+        if (c->next != null && n + align <= c->next->cap) {
+            c = c->next;
+        } else {
+            usize cap = n + align > a->chunk_size ? n + align : a->chunk_size;
+            arena_chunk fresh = __arena_chunk_new(cap);
+            if (fresh == null) return null;
+            fresh->next = c->next;
+            c->next = fresh;
+            c = fresh;
+        }
+        pos = 0;
+    }
+}
+
+// allocate n bytes, aligned to STD_ARENA_ALIGN
+void* arena_alloc(arena a, usize n) {
+    return arena_alloc_aligned(a, n, STD_ARENA_ALIGN);
+}
+
+// allocate n * size zeroed bytes
+void* arena_calloc(arena a, usize n, usize size) {
+    void* p = arena_alloc(a, n * size);
+    if (p != null) memset(p, 0, n * size);
+    return p;
+}
+
+// save the current position
+arena_mark arena_save(arena a) {
+    arena_mark m = { a->cur, a->pos };
+    return m;
+}
+
+// free everything allocated since m was saved
+void arena_restore(arena a, arena_mark m) {
+    a->cur = m.chunk;
+    a->pos = m.pos;
+}
+
+// free everything, keeps chunks for reuse, O(1)
+void arena_reset(arena a) {
+    a->cur = a->first;
+    a->pos = 0;
+}
+
+// bytes in use across all chunks
+usize arena_used(arena a) {
+    usize used = 0;
+    for (arena_chunk c = a->first; c != a->cur; c = c->next) {
+        used += c->cap;
+    }
+    return used + a->pos;
+}
+
+// allocator that allocates from this arena
+allocator* arena_allocator(arena a) {
+    return &a->alloc;
+}
+
+
+#endif // STD_ARENA_H
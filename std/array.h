@@ -1,11 +1,17 @@
 #ifndef STD_ARRAY_H
 #define STD_ARRAY_H
 
+#include "alloc.h"
 #include "types.h"
+#include "vec.h"
 
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
 /*
 
 array.h - generic fixed-size array type in C
@@ -15,8 +21,10 @@ array(T) - the type of an array. Until C23, typedef this to something before usi
 
 ** Memory management **
 array_init(a, n)                    -- initialize array with n elements
+array_init_with(a, n, al)           -- initialize array using allocator al (STD_USE_ALLOCATOR only)
+array_init_aligned(a, n, align)     -- initialize array with n elements at an align-byte boundary
 array_free(a)                       -- free all memory
-array_resize(a, n)                  -- resize to n elements
+array_resize(a, n)                  -- resize to n elements, returns 0 or -1 keeping the old ones
 array_fill(a, val)                  -- fill an array with val
 
 ** Properties **
@@ -30,17 +38,32 @@ array_write(a, i, val)              -- write val to index i
 array_swap(a, i, j)                 -- swap 2 values
 array_sort(a, fn)                   -- qsort in-place
 array_reverse(a)                    -- reverse elements in-place
+array_rotate(a, k)                  -- rotate left by k, element k comes first
+array_swap_ranges(a, i, j, n)       -- swap n elements at i with n elements at j (not overlapping)
+array_gather(dst, src, idx)         -- dst[i] = src[idx[i]] for every element of dst
+array_scatter(dst, src, idx)        -- dst[idx[i]] = src[i] for every element of src
 
 ** Iteration **
 array_iter(a, t)                    -- stores each value in t
 array_enum(a, i, t)                 -- enumerate: stores each index in i and each value in t
 
+array_init_aligned rounds align up to a power of two and to at least 16, and the array
+keeps it across array_resize. Arrays of STD_ARRAY_HUGE bytes or more are mapped straight
+from the OS (bypassing the allocator) at a huge page boundary, and on Linux marked with
+MADV_HUGEPAGE so transparent huge pages back them and the TLB covers more of the array.
+Mapped pages aren't touched by array_init_aligned, so they're faulted in by whatever
+writes them first; par_first_touch in par.h does that from the pool's threads at once,
+each page from the thread par_for_each will later use it on.
+array_resize of an aligned array copies into a new block on the calling thread.
+
 */
 
 #define array(T)      \
   struct {            \
     T* data;          \
     usize len;        \
+    usize align;      \
+    STD_ALLOC_FIELD   \
   }*                  \
 
 
@@ -55,24 +78,62 @@ typedef array(double) array_double;
 
 
 #define __a_unpack(a) \
-  (void**)&(a)->data, &(a)->len, sizeof(*(a)->data)
+  STD_ALLOC_ARG(a) __a_fields(a)
+
+
+// the fields alone, for helpers that never allocate
+#define __a_fields(a) \
+  (void**)&(a)->data, &(a)->len, sizeof(*(a)->data), (a)->align
+
+
+// aligned arrays at least this many bytes big are mapped on huge pages
+#ifndef STD_ARRAY_HUGE
+#define STD_ARRAY_HUGE (4 * 1024 * 1024)
+#endif
+
+// huge page size mapped arrays are aligned to
+#define STD_ARRAY_HUGE_PAGE (2 * 1024 * 1024)
 
 
 // initialize array
 #define array_init(a, n) \
-  do {                                                              \
-    *(void**)&(a) = calloc(1, sizeof(struct{void* d; usize l;}));   \
-    *(void**)&((a)->data) = calloc(n, sizeof( *((a)->data) ));      \
-    (a)->len = (n);                                                 \
+  __a_init_with(a, n, std_allocator_get())
+
+
+#ifdef STD_USE_ALLOCATOR
+// initialize array using allocator al
+#define array_init_with(a, n, al) \
+  __a_init_with(a, n, al)
+#endif
+
+
+#define __a_init_with(a, n, al) \
+  do {                                                                                    \
+    *(void**)&(a) = std_calloc((al), 1, sizeof(struct{void* d; usize l; usize g; STD_ALLOC_FIELD})); \
+    std_alloc_init((a), (al));                                                            \
+    *(void**)&((a)->data) = std_calloc((al), n, sizeof( *((a)->data) ));                  \
+    (a)->len = (n);                                                                       \
+  } while(0)
+
+
+// initialize array with n elements at an align-byte boundary
+#define array_init_aligned(a, n, alignment) \
+  do {                                                                                    \
+    *(void**)&(a) = std_calloc(std_allocator_get(), 1, sizeof(*(a)));                     \
+    std_alloc_init((a), std_allocator_get());                                             \
+    (a)->align = __a_align(alignment);                                                    \
+    __a_resize(__a_unpack(a), n);                                                         \
   } while(0)
 
 
 // free all memory
-#define array_free(a) \
-  (free((a)->data), free((a)))
+#define array_free(a)                                                                     \
+  ((a)->align ? __a_free_aligned(STD_ALLOC_ARG(a) (a)->data)                              \
+              : std_free((a)->alloc, (a)->data, (a)->len * sizeof(*(a)->data)),           \
+   std_free((a)->alloc, (a), sizeof(*(a))))
 
 
-// resize to n elements
+// resize to n elements, returns 0 or -1 keeping the old ones
 #define array_resize(a, n) \
   __a_resize(__a_unpack(a), n)
 
@@ -113,7 +174,7 @@ typedef array(double) array_double;
 
 // swap 2 values
 #define array_swap(a, i, j) \
-  __a_swap(__a_unpack(a), i, j)
+  __a_swap(__a_fields(a), i, j)
 
 
 // qsort in-place
@@ -122,15 +183,37 @@ typedef array(double) array_double;
 
 
 // reverse elements in-place
-#define array_reverse(a)                              \
-  do {                                                \
-    int __i = (a)->len / 2;                           \
-    while (__i--) {                                   \
-      array_swap((a), __i, (a)->len - (__i + 1));     \
-    }                                                 \
+#define array_reverse(a) \
+  __v_reverse((a)->data, (a)->len, sizeof(*(a)->data))
+
+
+// rotate left by k, element k comes first
+#define array_rotate(a, k) \
+  __v_rotate((a)->data, (a)->len, sizeof(*(a)->data), (k))
+
+
+// swap n elements at i with n elements at j (not overlapping)
+#define array_swap_ranges(a, i, j, n) \
+  __v_swap_bytes((char*) ((a)->data + (i)), (char*) ((a)->data + (j)), (n) * sizeof(*(a)->data))
+
+
+// dst[i] = src[idx[i]] for every element of dst
+#define array_gather(dst, src, idx)                                   \
+  do {                                                                \
+    __typeof__((dst)->data) __d = (dst)->data;                        \
+    const __typeof__(*(src)->data)* __s = (src)->data;                \
+    const __typeof__((idx)[0])* __x = (idx);                          \
+    for (usize __i = 0, __n = (dst)->len; __i < __n; __i++) {         \
+      __d[__i] = __s[__x[__i]];                                       \
+    }                                                                 \
   } while (0)
 
 
+// dst[idx[i]] = src[i] for every element of src
+#define array_scatter(dst, src, idx) \
+  vec_scatter(dst, src, idx)
+
+
 // stores each value in t
 #define array_iter(a, t)                                                      \
   if ((a)->len > 0)                                                           \
@@ -143,25 +226,86 @@ typedef array(double) array_double;
   for ((i) = 0; (i) < (a)->len && (((t) = (a)->data[(i)]), 1); ++(i))         \
 
 
-void __a_resize(void** data, usize* len, usize memsz, usize new_size) {
-  *data = realloc(*data, (new_size * memsz));
+// kept just below an aligned block, to free it
+typedef struct {
+  void* base;       // what was allocated or mapped
+  usize size;       // its size in bytes
+  usize mapped;     // 1 if it came from mmap rather than the allocator
+} __a_block;
+
+// align rounded up to a power of two of at least 16
+usize __a_align(usize align) {
+  usize p = 16;
+  while (p < align) p <<= 1;
+  return p;
+}
+
+// zeroed block of bytes aligned to align, huge ones mapped on huge pages
+void* __a_alloc_aligned(STD_ALLOC_PARAM usize bytes, usize align) {
+  usize head = sizeof(__a_block);
+  __a_block b = { null, 0, 0 };
+  char* data = null;
+#ifdef __linux__
+  if (bytes >= STD_ARRAY_HUGE) {
+    usize page = align > STD_ARRAY_HUGE_PAGE ? align : STD_ARRAY_HUGE_PAGE;
+    b.size = head + page + bytes;
+    b.base = mmap(null, b.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (b.base != MAP_FAILED) {
+      b.mapped = 1;
+      data = (char*) (((uintptr_t) b.base + head + page - 1) & ~(uintptr_t) (page - 1));
+#ifdef MADV_HUGEPAGE
+      madvise(data, bytes, MADV_HUGEPAGE);
+#endif
+    }
+  }
+#endif
+  if (data == null) {
+    b.size = head + align + bytes;
+    b.base = std_calloc(alloc, 1, b.size);
+    if (b.base == null) return null;
+    data = (char*) (((uintptr_t) b.base + head + align - 1) & ~(uintptr_t) (align - 1));
+  }
+  memcpy(data - head, &b, head);
+  return data;
+}
+
+void __a_free_aligned(STD_ALLOC_PARAM void* data) {
+  if (data == null) return;
+  __a_block b;
+  memcpy(&b, (char*) data - sizeof(__a_block), sizeof(__a_block));
+#ifdef __linux__
+  if (b.mapped) {
+    munmap(b.base, b.size);
+    return;
+  }
+#endif
+  std_free(alloc, b.base, b.size);
+}
+
+// 0, or -1 leaving data and len as they were
+int __a_resize(STD_ALLOC_PARAM void** data, usize* len, usize memsz, usize align, usize new_size) {
+  void* p;
+  if (align == 0) {
+    p = std_realloc(alloc, *data, (*len * memsz), (new_size * memsz));
+    if (p == null && new_size > 0) return -1;
+  } else {
+    // no realloc that keeps the alignment, so copy over
+    p = new_size > 0 ? __a_alloc_aligned(STD_ALLOC_FWD new_size * memsz, align) : null;
+    if (p == null && new_size > 0) return -1;
+    if (p != null && *data != null) {
+      memcpy(p, *data, (*len < new_size ? *len : new_size) * memsz);
+    }
+    __a_free_aligned(STD_ALLOC_FWD *data);
+  }
+  *data = p;
   *len = new_size;
+  return 0;
 }
 
-void __a_swap(void** data, usize* len, usize memsz, usize idx1, usize idx2) {
-  unsigned char *a, *b, tmp;
-  usize count;
-  (void) len;
+void __a_swap(void** data, usize* len, usize memsz, usize align, usize idx1, usize idx2) {
+  (void) len, (void) align;
   if (idx1 == idx2) return;
-  a = (unsigned char*) *data + idx1 * memsz;
-  b = (unsigned char*) *data + idx2 * memsz;
-  count = memsz;
-  while (count--) {
-    tmp = *a;
-    *a = *b;
-    *b = tmp;
-    a++, b++;
-  }
+  __v_swap_bytes((char*) *data + idx1 * memsz, (char*) *data + idx2 * memsz, memsz);
 }
 
 #endif // STD_ARRAY_H
\ No newline at end of file
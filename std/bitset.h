@@ -0,0 +1,361 @@
+#ifndef STD_BITSET_H
+#define STD_BITSET_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "alloc.h"
+#include "cpu.h"
+#include "types.h"
+
+// bitset.h - fixed-length bit vector
+// (one bit per flag, word-at-a-time bulk operations, optional rank/select index)
+
+// Types
+
+// bitset type
+typedef struct __bitset {
+    u64* words;             // bit i is bit i % 64 of words[i / 64], bits past len are 0
+    usize len;              // number of bits
+    usize nwords;           // words allocated
+    u64* index;             // set bits before each STD_BITSET_BLOCK bits, null until built
+    STD_ALLOC_FIELD
+}* bitset;
+
+// bits per entry of the rank/select index
+#define STD_BITSET_BLOCK 512
+
+// Methods
+
+bitset      bitset_new(usize n);                        // n bits, all clear
+void        bitset_free(bitset b);                      // free all memory
+int         bitset_resize(bitset b, usize n);           // change the length to n bits, new bits are clear
+usize       bitset_len(bitset b);                       // the number of bits
+
+void        bitset_set(bitset b, usize i);              // set bit i
+void        bitset_clear(bitset b, usize i);            // clear bit i
+void        bitset_flip(bitset b, usize i);             // flip bit i
+bool        bitset_test(bitset b, usize i);             // is bit i set?
+void        bitset_set_all(bitset b);                   // set every bit
+void        bitset_clear_all(bitset b);                 // clear every bit
+
+void        bitset_and(bitset dst, bitset src);         // dst &= src
+void        bitset_or(bitset dst, bitset src);          // dst |= src
+void        bitset_xor(bitset dst, bitset src);         // dst ^= src
+void        bitset_andnot(bitset dst, bitset src);      // dst &= ~src
+
+usize       bitset_count(bitset b);                     // number of set bits
+usize       bitset_next(bitset b, usize i);             // first set bit at or after i, len if none
+int         bitset_build_index(bitset b);               // build the rank/select index
+usize       bitset_rank(bitset b, usize i);             // number of set bits before bit i
+usize       bitset_select(bitset b, usize k);           // position of the k-th set bit (from 0), len if none
+
+/*
+
+Macros
+
+bitset_iter(b, i)                                       -- loop over the set bits in order, storing each in i
+
+The bulk operations work a word at a time over the shorter of the two lengths.
+bitset_count uses an AVX2 nibble-lookup kernel on long bitsets when the cpu has it,
+the POPCNT instruction otherwise, picked at runtime. bitset_iter and bitset_next skip
+zero words and find the bits in a word with tzcnt, so sparse sets iterate fast.
+
+bitset_rank and bitset_select count from the start without an index. bitset_build_index
+stores a running count every STD_BITSET_BLOCK bits (12.5% extra memory), after which
+rank is one lookup plus up to 8 word popcounts and select a binary search over the
+blocks. The index isn't updated by changes to the bits, rebuild it after modifying b
+(bitset_resize drops it).
+
+*/
+
+
+// loop over the set bits in order, storing each in i
+#define bitset_iter(b, i)                                                   \
+  for (u64 __w = 0, __bits = (b)->words[0];                                 \
+       __bitset_advance((b), &__w, &__bits)                                 \
+       && ((i) = __w * 64 + __builtin_ctzll(__bits), 1);                    \
+       __bits &= __bits - 1)
+
+
+// DEFINITIONS
+
+
+#define __bitset_words(n) (((n) + 63) / 64)
+
+// entries in the index, the last one is the total
+#define __bitset_blocks(b) (((b)->nwords + 7) / 8 + 1)
+
+
+// zero the bits past len in the last word
+void __bitset_trim(bitset b) {
+    if (b->len % 64 != 0) b->words[b->len / 64] &= ((u64) 1 << (b->len % 64)) - 1;
+}
+
+// moves to the next non-zero word if bits is used up, 0 at the end
+bool __bitset_advance(bitset b, u64* w, u64* bits) {
+    while (*bits == 0) {
+        if (++*w >= __bitset_words(b->len)) return false;
+        *bits = b->words[*w];
+    }
+    return true;
+}
+
+bitset __bitset_new(STD_ALLOC_PARAM usize n) {
+    bitset b = (bitset) std_calloc(alloc, 1, sizeof(struct __bitset));
+    if (b == null) return null;
+    std_alloc_init(b, alloc);
+    b->nwords = __bitset_words(n);
+    b->words = (u64*) std_calloc(alloc, b->nwords ? b->nwords : 1, sizeof(u64));
+    if (b->words == null) {
+        std_free(alloc, b, sizeof(struct __bitset));
+        return null;
+    }
+    b->len = n;
+    return b;
+}
+
+// n bits, all clear
+bitset bitset_new(usize n) {
+    return __bitset_new(STD_ALLOC_DEFAULT n);
+}
+
+void __bitset_drop_index(bitset b) {
+    if (b->index == null) return;
+    std_free(b->alloc, b->index, __bitset_blocks(b) * sizeof(u64));
+    b->index = null;
+}
+
+// free all memory
+void bitset_free(bitset b) {
+    __bitset_drop_index(b);
+    std_free(b->alloc, b->words, (b->nwords ? b->nwords : 1) * sizeof(u64));
+    std_free(b->alloc, b, sizeof(struct __bitset));
+}
+
+// change the length to n bits, new bits are clear
+int bitset_resize(bitset b, usize n) {
+    usize nw = __bitset_words(n);
+    __bitset_drop_index(b);
+    if (nw > b->nwords) {
+        u64* w = (u64*) std_realloc(b->alloc, b->words, (b->nwords ? b->nwords : 1) * sizeof(u64), nw * sizeof(u64));
+        if (w == null) return -1;
+        memset(w + b->nwords, 0, (nw - b->nwords) * sizeof(u64));
+        b->words = w;
+        b->nwords = nw;
+    }
+    if (n < b->len) {
+        // clear what's cut off so growing again gives clear bits
+        memset(b->words + nw, 0, (__bitset_words(b->len) - nw) * sizeof(u64));
+        b->len = n;
+        __bitset_trim(b);
+    }
+    b->len = n;
+    return 0;
+}
+
+// the number of bits
+usize bitset_len(bitset b) {
+    return b->len;
+}
+
+// set bit i
+void bitset_set(bitset b, usize i) {
+    b->words[i / 64] |= (u64) 1 << (i % 64);
+}
+
+// clear bit i
+void bitset_clear(bitset b, usize i) {
+    b->words[i / 64] &= ~((u64) 1 << (i % 64));
+}
+
+// flip bit i
+void bitset_flip(bitset b, usize i) {
+    b->words[i / 64] ^= (u64) 1 << (i % 64);
+}
+
+// is bit i set?
+bool bitset_test(bitset b, usize i) {
+    return (b->words[i / 64] >> (i % 64)) & 1;
+}
+
+// set every bit
+void bitset_set_all(bitset b) {
+    memset(b->words, 0xFF, __bitset_words(b->len) * sizeof(u64));
+    __bitset_trim(b);
+}
+
+// clear every bit
+void bitset_clear_all(bitset b) {
+    memset(b->words, 0, __bitset_words(b->len) * sizeof(u64));
+}
+
+#define __BITSET_BULK(name, op)                                             \
+    void bitset_##name(bitset dst, bitset src) {                            \
+        usize n = __bitset_words(dst->len < src->len ? dst->len : src->len);\
+        u64* d = dst->words;                                                \
+        const u64* s = src->words;                                          \
+        for (usize i = 0; i < n; i++) d[i] = op;                            \
+        __bitset_trim(dst);                                                 \
+    }
+
+// dst &= src
+__BITSET_BULK(and, d[i] & s[i])
+
+// dst |= src
+__BITSET_BULK(or, d[i] | s[i])
+
+// dst ^= src
+__BITSET_BULK(xor, d[i] ^ s[i])
+
+// dst &= ~src
+__BITSET_BULK(andnot, d[i] & ~s[i])
+
+
+// popcount kernels, picked at runtime
+
+usize __bitset_count_base(const u64* w, usize n) {
+    usize c = 0;
+    for (usize i = 0; i < n; i++) c += __builtin_popcountll(w[i]);
+    return c;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("popcnt")))
+usize __bitset_count_popcnt(const u64* w, usize n) {
+    // independent accumulators so the popcnts pipeline
+    usize c0 = 0, c1 = 0, c2 = 0, c3 = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c0 += __builtin_popcountll(w[i]);
+        c1 += __builtin_popcountll(w[i + 1]);
+        c2 += __builtin_popcountll(w[i + 2]);
+        c3 += __builtin_popcountll(w[i + 3]);
+    }
+    for (; i < n; i++) c0 += __builtin_popcountll(w[i]);
+    return c0 + c1 + c2 + c3;
+}
+
+// per-byte counts from a 4-bit lookup table with vpshufb, summed with vpsadbw
+__attribute__((target("avx2,popcnt")))
+usize __bitset_count_avx2(const u64* w, usize n) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i acc = _mm256_setzero_si256();
+    usize i = 0;
+    while (i + 8 <= n) {
+        // byte counts grow by at most 16 per step, so 15 steps fit in a byte
+        __m256i bytes = _mm256_setzero_si256();
+        for (int k = 0; k < 15 && i + 8 <= n; k++, i += 8) {
+            __m256i a = _mm256_loadu_si256((const __m256i*) (w + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*) (w + i + 4));
+            __m256i ca = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(a, low)),
+                                         _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(a, 4), low)));
+            __m256i cb = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(b, low)),
+                                         _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(b, 4), low)));
+            bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(ca, cb));
+        }
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    usize c = _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+            + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+    for (; i < n; i++) c += __builtin_popcountll(w[i]);
+    return c;
+}
+#endif
+
+usize __bitset_count_words(const u64* w, usize n) {
+#if defined(__x86_64__)
+    // the vector kernel only pays off once there are a few lines to go through
+    if (n >= 64 && std_cpu_has(STD_CPU_AVX2 | STD_CPU_POPCNT)) return __bitset_count_avx2(w, n);
+    if (std_cpu_has(STD_CPU_POPCNT)) return __bitset_count_popcnt(w, n);
+#endif
+    return __bitset_count_base(w, n);
+}
+
+// number of set bits
+usize bitset_count(bitset b) {
+    return __bitset_count_words(b->words, __bitset_words(b->len));
+}
+
+// first set bit at or after i, len if none
+usize bitset_next(bitset b, usize i) {
+    if (i >= b->len) return b->len;
+    u64 w = i / 64;
+    u64 bits = b->words[w] & (~(u64) 0 << (i % 64));
+    return __bitset_advance(b, &w, &bits) ? w * 64 + __builtin_ctzll(bits) : b->len;
+}
+
+// build the rank/select index
+int bitset_build_index(bitset b) {
+    __bitset_drop_index(b);
+    usize nw = __bitset_words(b->len), blocks = __bitset_blocks(b);
+    b->index = (u64*) std_malloc(b->alloc, blocks * sizeof(u64));
+    if (b->index == null) return -1;
+    u64 c = 0;
+    for (usize k = 0; k < blocks; k++) {
+        b->index[k] = c;
+        usize end = (k + 1) * 8 < nw ? (k + 1) * 8 : nw;
+        for (usize i = k * 8; i < end; i++) c += __builtin_popcountll(b->words[i]);
+    }
+    return 0;
+}
+
+// number of set bits before bit i
+usize bitset_rank(bitset b, usize i) {
+    if (i > b->len) i = b->len;
+    usize w = i / 64, from = 0, c = 0;
+    if (b->index != null) {
+        from = w / 8 * 8;
+        c = b->index[w / 8];
+    }
+    c += __bitset_count_words(b->words + from, w - from);
+    if (i % 64 != 0) c += __builtin_popcountll(b->words[w] & (((u64) 1 << (i % 64)) - 1));
+    return c;
+}
+
+// position of the k-th set bit in w, which has more than k
+usize __bitset_select_word(u64 w, usize k) {
+    usize pos = 0;
+    for (int half = 32; half >= 8; half /= 2) {
+        usize c = __builtin_popcountll(w & (((u64) 1 << half) - 1));
+        if (k >= c) {
+            k -= c;
+            w >>= half;
+            pos += half;
+        }
+    }
+    for (; k > 0; k--) w &= w - 1;
+    return pos + __builtin_ctzll(w);
+}
+
+// position of the k-th set bit (from 0), len if none
+usize bitset_select(bitset b, usize k) {
+    usize nw = __bitset_words(b->len), w = 0;
+    if (b->index != null) {
+        // last block with fewer than k + 1 set bits before it
+        usize lo = 0, hi = (nw + 7) / 8;
+        if (hi == 0 || b->index[hi] <= k) return b->len;
+        while (hi - lo > 1) {
+            usize mid = (lo + hi) / 2;
+            if (b->index[mid] <= k) lo = mid;
+            else hi = mid;
+        }
+        k -= b->index[lo];
+        w = lo * 8;
+    }
+    for (; w < nw; w++) {
+        usize c = __builtin_popcountll(b->words[w]);
+        if (k < c) return w * 64 + __bitset_select_word(b->words[w], k);
+        k -= c;
+    }
+    return b->len;
+}
+
+
+#endif // STD_BITSET_H
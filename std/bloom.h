@@ -0,0 +1,208 @@
+#ifndef STD_BLOOM_H
+#define STD_BLOOM_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "map.h"
+#include "str.h"
+#include "types.h"
+
+// bloom.h - blocked bloom filter
+// (every key's bits are in one 64-byte block, so a lookup touches one cache line)
+
+// Types
+
+// bloom filter type
+typedef struct __bloom {
+    u64* blocks;            // nblocks blocks of 8 words, 64-byte aligned
+    usize nblocks;
+    u32 k;                  // bits set per key
+    usize count;            // keys added
+    void* mem;              // what blocks was carved out of
+    STD_ALLOC_FIELD
+}* bloom;
+
+// words per block, one cache line
+#define STD_BLOOM_BLOCK_WORDS 8
+
+// Methods
+
+bloom       bloom_new(usize n, double fp);                  // filter for n keys with false-positive rate fp
+void        bloom_free(bloom b);                            // free all memory
+void        bloom_clear(bloom b);                           // remove every key
+usize       bloom_count(bloom b);                           // number of keys added
+
+void        bloom_add_bytes(bloom b, const void* p, usize n);   // add n raw bytes at p as a key
+bool        bloom_has_bytes(bloom b, const void* p, usize n);   // might n raw bytes at p have been added?
+void        bloom_add_hash(bloom b, usize h);               // add a key by its str_hash
+bool        bloom_has_hash(bloom b, usize h);               // might a key with this str_hash have been added?
+
+/*
+
+Generic methods
+    S - any string: str or c_str
+
+void        bloom_add(bloom, S)                             -- add a key
+bool        bloom_has(bloom, S)                             -- might the key have been added? false means it wasn't
+void        bloom_add_map(bloom, map)                       -- add every key of a map
+bool        bloom_map_contains(bloom, map, c_str)           -- map_contains that skips the map when the filter rules the key out
+void        bloom_map_insert(bloom, map, c_str, V)          -- map_insert that also adds the key to the filter
+
+bloom_new sizes the filter from the expected key count and false-positive rate, the
+usual m = -n ln(fp) / ln(2)^2 bits and k = m/n ln(2) bits per key, with 10% more
+bits to make up for blocking (keys aren't spread over the whole filter). Going past
+n keys still works, the false-positive rate just rises.
+
+Keys are hashed with str_hash, the same hash the map uses, then mixed: one part picks
+the block and the other gives the k bit positions in it by double hashing (h1 + i*h2),
+so adding or testing a key costs one hash and one cache line. A bloom filter can't
+remove keys, after map_remove the key stays in the filter (which is still correct,
+just slower for that key) until it's rebuilt with bloom_clear and bloom_add_map.
+
+*/
+
+
+// add a key
+#define bloom_add(b, s) \
+    bloom_add_hash((b), str_hash(s))
+
+
+// might the key have been added? false means it wasn't
+#define bloom_has(b, s) \
+    bloom_has_hash((b), str_hash(s))
+
+
+// add every key of a map
+#define bloom_add_map(b, m) \
+    __bloom_add_map((b), (void**) (m)->entries, (m)->cap)
+
+
+// map_contains that skips the map when the filter rules the key out
+#define bloom_map_contains(b, m, k) \
+    (bloom_has((b), (c_str) (k)) && map_contains((m), (k)))
+
+
+// map_insert that also adds the key to the filter
+#define bloom_map_insert(b, m, k, v)        \
+    do {                                    \
+        bloom_add((b), (c_str) (k));        \
+        map_insert((m), (k), (v));          \
+    } while(0)
+
+
+// DEFINITIONS
+
+
+bloom __bloom_new(STD_ALLOC_PARAM usize n, double fp) {
+    if (n == 0) n = 1;
+    if (!(fp > 0 && fp < 1)) fp = 0.01;
+    double bits = -(double) n * log(fp) / (0.6931471805599453 * 0.6931471805599453) * 1.1;
+    usize nblocks = (usize) ceil(bits / (64 * STD_BLOOM_BLOCK_WORDS));
+    double k = bits / n * 0.6931471805599453;
+    bloom b = (bloom) std_calloc(alloc, 1, sizeof(struct __bloom));
+    if (b == null) return null;
+    std_alloc_init(b, alloc);
+    b->nblocks = nblocks ? nblocks : 1;
+    b->k = k < 1 ? 1 : k > 16 ? 16 : (u32) (k + 0.5);
+    b->mem = std_malloc(alloc, b->nblocks * 64 + 63);
+    if (b->mem == null) {
+        std_free(alloc, b, sizeof(struct __bloom));
+        return null;
+    }
+    b->blocks = (u64*) (((uintptr_t) b->mem + 63) & ~(uintptr_t) 63);
+    bloom_clear(b);
+    return b;
+}
+
+// filter for n keys with false-positive rate fp
+bloom bloom_new(usize n, double fp) {
+    return __bloom_new(STD_ALLOC_DEFAULT n, fp);
+}
+
+// free all memory
+void bloom_free(bloom b) {
+    std_free(b->alloc, b->mem, b->nblocks * 64 + 63);
+    std_free(b->alloc, b, sizeof(struct __bloom));
+}
+
+// remove every key
+void bloom_clear(bloom b) {
+    memset(b->blocks, 0, b->nblocks * 64);
+    b->count = 0;
+}
+
+// number of keys added
+usize bloom_count(bloom b) {
+    return b->count;
+}
+
+// the block for hash h, and the double hashing pair in h1/h2
+u64* __bloom_locate(bloom b, usize h, u32* h1, u32* h2) {
+    // djb2 leaves the high bits poor, mix everything down first
+    u64 x = (u64) h;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    *h1 = (u32) x;
+    *h2 = (u32) (x >> 32) | 1;
+    u64 y = x * 0x9E3779B97F4A7C15ULL;
+    return b->blocks + (usize) (((unsigned __int128) y * b->nblocks) >> 64) * STD_BLOOM_BLOCK_WORDS;
+}
+
+// add a key by its str_hash
+void bloom_add_hash(bloom b, usize h) {
+    u32 h1, h2;
+    u64* block = __bloom_locate(b, h, &h1, &h2);
+    for (u32 i = 0; i < b->k; i++, h1 += h2) {
+        block[(h1 >> 6) & 7] |= (u64) 1 << (h1 & 63);
+    }
+    b->count++;
+}
+
+// might a key with this str_hash have been added?
+bool bloom_has_hash(bloom b, usize h) {
+    u32 h1, h2;
+    u64* block = __bloom_locate(b, h, &h1, &h2);
+    u64 miss = 0;
+    for (u32 i = 0; i < b->k; i++, h1 += h2) {
+        miss |= ~block[(h1 >> 6) & 7] & ((u64) 1 << (h1 & 63));
+    }
+    return miss == 0;
+}
+
+// str_hash's djb2 over raw bytes
+usize __bloom_hash_bytes(const void* p, usize n) {
+    const u8* s = (const u8*) p;
+    usize hash = 5381;
+    for (usize i = 0; i < n; i++) {
+        hash = ((hash << 5) + hash) + s[i];
+    }
+    return hash;
+}
+
+// add n raw bytes at p as a key
+void bloom_add_bytes(bloom b, const void* p, usize n) {
+    bloom_add_hash(b, __bloom_hash_bytes(p, n));
+}
+
+// might n raw bytes at p have been added?
+bool bloom_has_bytes(bloom b, const void* p, usize n) {
+    return bloom_has_hash(b, __bloom_hash_bytes(p, n));
+}
+
+void __bloom_add_map(bloom b, void** entries, usize cap) {
+    for (usize i = 0; i < cap; i++) {
+        for (void* e = entries[i]; e != null; e = *STD_MAP_E_NEXT(e)) {
+            bloom_add_hash(b, str_hash(*STD_MAP_E_KEY(e)));
+        }
+    }
+}
+
+
+#endif // STD_BLOOM_H
@@ -0,0 +1,58 @@
+#ifndef STD_CPU_H
+#define STD_CPU_H
+
+#include "types.h"
+
+#include <stdatomic.h>
+
+/*
+
+cpu.h - cached cpu feature probe for the headers with vector kernels
+
+** Features **
+std_cpu_has(f)                      -- does the cpu have every feature in f (STD_CPU_* or'ed together)
+std_cpu_features()                  -- all the STD_CPU_* features the cpu has
+
+The features are probed with __builtin_cpu_supports on the first call and kept in one
+atomic word, so any thread can ask at any time: threads racing through the first call
+all probe the same cpu and store the same value. Outside x86 there are none.
+
+*/
+
+#define STD_CPU_POPCNT  (1u << 0)
+#define STD_CPU_SSE42   (1u << 1)
+#define STD_CPU_AVX2    (1u << 2)
+#define STD_CPU_FMA     (1u << 3)
+
+// set in the cached word once the probe has run
+#define __STD_CPU_PROBED (1u << 31)
+
+
+atomic_uint __std_cpu = 0;
+
+unsigned __std_cpu_probe() {
+    unsigned f = __STD_CPU_PROBED;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt")) f |= STD_CPU_POPCNT;
+    if (__builtin_cpu_supports("sse4.2")) f |= STD_CPU_SSE42;
+    if (__builtin_cpu_supports("avx2")) f |= STD_CPU_AVX2;
+    if (__builtin_cpu_supports("fma")) f |= STD_CPU_FMA;
+#endif
+    atomic_store_explicit(&__std_cpu, f, memory_order_relaxed);
+    return f;
+}
+
+// all the STD_CPU_* features the cpu has
+unsigned std_cpu_features() {
+    unsigned f = atomic_load_explicit(&__std_cpu, memory_order_relaxed);
+    return (f != 0 ? f : __std_cpu_probe()) & ~__STD_CPU_PROBED;
+}
+
+// does the cpu have every feature in f (STD_CPU_* or'ed together)
+bool std_cpu_has(unsigned f) {
+    return (std_cpu_features() & f) == f;
+}
+
+
+#endif // STD_CPU_H
@@ -0,0 +1,259 @@
+#ifndef STD_DEQUE_H
+#define STD_DEQUE_H
+
+#include "alloc.h"
+#include "types.h"
+#include "vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+deque.h - generic double-ended queue in C
+(ring buffer with power-of-two capacity, O(1) push/pop at both ends)
+
+deque(T) - the type of a deque. Until C23, typedef this to something before using
+
+** Memory management **
+deque_init(d)                       -- initialize deque
+deque_init_with(d, a)               -- initialize deque using allocator a (STD_USE_ALLOCATOR only)
+deque_free(d)                       -- free all memory
+deque_reserve(d, n)                 -- reserve size for n elements (rounded up to a power of two)
+deque_clear(d)                      -- len = 0
+
+** Properties **
+deque_len(d)                        -- the number of elements
+deque_is_empty(d)                   -- is the deque empty?
+deque_at(d, i)                      -- element i counting from the front
+deque_front(d)                      -- get first element
+deque_back(d)                       -- get last element
+
+** Operations **
+deque_push_back(d, val)             -- push a value at the back
+deque_push_front(d, val)            -- push a value at the front
+deque_pop_back(d)                   -- pop the last element off and return it
+deque_pop_front(d)                  -- pop the first element off and return it
+deque_push_back_n(d, b, n)          -- push n elements from buffer b at the back, b[n-1] ends up last
+deque_push_front_n(d, b, n)         -- push n elements from buffer b at the front, b[0] ends up first
+deque_pop_back_n(d, b, n)           -- pop up to n elements off the back into b in order, returns count
+deque_pop_front_n(d, b, n)          -- pop up to n elements off the front into b in order, returns count
+
+** Iteration **
+deque_iter(d, t)                    -- stores each value in t, front to back
+deque_enum(d, i, t)                 -- enumerate: stores each index in i and each value in t
+
+The bulk operations copy in at most two memcpy segments, one on each side of the wrap.
+deque_pop_back and deque_pop_front are expressions ending in the element, so dropping
+it needs a (void) cast to keep -Wunused-value quiet.
+
+*/
+
+#define deque(T)      \
+  struct {            \
+    T* data;          \
+    usize len;        \
+    usize cap;        \
+    usize head;       \
+    STD_ALLOC_FIELD   \
+  }*                  \
+
+
+// predefined types
+
+typedef deque(void*)  deque_void;
+typedef deque(char*)  deque_cstr;
+typedef deque(int)    deque_int;
+typedef deque(char)   deque_char;
+typedef deque(float)  deque_float;
+typedef deque(double) deque_double;
+
+
+#define __d_unpack(d) \
+  STD_ALLOC_ARG(d) (void**)&(d)->data, &(d)->len, &(d)->cap, &(d)->head, sizeof(*(d)->data)
+
+
+#define __d_fields(d) \
+  (void**)&(d)->data, &(d)->len, &(d)->cap, &(d)->head, sizeof(*(d)->data)
+
+
+#define __d_ring(d) \
+  (void*)(d)->data, (d)->cap, (d)->head, sizeof(*(d)->data)
+
+
+#define __d_mask(d, i) \
+  ((i) & ((d)->cap - 1))
+
+
+// initialize deque
+#define deque_init(d) \
+  __d_init_with(d, std_allocator_get())
+
+
+#ifdef STD_USE_ALLOCATOR
+// initialize deque using allocator a
+#define deque_init_with(d, a) \
+  __d_init_with(d, a)
+#endif
+
+
+#define __d_init_with(d, a) \
+  ((d) = std_calloc((a), 1, sizeof(*(d))), std_alloc_init((d), (a)))
+
+
+// free all memory
+#define deque_free(d)                                               \
+  do {                                                              \
+    std_free((d)->alloc, (d)->data, (d)->cap * sizeof(*(d)->data)); \
+    std_free((d)->alloc, (d), sizeof(*(d)));                        \
+  } while(0)
+
+
+// reserve size for n elements (rounded up to a power of two)
+#define deque_reserve(d, n) \
+  __d_reserve(__d_unpack(d), n)
+
+
+// len = 0
+#define deque_clear(d) \
+  ((d)->len = 0, (d)->head = 0)
+
+
+// the number of elements
+#define deque_len(d) \
+  ((d)->len)
+
+
+// is the deque empty?
+#define deque_is_empty(d) \
+  ((d)->len == 0)
+
+
+// element i counting from the front
+#define deque_at(d, i) \
+  ((d)->data[__d_mask(d, (d)->head + (i))])
+
+
+// get first element
+#define deque_front(d) \
+  ((d)->data[(d)->head])
+
+
+// get last element
+#define deque_back(d) \
+  ((d)->data[__d_mask(d, (d)->head + (d)->len - 1)])
+
+
+// push a value at the back
+#define deque_push_back(d, val)                                             \
+  ((d)->len == (d)->cap && __d_reserve(__d_unpack(d), (d)->len + 1) ? -1 :  \
+   ((d)->data[__d_mask(d, (d)->head + (d)->len)] = (val), (d)->len++, 0))
+
+
+// push a value at the front
+#define deque_push_front(d, val)                                            \
+  ((d)->len == (d)->cap && __d_reserve(__d_unpack(d), (d)->len + 1) ? -1 :  \
+   ((d)->head = __d_mask(d, (d)->head - 1), (d)->len++,                     \
+    (d)->data[(d)->head] = (val), 0))
+
+
+// pop the last element off and return it
+#define deque_pop_back(d) \
+  ((d)->len--, (d)->data[__d_mask(d, (d)->head + (d)->len)])
+
+
+// pop the first element off and return it
+#define deque_pop_front(d) \
+  ((d)->len--, (d)->head = __d_mask(d, (d)->head + 1), (d)->data[__d_mask(d, (d)->head - 1)])
+
+
+// push n elements from buffer b at the back, b[n-1] ends up last
+#define deque_push_back_n(d, b, n)                                          \
+  (__v_check_buf(d, b),                                                     \
+   __d_reserve(__d_unpack(d), (d)->len + (n)) ? -1 :                        \
+   (__d_write(__d_ring(d), (d)->len, (b), (n)), (d)->len += (n), 0))
+
+
+// push n elements from buffer b at the front, b[0] ends up first
+#define deque_push_front_n(d, b, n)                                         \
+  (__v_check_buf(d, b),                                                     \
+   __d_reserve(__d_unpack(d), (d)->len + (n)) ? -1 :                        \
+   ((d)->head = __d_mask(d, (d)->head - (n)), (d)->len += (n),              \
+    __d_write(__d_ring(d), 0, (b), (n)), 0))
+
+
+// pop up to n elements off the back into b in order, returns count
+#define deque_pop_back_n(d, b, n)                                           \
+  (__v_check_buf(d, b), __d_pop_back_n(__d_fields(d), (b), (n)))
+
+
+// pop up to n elements off the front into b in order, returns count
+#define deque_pop_front_n(d, b, n)                                          \
+  (__v_check_buf(d, b), __d_pop_front_n(__d_fields(d), (b), (n)))
+
+
+// stores each value in t, front to back
+#define deque_iter(d, t)                                                                    \
+  if ((d)->len > 0)                                                                         \
+  for (usize __i = 0; __i < (d)->len && (((t) = deque_at(d, __i)), 1); ++__i)               \
+
+
+// enumerate: stores each index in i and each value in t
+#define deque_enum(d, i, t)                                                                 \
+  if ((d)->len > 0)                                                                         \
+  for (i = 0; i < (d)->len && (((t) = deque_at(d, i)), 1); ++i)                             \
+
+
+int __d_reserve(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize* head, usize memsz, usize n) {
+  if (n <= *cap) return 0;
+  usize ncap = (*cap == 0) ? 4 : *cap;
+  while (ncap < n) ncap <<= 1;
+  void* ptr = std_realloc(alloc, *data, *cap * memsz, ncap * memsz);
+  if (ptr == null) return -1;
+  // the part that wrapped around to the start moves up past the old end,
+  // it's shorter than the old capacity so it always fits
+  if (*head + *len > *cap) {
+    memcpy((char*) ptr + *cap * memsz, ptr, (*head + *len - *cap) * memsz);
+  }
+  *data = ptr;
+  *cap = ncap;
+  return 0;
+}
+
+
+void __d_write(void* data, usize cap, usize head, usize memsz, usize pos, const void* src, usize n) {
+  usize start = (head + pos) & (cap - 1);
+  usize first = cap - start < n ? cap - start : n;
+  memcpy((char*) data + start * memsz, src, first * memsz);
+  memcpy(data, (const char*) src + first * memsz, (n - first) * memsz);
+}
+
+
+void __d_read(const void* data, usize cap, usize head, usize memsz, usize pos, void* dst, usize n) {
+  usize start = (head + pos) & (cap - 1);
+  usize first = cap - start < n ? cap - start : n;
+  memcpy(dst, (const char*) data + start * memsz, first * memsz);
+  memcpy((char*) dst + first * memsz, data, (n - first) * memsz);
+}
+
+
+usize __d_pop_back_n(void** data, usize* len, usize* cap, usize* head, usize memsz, void* dst, usize n) {
+  if (n > *len) n = *len;
+  if (n == 0) return 0;
+  *len -= n;
+  __d_read(*data, *cap, *head, memsz, *len, dst, n);
+  return n;
+}
+
+
+usize __d_pop_front_n(void** data, usize* len, usize* cap, usize* head, usize memsz, void* dst, usize n) {
+  if (n > *len) n = *len;
+  if (n == 0) return 0;
+  __d_read(*data, *cap, *head, memsz, 0, dst, n);
+  *head = (*head + n) & (*cap - 1);
+  *len -= n;
+  return n;
+}
+
+
+#endif // STD_DEQUE_H
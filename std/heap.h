@@ -0,0 +1,346 @@
+#ifndef STD_HEAP_H
+#define STD_HEAP_H
+
+#include "alloc.h"
+#include "types.h"
+#include "vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+heap.h - generic priority queues in C
+(4-ary min-heaps on top of vec)
+
+heap(T) - the type of a heap, same layout as vec(T) so the vec_ macros work on it too
+
+** Memory management **
+heap_init(h)                        -- initialize heap
+heap_free(h)                        -- free all memory
+heap_reserve(h, n)                  -- reserve size for n elements
+heap_clear(h)                       -- len = 0
+
+** Properties **
+heap_len(h)                         -- the number of elements
+heap_is_empty(h)                    -- is the heap empty?
+heap_top(h)                         -- smallest element, h must not be empty
+
+** Operations **
+heap_push(h, val)                   -- add val
+heap_pop(h, t)                      -- remove the smallest element and store it in t
+heap_heapify(h)                     -- restore heap order after changing data directly, O(n)
+heap_from_vec(h, v)                 -- take over v's buffer (v is set to null) and heapify it
+heap_push_by(h, val, less)          -- heap_push with less(a, b) instead of a < b
+heap_pop_by(h, t, less)             -- heap_pop with less(a, b) instead of a < b
+heap_heapify_by(h, less)            -- heap_heapify with less(a, b) instead of a < b
+
+iheap(T) - indexed heap of (id, key) pairs ordered by key, ids are small non-negative
+integers (node numbers, timer slots...) and each one is in the heap at most once
+
+** Memory management **
+iheap_init(h)                       -- initialize indexed heap
+iheap_free(h)                       -- free all memory
+
+** Properties **
+iheap_len(h)                        -- the number of entries
+iheap_is_empty(h)                   -- is the heap empty?
+iheap_top_id(h)                     -- id with the smallest key, h must not be empty
+iheap_top_key(h)                    -- the smallest key, h must not be empty
+iheap_contains(h, i)                -- is id i in the heap?
+iheap_key(h, i)                     -- key of id i, which must be in the heap
+
+** Operations **
+iheap_push(h, i, k)                 -- insert id i with key k, or move it to k if it's already in
+iheap_decrease(h, i, k)             -- lower the key of id i to k, i must be in the heap
+iheap_pop(h, i, k)                  -- remove the top entry, storing its id in i and key in k
+
+Children of element i are at 4i+1 .. 4i+4: a 4-ary heap is half as deep as a binary
+one and the 4 children usually share a cache line, so pops touch fewer lines.
+less is a function or macro taking two values, so it gets inlined into the sift loops.
+For a max-heap use a less that compares the other way round.
+
+*/
+
+#define heap(T) \
+  vec(T)
+
+
+// initialize heap
+#define heap_init(h) \
+  vec_init(h)
+
+
+// free all memory
+#define heap_free(h) \
+  vec_free(h)
+
+
+// reserve size for n elements
+#define heap_reserve(h, n) \
+  vec_reserve(h, n)
+
+
+// len = 0
+#define heap_clear(h) \
+  vec_clear(h)
+
+
+// the number of elements
+#define heap_len(h) \
+  ((h)->len)
+
+
+// is the heap empty?
+#define heap_is_empty(h) \
+  ((h)->len == 0)
+
+
+// smallest element, h must not be empty
+#define heap_top(h) \
+  ((h)->data[0])
+
+
+// add val
+#define heap_push(h, val) \
+  heap_push_by(h, val, __h_less)
+
+
+// remove the smallest element and store it in t
+#define heap_pop(h, t) \
+  heap_pop_by(h, t, __h_less)
+
+
+// restore heap order after changing data directly, O(n)
+#define heap_heapify(h) \
+  heap_heapify_by(h, __h_less)
+
+
+// take over v's buffer (v is set to null) and heapify it
+#define heap_from_vec(h, v)                                                 \
+  do {                                                                      \
+    *(void**)&(h) = (v);                                                    \
+    (v) = null;                                                             \
+    heap_heapify(h);                                                        \
+  } while (0)
+
+
+// heap_push with less(a, b) instead of a < b
+#define heap_push_by(h, val, less)                                          \
+  do {                                                                      \
+    if (__v_expand(__v_unpack(h)) != 0) break;                              \
+    (h)->data[(h)->len++] = (val);                                          \
+    __h_sift_up(h, (h)->len - 1, less);                                     \
+  } while (0)
+
+
+// heap_pop with less(a, b) instead of a < b
+#define heap_pop_by(h, t, less)                                             \
+  do {                                                                      \
+    (t) = (h)->data[0];                                                     \
+    (h)->data[0] = (h)->data[--(h)->len];                                   \
+    if ((h)->len > 1) __h_sift_down(h, 0, less);                            \
+  } while (0)
+
+
+// heap_heapify with less(a, b) instead of a < b
+#define heap_heapify_by(h, less)                                            \
+  do {                                                                      \
+    if ((h)->len < 2) break;                                                \
+    for (usize __j = ((h)->len - 2) / 4 + 1; __j-- > 0;) {                  \
+      __h_sift_down(h, __j, less);                                          \
+    }                                                                       \
+  } while (0)
+
+
+#define __h_less(a, b) \
+  ((a) < (b))
+
+
+// moves element i up until its parent isn't bigger
+#define __h_sift_up(h, i, less)                                             \
+  do {                                                                      \
+    usize __i = (i);                                                        \
+    __typeof__(*(h)->data) __x = (h)->data[__i];                            \
+    while (__i > 0) {                                                       \
+      usize __p = (__i - 1) / 4;                                            \
+      if (!less(__x, (h)->data[__p])) break;                                \
+      (h)->data[__i] = (h)->data[__p];                                      \
+      __i = __p;                                                            \
+    }                                                                       \
+    (h)->data[__i] = __x;                                                   \
+  } while (0)
+
+
+// moves element i down until none of its children are smaller
+#define __h_sift_down(h, i, less)                                           \
+  do {                                                                      \
+    usize __i = (i), __n = (h)->len;                                        \
+    __typeof__(*(h)->data) __x = (h)->data[__i];                            \
+    for (;;) {                                                              \
+      usize __c = 4 * __i + 1;                                              \
+      if (__c >= __n) break;                                                \
+      usize __m = __c, __e = __c + 4 < __n ? __c + 4 : __n;                 \
+      for (usize __k = __c + 1; __k < __e; __k++) {                         \
+        __m = less((h)->data[__k], (h)->data[__m]) ? __k : __m;             \
+      }                                                                     \
+      if (!less((h)->data[__m], __x)) break;                                \
+      (h)->data[__i] = (h)->data[__m];                                      \
+      __i = __m;                                                            \
+    }                                                                       \
+    (h)->data[__i] = __x;                                                   \
+  } while (0)
+
+
+// indexed heap
+
+#define iheap(T)                                                            \
+  struct {                                                                  \
+    struct { T key; usize id; }* data;                                      \
+    usize len;                                                              \
+    usize cap;                                                              \
+    STD_ALLOC_FIELD                                                         \
+    usize* pos;           /* pos[id] is the index of id in data, or -1 */   \
+    usize ids;            /* length of pos */                               \
+  }*
+
+
+// initialize indexed heap
+#define iheap_init(h) \
+  vec_init(h)
+
+
+// free all memory
+#define iheap_free(h)                                                       \
+  do {                                                                      \
+    std_free((h)->alloc, (h)->pos, (h)->ids * sizeof(usize));               \
+    vec_free(h);                                                            \
+  } while (0)
+
+
+// the number of entries
+#define iheap_len(h) \
+  ((h)->len)
+
+
+// is the heap empty?
+#define iheap_is_empty(h) \
+  ((h)->len == 0)
+
+
+// id with the smallest key, h must not be empty
+#define iheap_top_id(h) \
+  ((h)->data[0].id)
+
+
+// the smallest key, h must not be empty
+#define iheap_top_key(h) \
+  ((h)->data[0].key)
+
+
+// is id i in the heap?
+#define iheap_contains(h, i) \
+  ((usize) (i) < (h)->ids && (h)->pos[i] != (usize) -1)
+
+
+// key of id i, which must be in the heap
+#define iheap_key(h, i) \
+  ((h)->data[(h)->pos[i]].key)
+
+
+// insert id i with key k, or move it to k if it's already in
+#define iheap_push(h, i, k)                                                 \
+  do {                                                                      \
+    usize __id = (i);                                                      \
+    if (iheap_contains(h, __id)) {                                          \
+      usize __at = (h)->pos[__id];                                          \
+      __typeof__((h)->data->key) __old = (h)->data[__at].key;              \
+      (h)->data[__at].key = (k);                                            \
+      if ((h)->data[__at].key < __old) __ih_sift_up(h, __at);               \
+      else __ih_sift_down(h, __at);                                         \
+      break;                                                                \
+    }                                                                       \
+    if (__ih_reserve_ids(STD_ALLOC_ARG(h) &(h)->pos, &(h)->ids, __id)       \
+        || __v_expand(__v_unpack(h))) break;                                \
+    (h)->data[(h)->len].key = (k);                                          \
+    (h)->data[(h)->len].id = __id;                                          \
+    (h)->pos[__id] = (h)->len++;                                            \
+    __ih_sift_up(h, (h)->len - 1);                                          \
+  } while (0)
+
+
+// lower the key of id i to k, i must be in the heap
+#define iheap_decrease(h, i, k)                                             \
+  do {                                                                      \
+    usize __at = (h)->pos[i];                                               \
+    (h)->data[__at].key = (k);                                              \
+    __ih_sift_up(h, __at);                                                  \
+  } while (0)
+
+
+// remove the top entry, storing its id in i and key in k
+#define iheap_pop(h, i, k)                                                  \
+  do {                                                                      \
+    (i) = (h)->data[0].id;                                                  \
+    (k) = (h)->data[0].key;                                                 \
+    (h)->pos[(h)->data[0].id] = (usize) -1;                                 \
+    if (--(h)->len == 0) break;                                             \
+    (h)->data[0] = (h)->data[(h)->len];                                     \
+    (h)->pos[(h)->data[0].id] = 0;                                          \
+    __ih_sift_down(h, 0);                                                   \
+  } while (0)
+
+
+// same as __h_sift_up/__h_sift_down on keys, keeping pos up to date
+#define __ih_sift_up(h, i)                                                  \
+  do {                                                                      \
+    usize __i = (i);                                                        \
+    __typeof__(*(h)->data) __x = (h)->data[__i];                            \
+    while (__i > 0) {                                                       \
+      usize __p = (__i - 1) / 4;                                            \
+      if (!(__x.key < (h)->data[__p].key)) break;                           \
+      (h)->data[__i] = (h)->data[__p];                                      \
+      (h)->pos[(h)->data[__i].id] = __i;                                    \
+      __i = __p;                                                            \
+    }                                                                       \
+    (h)->data[__i] = __x;                                                   \
+    (h)->pos[__x.id] = __i;                                                 \
+  } while (0)
+
+
+#define __ih_sift_down(h, i)                                                \
+  do {                                                                      \
+    usize __i = (i), __n = (h)->len;                                        \
+    __typeof__(*(h)->data) __x = (h)->data[__i];                            \
+    for (;;) {                                                              \
+      usize __c = 4 * __i + 1;                                              \
+      if (__c >= __n) break;                                                \
+      usize __m = __c, __e = __c + 4 < __n ? __c + 4 : __n;                 \
+      for (usize __k = __c + 1; __k < __e; __k++) {                         \
+        __m = (h)->data[__k].key < (h)->data[__m].key ? __k : __m;          \
+      }                                                                     \
+      if (!((h)->data[__m].key < __x.key)) break;                           \
+      (h)->data[__i] = (h)->data[__m];                                      \
+      (h)->pos[(h)->data[__i].id] = __i;                                    \
+      __i = __m;                                                            \
+    }                                                                       \
+    (h)->data[__i] = __x;                                                   \
+    (h)->pos[__x.id] = __i;                                                 \
+  } while (0)
+
+
+// grows pos so it covers id, new slots are -1
+int __ih_reserve_ids(STD_ALLOC_PARAM usize** pos, usize* ids, usize id) {
+  if (id < *ids) return 0;
+  usize n = *ids == 0 ? 16 : *ids;
+  while (n <= id) n <<= 1;
+  usize* p = std_realloc(alloc, *pos, *ids * sizeof(usize), n * sizeof(usize));
+  if (p == null) return -1;
+  memset(p + *ids, 0xFF, (n - *ids) * sizeof(usize));
+  *pos = p;
+  *ids = n;
+  return 0;
+}
+
+
+#endif // STD_HEAP_H
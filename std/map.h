@@ -7,7 +7,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include "alloc.h"
 #include "array.h"
+#include "pool.h"
 #include "str.h"
 #include "types.h"
 
@@ -20,6 +22,7 @@ Until C23, typedef this to something before using (see examples).
 
 ** Memory management **
 map_init(m)                     -- initialize map
+map_init_with(m, a)             -- initialize map using allocator a (STD_USE_ALLOCATOR only)
 map_free(m)                     -- free all memory
 map_clear(m)                    -- clear all keys and values
 
@@ -38,6 +41,42 @@ map_keys(m)                     -- return array of all keys in the map
 
 */
 
+#ifdef STD_USE_POOL
+
+// entries come from a per-map pool
+#define STD_MAP_POOL_FIELD pool entry_pool;
+
+#define __m_pool_init(m) \
+    ((m)->entry_pool = __pool_new(STD_ALLOC_ARG(m) STD_MAP_SIZEOF_ENTRY(m)))
+
+#define __m_pool_free(m) \
+    pool_free((m)->entry_pool)
+
+#define __m_entry_new(m) \
+    pool_alloc((m)->entry_pool)
+
+#define __m_entry_free(m, e) \
+    pool_release((m)->entry_pool, (e))
+
+#else
+
+#define STD_MAP_POOL_FIELD
+
+#define __m_pool_init(m) \
+    ((void)0)
+
+#define __m_pool_free(m) \
+    ((void)0)
+
+#define __m_entry_new(m) \
+    std_malloc((m)->alloc, STD_MAP_SIZEOF_ENTRY(m))
+
+#define __m_entry_free(m, e) \
+    std_free((m)->alloc, (e), STD_MAP_SIZEOF_ENTRY(m))
+
+#endif // STD_USE_POOL
+
+
 #define map(V)              \
     struct {                \
         struct {            \
@@ -47,6 +86,8 @@ map_keys(m)                     -- return array of all keys in the map
         }** entries;        \
         usize size;         \
         usize cap;          \
+        STD_ALLOC_FIELD     \
+        STD_MAP_POOL_FIELD  \
     }*
 
 
@@ -70,7 +111,7 @@ typedef map(double) map_double;
 #define STD_MAP_RESIZE_FACTOR 2
 
 // size of any map type
-#define STD_MAP_SIZEOF_MAP sizeof(struct{void* e; usize s, c;})
+#define STD_MAP_SIZEOF_MAP sizeof(struct{void* e; usize s, c; STD_ALLOC_FIELD STD_MAP_POOL_FIELD})
 
 // size of an entry for a specific map
 #define STD_MAP_SIZEOF_ENTRY(m) sizeof(**(m)->entries)
@@ -100,36 +141,55 @@ typedef map(double) map_double;
 
 
 // initialize map
-#define map_init(m)                                                     \
-    do {                                                                \
-        (m) = malloc(STD_MAP_SIZEOF_MAP);                               \
-        (m)->entries = calloc(STD_MAP_STARTING_CAP, sizeof(void*));     \
-        (m)->cap = STD_MAP_STARTING_CAP;                                \
-        (m)->size = 0;                                                  \
+#define map_init(m) \
+    __m_init_with(m, std_allocator_get())
+
+
+#ifdef STD_USE_ALLOCATOR
+// initialize map using allocator a
+#define map_init_with(m, a) \
+    __m_init_with(m, a)
+#endif
+
+
+#define __m_init_with(m, a)                                                     \
+    do {                                                                        \
+        (m) = std_malloc((a), STD_MAP_SIZEOF_MAP);                              \
+        std_alloc_init((m), (a));                                               \
+        (m)->entries = std_calloc((a), STD_MAP_STARTING_CAP, sizeof(void*));    \
+        (m)->cap = STD_MAP_STARTING_CAP;                                        \
+        (m)->size = 0;                                                          \
+        __m_pool_init(m);                                                       \
     } while(0)
 
 
 // free all memory
-#define map_free(m)                                         \
-    do {                                                    \
-        for (usize mdi_ = 0; mdi_ < (m)->cap; mdi_++) {     \
-            if ((m)->entries[mdi_] == null) {               \
-                continue;                                   \
-            }                                               \
-            free((m)->entries[mdi_]->next);                 \
-            free((m)->entries[mdi_]->key);                  \
-        }                                                   \
-        free((m)->entries);                                 \
-        free((m));                                          \
-        (m) = null;                                         \
+#define map_free(m)                                                         \
+    do {                                                                    \
+        for (usize mdi_ = 0; mdi_ < (m)->cap; mdi_++) {                     \
+            void* mde_ = (m)->entries[mdi_];                                \
+            while (mde_ != null) {                                          \
+                void* mdn_ = *STD_MAP_E_NEXT(mde_);                         \
+                c_str mdk_ = *STD_MAP_E_KEY(mde_);                          \
+                std_free((m)->alloc, mdk_, strlen(mdk_) + 1);               \
+                __m_entry_free(m, mde_);                                    \
+                mde_ = mdn_;                                                \
+            }                                                               \
+        }                                                                   \
+        std_free((m)->alloc, (m)->entries, (m)->cap * sizeof(void*));      \
+        __m_pool_free(m);                                                   \
+        std_free((m)->alloc, (m), STD_MAP_SIZEOF_MAP);                      \
+        (m) = null;                                                         \
     } while(0)
 
 
 // clear all keys and values
-#define map_clear(m)    \
-    do {                \
-        map_free(m);    \
-        map_init(m);    \
+#define map_clear(m)                            \
+    do {                                        \
+        allocator* mca_ = std_allocator_of(m);  \
+        (void)mca_;                             \
+        map_free(m);                            \
+        __m_init_with(m, mca_);                 \
     } while(0)
 
 
@@ -177,17 +237,18 @@ bool __m_contains(void*** entries, usize* size, usize* cap, usize memsz, c_str k
             __m_rh(m);                                          \
         }                                                       \
         isize msi_ = str_hash(k) % (m)->cap;                    \
-        while ((m)->entries[msi_] != null) {                    \
-            if (str_equals((m)->entries[msi_]->key, (k))) {     \
-                (m)->entries[msi_]->value = (v);                \
+        void* msc_ = (m)->entries[msi_];                        \
+        while (msc_ != null) {                                  \
+            if (str_equals(*STD_MAP_E_KEY(msc_), (k))) {        \
+                ((__typeof__(*(m)->entries))msc_)->value = (v); \
                 goto __m_label(__m_ins_end_, l);                \
             }                                                   \
-            (m)->entries[msi_] = (m)->entries[msi_]->next;      \
+            msc_ = *STD_MAP_E_NEXT(msc_);                       \
         }                                                       \
         void* mso_ = (m)->entries[msi_];                        \
-        void* mse_ = malloc(STD_MAP_SIZEOF_ENTRY(m));           \
+        void* mse_ = __m_entry_new(m);                          \
         (m)->entries[msi_] = mse_;                              \
-        (m)->entries[msi_]->key = strdup(k);                    \
+        (m)->entries[msi_]->key = std_strdup((m)->alloc, k);    \
         (m)->entries[msi_]->value = (v);                        \
         (m)->entries[msi_]->next = mso_;                        \
         (m)->size++;                                            \
@@ -203,7 +264,7 @@ bool __m_contains(void*** entries, usize* size, usize* cap, usize memsz, c_str k
 #define __m_rh(m)                                                       \
     do {                                                                \
         usize mrhnc_ = STD_MAP_RESIZE_FACTOR * (m)->cap;                \
-        void** mrhe2_ = (void**) calloc(mrhnc_, sizeof(void*));         \
+        void** mrhe2_ = (void**) std_calloc((m)->alloc, mrhnc_, sizeof(void*)); \
         for (usize mrhi_ = 0; mrhi_ < (m)->cap; mrhi_++) {              \
             void* e = (m)->entries[mrhi_];                              \
             while (e != null) {                                         \
@@ -214,7 +275,7 @@ bool __m_contains(void*** entries, usize* size, usize* cap, usize memsz, c_str k
                 e = mrhnx_;                                             \
             }                                                           \
         }                                                               \
-        free((m)->entries);                                             \
+        std_free((m)->alloc, (m)->entries, (m)->cap * sizeof(void*));   \
         *((void***) &((m)->entries)) = mrhe2_;                          \
         (m)->cap = mrhnc_;                                              \
     } while(0)
@@ -252,8 +313,9 @@ void* __m_key_addr(void*** entries, usize* size, usize* cap, usize memsz, c_str
                 } else {                                                    \
                     *STD_MAP_E_NEXT(prev) = *STD_MAP_E_NEXT(entry);         \
                 }                                                           \
-                free(*STD_MAP_E_KEY(entry));                                \
-                free(entry);                                                \
+                std_free((m)->alloc, *STD_MAP_E_KEY(entry),                 \
+                         strlen(*STD_MAP_E_KEY(entry)) + 1);                \
+                __m_entry_free(m, entry);                                   \
                 (m)->size--;                                                \
                 goto __m_label(__mr, l);                                    \
             }                                                               \
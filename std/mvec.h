@@ -0,0 +1,285 @@
+#ifndef STD_MVEC_H
+#define STD_MVEC_H
+
+#include "alloc.h"
+#include "types.h"
+#include "vec.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+
+mvec.h - generic dynamic array backed by a memory-mapped file in C
+
+mvec(T) - the type of a file-backed vector, T should be plain data (no pointers).
+It starts with the same data/len/cap fields as vec(T), so the vec_ macros that don't
+allocate (vec_at, vec_iter, vec_find, vec_lower_bound, vec_sort, ...) work on it too.
+
+** Memory management **
+mvec_open(v, path, flags)           -- map the file at path, returns 0 or -1 with errno set
+mvec_close(v)                       -- flush, unmap and free
+mvec_reserve(v, n)                  -- reserve size for n elements, growing the file
+mvec_flush(v)                       -- write len to the file header and msync everything to disk
+mvec_refresh(v)                     -- (readers) pick up len and growth from the file header
+mvec_truncate(v, n)                 -- reduce to just the first n elements
+mvec_clear(v)                       -- len = 0
+
+** Properties **
+mvec_len(v)                         -- the length of the vector
+mvec_at(v, i)                       -- return value at index i
+
+** Operations **
+mvec_push(v, val)                   -- pushes a value onto vector, returns 0 or -1
+mvec_pop(v)                         -- pops an element off and returns it
+mvec_extend_from(v, b, n)           -- push n elements from buffer b, returns 0 or -1
+
+** Flags **
+STD_MVEC_READ                       -- open an existing file read-only
+STD_MVEC_WRITE                      -- open an existing file read-write
+STD_MVEC_CREATE                     -- read-write, creating the file if it doesn't exist
+
+The file is a 64-byte header (magic, format version, element size, len, cap) followed by
+cap elements. Opening checks the header against sizeof(T) and STD_MVEC_VERSION, and maps
+the file without reading it, so pages are only loaded as they're touched and every
+process mapping the same file shares them through the page cache.
+
+Growing doubles cap with ftruncate and remaps, which can move data. len lives in the
+struct and is only written to the header by mvec_flush and mvec_close, so after a crash
+the file holds the last flushed length. Readers see a writer's appends once it has
+flushed and they call mvec_refresh.
+
+*/
+
+// current file format version
+#define STD_MVEC_VERSION 1
+
+#define STD_MVEC_READ     0
+#define STD_MVEC_WRITE    1
+#define STD_MVEC_CREATE   2
+
+// on-disk header, data starts right after it
+typedef struct {
+  char magic[8];              // "STDMVEC\0"
+  u32 version;                // STD_MVEC_VERSION
+  u32 elem_size;              // sizeof(T)
+  u64 len;                    // elements in use as of the last flush
+  u64 cap;                    // elements the file has room for
+  u8 reserved[32];
+} mvec_header;
+
+// the open file behind a mvec
+typedef struct {
+  int fd;
+  int writable;
+  mvec_header* header;        // start of the mapping
+  usize map_size;
+} mvec_file;
+
+#define mvec(T)       \
+  struct {            \
+    T* data;          \
+    usize len;        \
+    usize cap;        \
+    STD_ALLOC_FIELD   \
+    mvec_file file;   \
+  }*                  \
+
+
+#define __mv_unpack(v) \
+  (void**)&(v)->data, &(v)->len, &(v)->cap, &(v)->file, sizeof(*(v)->data)
+
+
+// map the file at path, returns 0 or -1 with errno set
+#define mvec_open(v, path, flags) \
+  ((*(void**)&(v) = __mv_open((path), sizeof(*(v)->data), (flags))) == null ? -1 : 0)
+
+
+// flush, unmap and free
+#define mvec_close(v) \
+  __mv_close((v))
+
+
+// reserve size for n elements, growing the file
+#define mvec_reserve(v, n) \
+  __mv_reserve(__mv_unpack(v), n)
+
+
+// write len to the file header and msync everything to disk
+#define mvec_flush(v) \
+  __mv_flush(__mv_unpack(v))
+
+
+// (readers) pick up len and growth from the file header
+#define mvec_refresh(v) \
+  __mv_refresh(__mv_unpack(v))
+
+
+// reduce to just the first n elements
+#define mvec_truncate(v, n) \
+  vec_truncate(v, n)
+
+
+// len = 0
+#define mvec_clear(v) \
+  vec_clear(v)
+
+
+// the length of the vector
+#define mvec_len(v) \
+  vec_len(v)
+
+
+// return value at index i
+#define mvec_at(v, i) \
+  vec_at(v, i)
+
+
+// pushes a value onto vector, returns 0 or -1
+#define mvec_push(v, val)                                                   \
+  (((v)->len == (v)->cap || !(v)->file.writable)                             \
+   && __mv_reserve(__mv_unpack(v), (v)->len + 1) ? -1 :                     \
+   ((v)->data[(v)->len++] = (val), 0))
+
+
+// pops an element off and returns it
+#define mvec_pop(v) \
+  vec_pop(v)
+
+
+// push n elements from buffer b, returns 0 or -1
+#define mvec_extend_from(v, b, n)                                           \
+  (__mv_reserve(__mv_unpack(v), (v)->len + (n)) ? -1 :                      \
+   (memcpy((v)->data + (v)->len, (b), (n) * sizeof(*(v)->data)),            \
+    (v)->len += (n), 0))
+
+
+typedef mvec(void) __mv_any;
+
+
+// maps size bytes of fd, the header first
+mvec_header* __mv_map(int fd, usize size, int writable) {
+  void* p = mmap(null, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  return p == MAP_FAILED ? null : p;
+}
+
+
+void* __mv_open(const char* path, usize memsz, int flags) {
+  int writable = flags & (STD_MVEC_WRITE | STD_MVEC_CREATE);
+  int fd = open(path, (writable ? O_RDWR : O_RDONLY) | (flags & STD_MVEC_CREATE ? O_CREAT : 0), 0644);
+  if (fd < 0) return null;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) goto fail;
+  if (st.st_size == 0 && (flags & STD_MVEC_CREATE)) {
+    mvec_header h = { "STDMVEC", STD_MVEC_VERSION, (u32) memsz, 0, 0, {0} };
+    if (ftruncate(fd, sizeof(h)) != 0 || pwrite(fd, &h, sizeof(h), 0) != (ssize_t) sizeof(h)) goto fail;
+    st.st_size = sizeof(h);
+  }
+
+  mvec_header h;
+  if (st.st_size < (off_t) sizeof(h) || pread(fd, &h, sizeof(h), 0) != (ssize_t) sizeof(h)) {
+    errno = EINVAL;
+    goto fail;
+  }
+  // cap is checked before it's multiplied, so a crafted one can't wrap the size around
+  if (memcmp(h.magic, "STDMVEC", 8) != 0 || h.version != STD_MVEC_VERSION
+      || h.elem_size != memsz || h.len > h.cap
+      || h.cap > (SIZE_MAX - sizeof(h)) / memsz
+      || (u64) st.st_size < sizeof(h) + h.cap * memsz) {
+    errno = EINVAL;
+    goto fail;
+  }
+
+  usize size = sizeof(h) + h.cap * memsz;
+  mvec_header* map = __mv_map(fd, size, writable);
+  if (map == null) goto fail;
+
+  __mv_any v = std_calloc(std_allocator_get(), 1, sizeof(*v));
+  if (v == null) {
+    munmap(map, size);
+    goto fail;
+  }
+  std_alloc_init(v, std_allocator_get());
+  v->data = map + 1;
+  v->len = h.len;
+  v->cap = h.cap;
+  v->file = (mvec_file) { fd, writable, map, size };
+  return v;
+
+fail:
+  {
+    int err = errno;
+    close(fd);
+    errno = err;
+  }
+  return null;
+}
+
+
+int __mv_flush(void** data, usize* len, usize* cap, mvec_file* f, usize memsz) {
+  (void) data, (void) cap, (void) memsz;
+  if (!f->writable) return 0;
+  f->header->len = *len;
+  return msync(f->header, f->map_size, MS_SYNC);
+}
+
+
+int __mv_remap(void** data, usize* cap, mvec_file* f, usize memsz, usize n) {
+  usize size = sizeof(mvec_header) + n * memsz;
+#ifdef MREMAP_MAYMOVE
+  void* p = mremap(f->header, f->map_size, size, MREMAP_MAYMOVE);
+  if (p == MAP_FAILED) return -1;
+#else
+  void* p = __mv_map(f->fd, size, f->writable);
+  if (p == null) return -1;
+  munmap(f->header, f->map_size);
+#endif
+  f->header = p;
+  f->map_size = size;
+  *data = f->header + 1;
+  *cap = n;
+  return 0;
+}
+
+
+int __mv_reserve(void** data, usize* len, usize* cap, mvec_file* f, usize memsz, usize n) {
+  (void) len;
+  if (!f->writable) {
+    errno = EBADF;
+    return -1;
+  }
+  if (n <= *cap) return 0;
+  usize ncap = (*cap == 0) ? 1 : *cap;
+  while (ncap < n) ncap <<= 1;
+  if (ftruncate(f->fd, sizeof(mvec_header) + ncap * memsz) != 0) return -1;
+  if (__mv_remap(data, cap, f, memsz, ncap) != 0) return -1;
+  f->header->cap = ncap;
+  return 0;
+}
+
+
+int __mv_refresh(void** data, usize* len, usize* cap, mvec_file* f, usize memsz) {
+  usize ncap = f->header->cap;
+  if (ncap > *cap && __mv_remap(data, cap, f, memsz, ncap) != 0) return -1;
+  *len = f->header->len;
+  return 0;
+}
+
+
+int __mv_close(void* v) {
+  __mv_any m = v;
+  int err = __mv_flush(&m->data, &m->len, &m->cap, &m->file, 0);
+  munmap(m->file.header, m->file.map_size);
+  close(m->file.fd);
+  std_free(m->alloc, m, sizeof(*m));
+  return err;
+}
+
+
+#endif // STD_MVEC_H
@@ -0,0 +1,367 @@
+#ifndef STD_NUM_H
+#define STD_NUM_H
+
+#include "cpu.h"
+#include "types.h"
+
+#include <math.h>
+#include <string.h>
+
+/*
+
+num.h - vectorized numeric kernels for float, double and int vec/array types in C
+(anything with data and len fields works, dispatched on the element type)
+
+** Reductions **
+num_sum(v)                          -- sum of the elements (int sums to i64)
+num_sum_pairwise(v)                 -- sum with pairwise summation, error grows with log(n)
+num_sum_kahan(v)                    -- sum with compensated (Kahan) summation, error independent of n
+num_mean(v)                         -- average as a double
+num_min(v)                          -- smallest element, v must not be empty
+num_max(v)                          -- largest element, v must not be empty
+num_argmin(v)                       -- index of the first smallest element, v must not be empty
+num_argmax(v)                       -- index of the first largest element, v must not be empty
+num_dot(a, b)                       -- dot product over len(a) elements (int to i64)
+num_norm(v)                         -- L2 norm as a double
+
+** In place **
+num_axpy(y, a, x)                   -- y[i] += a * x[i] over len(y) elements
+num_scale(v, a)                     -- v[i] *= a
+
+Every kernel has an AVX2 build and a baseline (SSE2 on x86-64) build of the same
+code, picked at runtime with std_cpu_has from cpu.h. The float sums keep several
+vector accumulators, so they're already more accurate than a plain loop; use the
+pairwise or Kahan versions when that's not enough (Kahan needs -ffast-math off).
+int sums are exact, their pairwise and Kahan versions are the same as num_sum.
+min/max/argmin/argmax don't handle NaN, though argmin/argmax still return an index in v.
+
+*/
+
+// elements per leaf of num_sum_pairwise
+#define STD_NUM_PAIRWISE_BLOCK 1024
+
+
+// sum of the elements (int sums to i64)
+#define num_sum(v) \
+  __num_generic(v, sum)((v)->data, (v)->len)
+
+
+// sum with pairwise summation, error grows with log(n)
+#define num_sum_pairwise(v) \
+  __num_generic(v, sum_pairwise)((v)->data, (v)->len)
+
+
+// sum with compensated (Kahan) summation, error independent of n
+#define num_sum_kahan(v) \
+  __num_generic(v, sum_kahan)((v)->data, (v)->len)
+
+
+// average as a double
+#define num_mean(v) \
+  ((double) num_sum(v) / (double) (v)->len)
+
+
+// smallest element, v must not be empty
+#define num_min(v) \
+  __num_generic(v, min)((v)->data, (v)->len)
+
+
+// largest element, v must not be empty
+#define num_max(v) \
+  __num_generic(v, max)((v)->data, (v)->len)
+
+
+// index of the first smallest element, v must not be empty
+#define num_argmin(v) \
+  __num_generic(v, argmin)((v)->data, (v)->len)
+
+
+// index of the first largest element, v must not be empty
+#define num_argmax(v) \
+  __num_generic(v, argmax)((v)->data, (v)->len)
+
+
+// dot product over len(a) elements (int to i64)
+#define num_dot(a, b) \
+  __num_generic(a, dot)((a)->data, (b)->data, (a)->len)
+
+
+// L2 norm as a double
+#define num_norm(v) \
+  sqrt((double) num_dot(v, v))
+
+
+// y[i] += a * x[i] over len(y) elements
+#define num_axpy(y, a, x) \
+  __num_generic(y, axpy)((y)->data, (a), (x)->data, (y)->len)
+
+
+// v[i] *= a
+#define num_scale(v, a) \
+  __num_generic(v, scale)((v)->data, (a), (v)->len)
+
+
+#define __num_generic(v, name)            \
+  _Generic((v)->data,                     \
+    float*:  __num_##name##_float,        \
+    double*: __num_##name##_double,       \
+    int*:    __num_##name##_int)
+
+
+#if defined(__x86_64__) || defined(__i386__)
+#define __NUM_X86 1
+#define __NUM_AVX2(f) f##_avx2
+#define __NUM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define __NUM_X86 0
+#define __NUM_AVX2(f) f##_base
+#endif
+
+
+// the kernels' AVX2 builds also use FMA
+int __num_has_avx2() {
+  return std_cpu_has(STD_CPU_AVX2 | STD_CPU_FMA);
+}
+
+
+// the kernels work on 32-byte vectors (GCC vector extensions), built once per target;
+// loads go through memcpy so the data doesn't have to be aligned
+
+#define __NUM_LOAD(v, p) memcpy(&(v), (p), sizeof(v))
+#define __NUM_STORE(p, v) memcpy((p), &(v), sizeof(v))
+
+
+// sum, kahan sum and dot for floating point T
+#define __NUM_DEFINE_FLOAT(T, SFX, ATTR)                                        \
+  ATTR T __num_sum_##T##SFX(const T* x, usize n) {                              \
+    typedef T V __attribute__((vector_size(32)));                               \
+    enum { L = 32 / sizeof(T) };                                                \
+    V a0 = {0}, a1 = {0}, a2 = {0}, a3 = {0}, v0, v1, v2, v3;                   \
+    usize i = 0;                                                                \
+    for (; i + 4 * L <= n; i += 4 * L) {                                        \
+      __NUM_LOAD(v0, x + i);                                                    \
+      __NUM_LOAD(v1, x + i + L);                                                \
+      __NUM_LOAD(v2, x + i + 2 * L);                                            \
+      __NUM_LOAD(v3, x + i + 3 * L);                                            \
+      a0 += v0, a1 += v1, a2 += v2, a3 += v3;                                   \
+    }                                                                           \
+    for (; i + L <= n; i += L) {                                                \
+      __NUM_LOAD(v0, x + i);                                                    \
+      a0 += v0;                                                                 \
+    }                                                                           \
+    a0 = (a0 + a1) + (a2 + a3);                                                 \
+    T s = 0;                                                                    \
+    for (int k = 0; k < L; k++) s += a0[k];                                     \
+    for (; i < n; i++) s += x[i];                                               \
+    return s;                                                                   \
+  }                                                                             \
+                                                                                \
+  ATTR T __num_sum_kahan_##T##SFX(const T* x, usize n) {                        \
+    typedef T V __attribute__((vector_size(32)));                               \
+    enum { L = 32 / sizeof(T) };                                                \
+    V s = {0}, c = {0}, v, y, t;                                                \
+    usize i = 0;                                                                \
+    for (; i + L <= n; i += L) {                                                \
+      __NUM_LOAD(v, x + i);                                                     \
+      y = v - c;                                                                \
+      t = s + y;                                                                \
+      c = (t - s) - y;                                                          \
+      s = t;                                                                    \
+    }                                                                           \
+    /* each lane holds s - c, fold the lanes and the tail in the same way */    \
+    T ss = 0, cc = 0, yy, tt;                                                   \
+    for (int k = 0; k < 2 * L + (int) (n - i); k++) {                           \
+      T xk = k < L ? s[k] : k < 2 * L ? -c[k - L] : x[i + k - 2 * L];           \
+      yy = xk - cc;                                                             \
+      tt = ss + yy;                                                             \
+      cc = (tt - ss) - yy;                                                      \
+      ss = tt;                                                                  \
+    }                                                                           \
+    return ss - cc;                                                             \
+  }                                                                             \
+                                                                                \
+  ATTR T __num_dot_##T##SFX(const T* x, const T* y, usize n) {                  \
+    typedef T V __attribute__((vector_size(32)));                               \
+    enum { L = 32 / sizeof(T) };                                                \
+    V a0 = {0}, a1 = {0}, x0, x1, y0, y1;                                       \
+    usize i = 0;                                                                \
+    for (; i + 2 * L <= n; i += 2 * L) {                                        \
+      __NUM_LOAD(x0, x + i);                                                    \
+      __NUM_LOAD(x1, x + i + L);                                                \
+      __NUM_LOAD(y0, y + i);                                                    \
+      __NUM_LOAD(y1, y + i + L);                                                \
+      a0 += x0 * y0, a1 += x1 * y1;                                             \
+    }                                                                           \
+    a0 += a1;                                                                   \
+    T s = 0;                                                                    \
+    for (int k = 0; k < L; k++) s += a0[k];                                     \
+    for (; i < n; i++) s += x[i] * y[i];                                        \
+    return s;                                                                   \
+  }                                                                             \
+
+
+// sum and dot for int, widened to i64 lanes
+#define __NUM_DEFINE_INT(SFX, ATTR)                                             \
+  ATTR i64 __num_sum_int##SFX(const int* x, usize n) {                          \
+    typedef int V __attribute__((vector_size(16)));                             \
+    typedef i64 W __attribute__((vector_size(32)));                             \
+    W a0 = {0}, a1 = {0};                                                       \
+    V v0, v1;                                                                   \
+    usize i = 0;                                                                \
+    for (; i + 8 <= n; i += 8) {                                                \
+      __NUM_LOAD(v0, x + i);                                                    \
+      __NUM_LOAD(v1, x + i + 4);                                                \
+      a0 += __builtin_convertvector(v0, W);                                     \
+      a1 += __builtin_convertvector(v1, W);                                     \
+    }                                                                           \
+    a0 += a1;                                                                   \
+    i64 s = a0[0] + a0[1] + a0[2] + a0[3];                                      \
+    for (; i < n; i++) s += x[i];                                               \
+    return s;                                                                   \
+  }                                                                             \
+                                                                                \
+  ATTR i64 __num_dot_int##SFX(const int* x, const int* y, usize n) {            \
+    typedef int V __attribute__((vector_size(16)));                             \
+    typedef i64 W __attribute__((vector_size(32)));                             \
+    W a0 = {0};                                                                 \
+    V x0, y0;                                                                   \
+    usize i = 0;                                                                \
+    for (; i + 4 <= n; i += 4) {                                                \
+      __NUM_LOAD(x0, x + i);                                                    \
+      __NUM_LOAD(y0, y + i);                                                    \
+      a0 += __builtin_convertvector(x0, W) * __builtin_convertvector(y0, W);    \
+    }                                                                           \
+    i64 s = a0[0] + a0[1] + a0[2] + a0[3];                                      \
+    for (; i < n; i++) s += (i64) x[i] * y[i];                                  \
+    return s;                                                                   \
+  }                                                                             \
+
+
+// min, max, axpy and scale for any T; M is the same-width integer type for masks
+#define __NUM_DEFINE_COMMON(T, M, SFX, ATTR)                                    \
+  __NUM_DEFINE_MINMAX(T, M, SFX, ATTR, min, <)                                  \
+  __NUM_DEFINE_MINMAX(T, M, SFX, ATTR, max, >)                                  \
+                                                                                \
+  ATTR void __num_axpy_##T##SFX(T* y, T a, const T* x, usize n) {               \
+    typedef T V __attribute__((vector_size(32)));                               \
+    enum { L = 32 / sizeof(T) };                                                \
+    V vx, vy;                                                                   \
+    usize i = 0;                                                                \
+    for (; i + L <= n; i += L) {                                                \
+      __NUM_LOAD(vx, x + i);                                                    \
+      __NUM_LOAD(vy, y + i);                                                    \
+      vy += a * vx;                                                             \
+      __NUM_STORE(y + i, vy);                                                   \
+    }                                                                           \
+    for (; i < n; i++) y[i] += a * x[i];                                        \
+  }                                                                             \
+                                                                                \
+  ATTR void __num_scale_##T##SFX(T* x, T a, usize n) {                          \
+    typedef T V __attribute__((vector_size(32)));                               \
+    enum { L = 32 / sizeof(T) };                                                \
+    V v;                                                                        \
+    usize i = 0;                                                                \
+    for (; i + L <= n; i += L) {                                                \
+      __NUM_LOAD(v, x + i);                                                     \
+      v *= a;                                                                   \
+      __NUM_STORE(x + i, v);                                                    \
+    }                                                                           \
+    for (; i < n; i++) x[i] *= a;                                               \
+  }                                                                             \
+
+
+#define __NUM_DEFINE_MINMAX(T, M, SFX, ATTR, name, OP)                          \
+  ATTR T __num_##name##_##T##SFX(const T* x, usize n) {                         \
+    typedef T V __attribute__((vector_size(32)));                               \
+    typedef M K __attribute__((vector_size(32)));                               \
+    enum { L = 32 / sizeof(T) };                                                \
+    usize i = 0, nv = n - n % (2 * L);                                          \
+    T m = x[0];                                                                 \
+    if (nv > 0) {                                                               \
+      V a0, a1, v0, v1;                                                         \
+      K t0, t1;                                                                 \
+      __NUM_LOAD(a0, x);                                                        \
+      __NUM_LOAD(a1, x + L);                                                    \
+      for (i = 2 * L; i < nv; i += 2 * L) {                                     \
+        __NUM_LOAD(v0, x + i);                                                  \
+        __NUM_LOAD(v1, x + i + L);                                              \
+        t0 = v0 OP a0, t1 = v1 OP a1;                                           \
+        a0 = (V) (((K) v0 & t0) | ((K) a0 & ~t0));                              \
+        a1 = (V) (((K) v1 & t1) | ((K) a1 & ~t1));                              \
+      }                                                                         \
+      t0 = a1 OP a0;                                                            \
+      a0 = (V) (((K) a1 & t0) | ((K) a0 & ~t0));                                \
+      m = a0[0];                                                                \
+      for (int k = 1; k < L; k++) if (a0[k] OP m) m = a0[k];                    \
+    }                                                                           \
+    for (; i < n; i++) if (x[i] OP m) m = x[i];                                 \
+    return m;                                                                   \
+  }                                                                             \
+
+
+#define __NUM_DEFINE_ALL(SFX, ATTR)                                             \
+  __NUM_DEFINE_FLOAT(float, SFX, ATTR)                                          \
+  __NUM_DEFINE_FLOAT(double, SFX, ATTR)                                         \
+  __NUM_DEFINE_INT(SFX, ATTR)                                                   \
+  __NUM_DEFINE_COMMON(float, i32, SFX, ATTR)                                    \
+  __NUM_DEFINE_COMMON(double, i64, SFX, ATTR)                                   \
+  __NUM_DEFINE_COMMON(int, i32, SFX, ATTR)                                      \
+
+
+__NUM_DEFINE_ALL(_base, )
+#if __NUM_X86
+__NUM_DEFINE_ALL(_avx2, __NUM_TARGET_AVX2)
+#endif
+
+
+// picks the AVX2 or baseline build of a kernel
+#define __NUM_DISPATCH(R, name, params, args)                                   \
+  R __num_##name params {                                                       \
+    return __num_has_avx2() ? __NUM_AVX2(__num_##name) args : __num_##name##_base args; \
+  }                                                                             \
+
+
+#define __NUM_DISPATCH_ALL(T, S)                                                          \
+  __NUM_DISPATCH(S, sum_##T, (const T* x, usize n), (x, n))                               \
+  __NUM_DISPATCH(S, dot_##T, (const T* x, const T* y, usize n), (x, y, n))                \
+  __NUM_DISPATCH(T, min_##T, (const T* x, usize n), (x, n))                               \
+  __NUM_DISPATCH(T, max_##T, (const T* x, usize n), (x, n))                               \
+  __NUM_DISPATCH(void, axpy_##T, (T* y, T a, const T* x, usize n), (y, a, x, n))          \
+  __NUM_DISPATCH(void, scale_##T, (T* x, T a, usize n), (x, a, n))                        \
+                                                                                          \
+  S __num_sum_pairwise_##T(const T* x, usize n) {                                         \
+    if (n <= STD_NUM_PAIRWISE_BLOCK) return __num_sum_##T(x, n);                          \
+    usize half = (n / 2 + STD_NUM_PAIRWISE_BLOCK - 1) / STD_NUM_PAIRWISE_BLOCK * STD_NUM_PAIRWISE_BLOCK; \
+    return __num_sum_pairwise_##T(x, half) + __num_sum_pairwise_##T(x + half, n - half);  \
+  }                                                                                       \
+                                                                                          \
+  /* the first index holding the min/max, one pass to find it and one to locate it,     \
+     stopping at the last element when a NaN means it's never found */                   \
+  usize __num_argmin_##T(const T* x, usize n) {                                           \
+    T m = __num_min_##T(x, n);                                                            \
+    usize i = 0;                                                                          \
+    while (i + 1 < n && x[i] != m) i++;                                                   \
+    return i;                                                                             \
+  }                                                                                       \
+                                                                                          \
+  usize __num_argmax_##T(const T* x, usize n) {                                           \
+    T m = __num_max_##T(x, n);                                                            \
+    usize i = 0;                                                                          \
+    while (i + 1 < n && x[i] != m) i++;                                                   \
+    return i;                                                                             \
+  }                                                                                       \
+
+
+__NUM_DISPATCH_ALL(float, float)
+__NUM_DISPATCH_ALL(double, double)
+__NUM_DISPATCH_ALL(int, i64)
+
+__NUM_DISPATCH(float, sum_kahan_float, (const float* x, usize n), (x, n))
+__NUM_DISPATCH(double, sum_kahan_double, (const double* x, usize n), (x, n))
+
+i64 __num_sum_kahan_int(const int* x, usize n) {
+  return __num_sum_int(x, n);
+}
+
+
+#endif // STD_NUM_H
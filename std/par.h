@@ -0,0 +1,336 @@
+#ifndef STD_PAR_H
+#define STD_PAR_H
+
+// threads per parallel call including the caller, 0 for one per online cpu
+#ifndef STD_PAR_THREADS
+#define STD_PAR_THREADS 0
+#endif
+
+// sizes thread_default(), which is the pool parallel calls run on
+#if STD_PAR_THREADS > 0 && !defined(STD_THREAD_THREADS)
+#define STD_THREAD_THREADS STD_PAR_THREADS
+#endif
+
+#include "alloc.h"
+#include "thread.h"
+#include "types.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+
+par.h - parallel algorithms over vec and array in C
+(anything with data and len fields works)
+
+** Parallel algorithms **
+par_for_each(v, fn)                 -- calls fn(&elem) for every element
+par_transform(dst, src, fn)         -- calls fn(&dst[i], &src[i]) for every element of src
+par_reduce(v, acc, id, fn)          -- folds every element into acc with fn(&acc, &elem), returns 0 or -1
+par_inclusive_scan(dst, src, id, fn) -- dst[i] = src[0] + ... + src[i], with fn(&acc, &elem) as +, returns 0 or -1
+par_exclusive_scan(dst, src, id, fn) -- dst[i] = id + src[0] + ... + src[i-1], returns 0 or -1
+par_for(n, fn, ctx)                 -- calls fn(ctx, begin, end) over chunks of [0, n)
+par_first_touch(v)                  -- writes every page of v from the thread that par calls will use it on
+
+** Typed functions **
+par_fn1(name, T, fn)                -- defines void name(void* x) calling fn((T*) x)
+par_fn2(name, D, S, fn)             -- defines void name(void* a, const void* b) calling fn((D*) a, (const S*) b)
+
+** Worker pool **
+par_threads()                       -- threads used by a parallel call, including the caller
+
+fn gets void pointers to elements, like a qsort comparator, so it works for any element
+type. par_fn1/par_fn2 define that function at file scope around one taking typed
+pointers: par_fn2(add_long, long, long, add) makes add_long, which can be passed to
+par_reduce over a vec(long). dst must have room for len(src) elements and may be src
+itself. par_reduce and the scans need fn to be associative and id to be its identity
+(0 for +, 1 for *); par_reduce folds the chunks from id and folds their total into acc
+once, so acc can start from anything. Chunks are combined in order, so fn doesn't have
+to be commutative. Their per-chunk accumulators come from the calling thread's default
+allocator; if that runs out they return -1 and leave acc and dst as they were.
+
+Work is cut into chunks of about STD_PAR_GRAIN bytes, which the caller and the workers
+of thread_default() (one per extra core, started on first use) pull from a counter with
+thread_parallel_for. Ranges under STD_PAR_THRESHOLD bytes run sequentially on the
+calling thread, and so does everything if the pool couldn't be started (thread_default()
+returned null). Parallel calls can nest and run concurrently from several threads: the
+pool is work-stealing and a waiting caller runs tasks instead of blocking. Define
+STD_PAR_THREADS to fix the thread count.
+
+par_first_touch faults in a new vec or array (array_init_aligned maps big ones without
+touching them) from the pool's threads at once instead of one page at a time on the first
+thread to write it. It, par_for_each and par_transform split the work with
+thread_parallel_for_static, so chunk c always runs on thread c % par_threads(): the
+kernel puts each page on the NUMA node of the thread that first wrote it, and later
+for_each and transform calls over the same data work on their own node's pages. Pin
+the pool's workers (thread_pool_pin on thread_default()) to keep them there. The
+reduce, scan and par_for calls still pull chunks from a counter to balance the load.
+
+*/
+
+// bytes of elements per chunk
+#define STD_PAR_GRAIN (32 * 1024)
+
+// ranges smaller than this many bytes run sequentially
+#define STD_PAR_THRESHOLD (256 * 1024)
+
+
+// calls fn(&elem) for every element
+#define par_for_each(v, fn) \
+  __par_for_each((v)->data, (v)->len, sizeof(*(v)->data), (fn))
+
+
+// calls fn(&dst[i], &src[i]) for every element of src
+#define par_transform(dst, src, fn)                                               \
+  __par_transform((dst)->data, sizeof(*(dst)->data), (src)->data, (src)->len,     \
+                  sizeof(*(src)->data), (fn))
+
+
+// folds every element into acc with fn(&acc, &elem), returns 0 or -1
+#define par_reduce(v, acc, id, fn)                                                \
+  ((void) sizeof((acc) = *(v)->data),                                             \
+   __par_reduce((v)->data, (v)->len, sizeof(*(v)->data), &(acc), __par_id(v, id), (fn)))
+
+
+// dst[i] = src[0] + ... + src[i], with fn(&acc, &elem) as +, returns 0 or -1
+#define par_inclusive_scan(dst, src, id, fn) \
+  __par_scan_typed(dst, src, id, fn, 1)
+
+
+// dst[i] = id + src[0] + ... + src[i-1], returns 0 or -1
+#define par_exclusive_scan(dst, src, id, fn) \
+  __par_scan_typed(dst, src, id, fn, 0)
+
+
+#define __par_scan_typed(dst, src, id, fn, inclusive)                             \
+  ((void) sizeof((dst)->data = (src)->data),                                      \
+   __par_scan((dst)->data, (src)->data, (src)->len, sizeof(*(src)->data),         \
+              __par_id(src, id), (fn), (inclusive)))
+
+
+// id as an element of v, in a temporary that lasts the whole call
+#define __par_id(v, id) \
+  ((__typeof__(*(v)->data)[1]) { (id) })
+
+
+// defines void name(void* x) calling fn((T*) x)
+#define par_fn1(name, T, fn)                                                      \
+  void name(void* __x) {                                                          \
+    fn((T*) __x);                                                                 \
+  }
+
+
+// defines void name(void* a, const void* b) calling fn((D*) a, (const S*) b)
+#define par_fn2(name, D, S, fn)                                                   \
+  void name(void* __a, const void* __b) {                                         \
+    fn((D*) __a, (const S*) __b);                                                 \
+  }
+
+
+// calls fn(ctx, begin, end) over chunks of [0, n)
+#define par_for(n, fn, ctx) \
+  __par_run((n), STD_PAR_GRAIN, (fn), (ctx), false)
+
+
+// writes every page of v from the thread that par calls will use it on
+#define par_first_touch(v) \
+  __par_first_touch((v)->data, (v)->len, sizeof(*(v)->data))
+
+
+typedef void (*__par_body)(void* ctx, usize begin, usize end);
+
+
+// threads used by a parallel call, including the caller
+usize par_threads() {
+    thread_pool p = thread_default();
+    return p == null ? 1 : thread_pool_size(p) + 1;
+}
+
+
+// runs body over [0, n) in chunks of grain elements, on the pool if it's worth it,
+// placed puts chunk c on thread c % par_threads() instead of balancing them
+void __par_run(usize n, usize grain, __par_body body, void* ctx, bool placed) {
+    if (n == 0) return;
+    if (grain == 0) grain = 1;
+    thread_pool p = thread_default();
+    if (n <= grain || p == null || thread_pool_size(p) == 0) {
+        for (usize begin = 0; begin < n; begin += grain) {
+            body(ctx, begin, begin + grain < n ? begin + grain : n);
+        }
+        return;
+    }
+    if (placed) {
+        thread_parallel_for_static(p, n, grain, body, ctx);
+    } else {
+        thread_parallel_for(p, n, grain, body, ctx);
+    }
+}
+
+
+// elements per chunk for memsz-byte elements, or everything in one chunk if it's small
+usize __par_grain(usize n, usize memsz) {
+    if (n * memsz < STD_PAR_THRESHOLD) return n;
+    usize grain = STD_PAR_GRAIN / memsz;
+    return grain == 0 ? 1 : grain;
+}
+
+
+typedef struct {
+    char* data;
+    const char* src;
+    usize memsz;
+    usize src_memsz;
+    char* partials;             // one accumulator per chunk
+    char* spare;                // one element per chunk to hold an input while it's overwritten
+    const void* id;
+    usize grain;
+    int inclusive;
+    void (*fn1)(void*);
+    void (*fn2)(void*, const void*);
+} __par_args;
+
+
+void __par_for_each_body(void* ctx, usize begin, usize end) {
+    __par_args* a = ctx;
+    for (usize i = begin; i < end; i++) {
+        a->fn1(a->data + i * a->memsz);
+    }
+}
+
+
+void __par_for_each(void* data, usize n, usize memsz, void (*fn)(void*)) {
+    __par_args a = { .data = data, .memsz = memsz, .fn1 = fn };
+    __par_run(n, __par_grain(n, memsz), __par_for_each_body, &a, true);
+}
+
+
+void __par_transform_body(void* ctx, usize begin, usize end) {
+    __par_args* a = ctx;
+    for (usize i = begin; i < end; i++) {
+        a->fn2(a->data + i * a->memsz, a->src + i * a->src_memsz);
+    }
+}
+
+
+void __par_transform(void* dst, usize memsz, const void* src, usize n, usize src_memsz,
+                     void (*fn)(void*, const void*)) {
+    __par_args a = { .data = dst, .src = src, .memsz = memsz, .src_memsz = src_memsz, .fn2 = fn };
+    usize big = memsz > src_memsz ? memsz : src_memsz;
+    __par_run(n, __par_grain(n, big), __par_transform_body, &a, true);
+}
+
+
+// folds each element of a chunk into that chunk's partial
+void __par_fold_body(void* ctx, usize begin, usize end) {
+    __par_args* a = ctx;
+    char* acc = a->partials + (begin / a->grain) * a->memsz;
+    memcpy(acc, a->id, a->memsz);
+    for (usize i = begin; i < end; i++) {
+        a->fn2(acc, a->src + i * a->memsz);
+    }
+}
+
+
+// folds the chunks from id, then their total into acc
+int __par_reduce(const void* data, usize n, usize memsz, void* acc, const void* id,
+                 void (*fn)(void*, const void*)) {
+    usize grain = __par_grain(n, memsz);
+    if (n == 0) return 0;
+    usize nchunks = (n + grain - 1) / grain;
+    // the chunks' partials, then the total
+    usize size = (nchunks + 1) * memsz;
+    char* partials = std_malloc(std_allocator_get(), size);
+    if (partials == null) return -1;
+    char* total = partials + nchunks * memsz;
+    memcpy(total, id, memsz);
+    __par_args a = { .src = data, .memsz = memsz, .partials = partials, .id = id, .grain = grain, .fn2 = fn };
+    __par_run(n, grain, __par_fold_body, &a, false);
+    for (usize c = 0; c < nchunks; c++) {
+        fn(total, partials + c * memsz);
+    }
+    fn(acc, total);
+    std_free(std_allocator_get(), partials, size);
+    return 0;
+}
+
+
+// scans a chunk starting from the total of the chunks before it
+void __par_scan_body(void* ctx, usize begin, usize end) {
+    __par_args* a = ctx;
+    char* acc = a->partials + (begin / a->grain) * a->memsz;
+    for (usize i = begin; i < end; i++) {
+        char* out = a->data + i * a->memsz;
+        const char* in = a->src + i * a->memsz;
+        if (a->inclusive) {
+            a->fn2(acc, in);
+            memcpy(out, acc, a->memsz);
+        } else if (out == in) {
+            // in place, the input has to be folded in after it's been overwritten
+            char* tmp = a->spare + (begin / a->grain) * a->memsz;
+            memcpy(tmp, in, a->memsz);
+            memcpy(out, acc, a->memsz);
+            a->fn2(acc, tmp);
+        } else {
+            memcpy(out, acc, a->memsz);
+            a->fn2(acc, in);
+        }
+    }
+}
+
+
+int __par_scan(void* dst, const void* src, usize n, usize memsz, const void* id,
+               void (*fn)(void*, const void*), int inclusive) {
+    usize grain = __par_grain(n, memsz);
+    if (n == 0) return 0;
+    usize nchunks = (n + grain - 1) / grain;
+    // the chunks' partials, a spare element per chunk, then the running total
+    usize size = (2 * nchunks + 1) * memsz;
+    char* partials = std_malloc(std_allocator_get(), size);
+    if (partials == null) return -1;
+    char* acc = partials + 2 * nchunks * memsz;
+    __par_args a = { .data = dst, .src = src, .memsz = memsz, .partials = partials,
+                     .spare = partials + nchunks * memsz, .id = id, .grain = grain,
+                     .inclusive = inclusive, .fn2 = fn };
+    // chunk totals, then each chunk's starting value, then the chunks themselves
+    if (nchunks > 1) {
+        __par_run(n, grain, __par_fold_body, &a, false);
+        memcpy(acc, id, memsz);
+        for (usize c = 0; c < nchunks; c++) {
+            char* p = partials + c * memsz;
+            char* tmp = a.spare + c * memsz;
+            memcpy(tmp, p, memsz);
+            memcpy(p, acc, memsz);
+            fn(acc, tmp);
+        }
+    } else {
+        memcpy(partials, id, memsz);
+    }
+    __par_run(n, grain, __par_scan_body, &a, false);
+    std_free(std_allocator_get(), partials, size);
+    return 0;
+}
+
+
+// writes a byte of every page in a chunk, rewriting what's there
+void __par_touch_body(void* ctx, usize begin, usize end) {
+    __par_args* a = ctx;
+    volatile char* p = a->data;
+    usize page = sysconf(_SC_PAGESIZE);
+    begin *= a->memsz;
+    end *= a->memsz;
+    p[begin] = p[begin];
+    for (usize i = (begin / page + 1) * page; i < end; i += page) {
+        p[i] = p[i];
+    }
+}
+
+
+// same chunks as par_for_each over the same elements, so the same thread gets each
+void __par_first_touch(void* data, usize n, usize memsz) {
+    __par_args a = { .data = data, .memsz = memsz };
+    __par_run(n, __par_grain(n, memsz), __par_touch_body, &a, true);
+}
+
+
+#endif // STD_PAR_H
@@ -0,0 +1,193 @@
+#ifndef STD_POOL_H
+#define STD_POOL_H
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "types.h"
+
+// pool.h - fixed-size object pool (slab allocator)
+// (objects are carved out of large slabs and recycled through an intrusive free list)
+
+// Types
+
+// pool type
+typedef struct __pool {
+    void* free_list;        // freed objects, the first word of each is the next one
+    char* bump;             // next never-used object in the newest slab
+    char* bump_end;         // end of the newest slab
+    void* slabs;            // all slabs, the first word of each is the next one
+    usize obj_size;         // object size rounded up to pointer alignment
+    usize slab_size;        // bytes per slab
+    usize live;             // objects currently handed out
+    pthread_mutex_t lock;   // protects the pool when it's shared through pool_caches
+    STD_ALLOC_FIELD
+}* pool;
+
+// per-thread cache in front of a shared pool
+typedef struct {
+    pool p;
+    void* list;
+    usize count;
+} pool_cache;
+
+// bytes per slab
+#define STD_POOL_SLAB_SIZE (64 * 1024)
+
+// objects moved between a pool_cache and its pool at a time
+#define STD_POOL_CACHE_BATCH 64
+
+// Methods
+
+pool        pool_new(usize obj_size);                   // new pool of obj_size-byte objects
+void        pool_free(pool p);                          // free the pool and every object in it
+void*       pool_alloc(pool p);                         // take an object, uninitialized
+void        pool_release(pool p, void* obj);            // give an object back
+usize       pool_live(pool p);                          // objects currently handed out
+
+pool_cache  pool_cache_new(pool p);                     // cache in front of a shared pool
+void*       pool_cache_alloc(pool_cache* c);            // take an object through the cache
+void        pool_cache_release(pool_cache* c, void* obj); // give an object back through the cache
+void        pool_cache_flush(pool_cache* c);            // return all cached objects to the pool
+
+/*
+
+pool_alloc and pool_release don't lock, a pool used from one thread needs nothing else.
+
+To share a pool between threads give each thread its own pool_cache (e.g. a
+_Thread_local one) and only go through the cache: objects move between a cache
+and the pool STD_POOL_CACHE_BATCH at a time under the pool's lock, so most
+allocations never touch it. Flush a cache before its thread exits.
+
+Define STD_USE_POOL before including any std header to back map entries (one pool
+per map) and str headers (one shared pool, with a pool_cache per thread that's flushed
+when the thread exits) with pools.
+
+*/
+
+
+// DEFINITIONS
+
+
+pool __pool_new(STD_ALLOC_PARAM usize obj_size) {
+    pool p = (pool) std_calloc(alloc, 1, sizeof(struct __pool));
+    std_alloc_init(p, alloc);
+    usize align = sizeof(void*);
+    p->obj_size = (obj_size < align ? align : obj_size + align - 1) & ~(align - 1);
+    p->slab_size = STD_POOL_SLAB_SIZE;
+    if (p->slab_size < alignof(max_align_t) + 16 * p->obj_size) {
+        p->slab_size = alignof(max_align_t) + 16 * p->obj_size;
+    }
+    pthread_mutex_init(&p->lock, null);
+    return p;
+}
+
+// new pool of obj_size-byte objects
+pool pool_new(usize obj_size) {
+    return __pool_new(STD_ALLOC_DEFAULT obj_size);
+}
+
+// free the pool and every object in it
+void pool_free(pool p) {
+    void* slab = p->slabs;
+    while (slab != null) {
+        void* next = *(void**) slab;
+        std_free(p->alloc, slab, p->slab_size);
+        slab = next;
+    }
+    pthread_mutex_destroy(&p->lock);
+    std_free(p->alloc, p, sizeof(struct __pool));
+}
+
+// take an object, uninitialized
+void* pool_alloc(pool p) {
+    void* obj = p->free_list;
+    if (obj != null) {
+        p->free_list = *(void**) obj;
+    } else {
+        if (p->bump + p->obj_size > p->bump_end) {
+            char* slab = (char*) std_malloc(p->alloc, p->slab_size);
+            if (slab == null) return null;
+            *(void**) slab = p->slabs;
+            p->slabs = slab;
+            p->bump = slab + alignof(max_align_t);
+            p->bump_end = slab + p->slab_size;
+        }
+        obj = p->bump;
+        p->bump += p->obj_size;
+    }
+    p->live++;
+    return obj;
+}
+
+// give an object back
+void pool_release(pool p, void* obj) {
+    *(void**) obj = p->free_list;
+    p->free_list = obj;
+    p->live--;
+}
+
+// objects currently handed out
+usize pool_live(pool p) {
+    return p->live;
+}
+
+// cache in front of a shared pool
+pool_cache pool_cache_new(pool p) {
+    pool_cache c = { p, null, 0 };
+    return c;
+}
+
+// take an object through the cache
+void* pool_cache_alloc(pool_cache* c) {
+    if (c->list == null) {
+        pthread_mutex_lock(&c->p->lock);
+        for (usize i = 0; i < STD_POOL_CACHE_BATCH; i++) {
+            void* obj = pool_alloc(c->p);
+            if (obj == null) break;
+            *(void**) obj = c->list;
+            c->list = obj;
+            c->count++;
+        }
+        pthread_mutex_unlock(&c->p->lock);
+        if (c->list == null) return null;
+    }
+    void* obj = c->list;
+    c->list = *(void**) obj;
+    c->count--;
+    return obj;
+}
+
+// moves n objects from the cache back to the pool
+void __pool_cache_drain(pool_cache* c, usize n) {
+    pthread_mutex_lock(&c->p->lock);
+    while (n-- > 0 && c->list != null) {
+        void* obj = c->list;
+        c->list = *(void**) obj;
+        c->count--;
+        pool_release(c->p, obj);
+    }
+    pthread_mutex_unlock(&c->p->lock);
+}
+
+// give an object back through the cache
+void pool_cache_release(pool_cache* c, void* obj) {
+    *(void**) obj = c->list;
+    c->list = obj;
+    c->count++;
+    if (c->count >= 2 * STD_POOL_CACHE_BATCH) {
+        __pool_cache_drain(c, STD_POOL_CACHE_BATCH);
+    }
+}
+
+// return all cached objects to the pool
+void pool_cache_flush(pool_cache* c) {
+    __pool_cache_drain(c, c->count);
+}
+
+
+#endif // STD_POOL_H
@@ -0,0 +1,475 @@
+#ifndef STD_QUEUE_H
+#define STD_QUEUE_H
+
+#include "alloc.h"
+#include "deque.h"
+#include "types.h"
+#include "vec.h"
+
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+
+queue.h - bounded lock-free queues between threads in C
+
+spsc(T) - single-producer/single-consumer queue of T. One thread pushes, one thread
+pops; neither ever blocks or takes a lock.
+
+** Memory management **
+spsc_init(q, n)                     -- initialize queue with room for n elements (rounded up to a power of two)
+spsc_free(q)                        -- free all memory, no thread may be using q
+
+** Properties **
+spsc_cap(q)                         -- the number of elements q can hold
+spsc_len(q)                         -- the number of elements, only a snapshot while the other side runs
+
+** Producer **
+spsc_push(q, val)                   -- push a value, returns 0 or -1 if the queue is full
+spsc_push_n(q, b, n)                -- push up to n elements from buffer b, returns count
+
+** Consumer **
+spsc_pop(q, t)                      -- pop the oldest element into t, returns 0 or -1 if the queue is empty
+spsc_pop_n(q, b, n)                 -- pop up to n elements into buffer b, returns count
+
+The producer only writes tail and the consumer only writes head; each sits on its own
+cache line along with the owner's cached copy of the other index, so the two threads
+only share a line when the cached copy runs out (the queue looks full or empty) and
+on the release store that publishes their progress. The batch versions move up to n
+elements with two memcpys and a single release store, paying that cost once per
+batch instead of once per element.
+
+Nothing waits: on -1 or a short count the caller decides whether to spin, yield or
+do something else.
+
+mpmc(T) - multi-producer/multi-consumer queue of T. Any number of threads push and pop.
+
+** Memory management **
+mpmc_init(q, n)                     -- initialize queue with room for n elements (rounded up to a power of two)
+mpmc_free(q)                        -- free all memory, no thread may be using q
+
+** Properties **
+mpmc_cap(q)                         -- the number of elements q can hold
+mpmc_len(q)                         -- the number of elements, only a snapshot while others run
+
+** Operations **
+mpmc_try_push(q, val)               -- push a value, returns 0 or -1 if the queue is full
+mpmc_try_pop(q, t)                  -- pop the oldest element into t, returns 0 or -1 if the queue is empty
+mpmc_push(q, val)                   -- push a value, sleeping while the queue is full
+mpmc_pop(q, t)                      -- pop the oldest element into t, sleeping while the queue is empty
+
+Every slot carries a sequence number saying whose turn it is (Vyukov's bounded queue):
+a producer claims the slot at tail with one compare-and-swap when its sequence says
+it's free, writes the value, then bumps the sequence to hand it to consumers, who do
+the same from head. There's no lock, producers only contend with producers on tail
+and consumers with consumers on head, each on its own cache line.
+
+The blocking versions retry STD_QUEUE_SPIN times, pausing then yielding, and then sleep
+on a futex (sched_yield outside Linux) after registering as a waiter. The other side
+only makes the wake syscall when someone is waiting, so they cost the same as the try
+versions while the queue is neither full nor empty.
+
+val is evaluated into a temporary before a slot is claimed and t has to be a variable of
+the element type: the element is copied in and out of the slot between the claim and
+the hand over, with nothing of the caller's running while the slot is held.
+
+*/
+
+// cache line size assumed for padding
+#define STD_QUEUE_LINE 64
+
+// failed tries (half pausing, half yielding) before a blocking mpmc call sleeps
+#define STD_QUEUE_SPIN 64
+
+// indices of a spsc queue, each side on its own cache line
+typedef struct {
+  alignas(STD_QUEUE_LINE) atomic_size_t head;   // next slot to pop, written by the consumer
+  usize tail_cache;                             // consumer's last look at tail
+  alignas(STD_QUEUE_LINE) atomic_size_t tail;   // next slot to push, written by the producer
+  usize head_cache;                             // producer's last look at head
+  alignas(STD_QUEUE_LINE) usize cap;            // power of two
+  void* mem;                                    // the allocation q lives in
+  STD_ALLOC_FIELD
+} __spsc_state;
+
+#define spsc(T)           \
+  struct {                \
+    __spsc_state s;       \
+    T* data;              \
+  }*                      \
+
+
+// initialize queue with room for n elements (rounded up to a power of two)
+#define spsc_init(q, n) \
+  (*(void**)&(q) = __spsc_new(STD_ALLOC_DEFAULT (n), sizeof(*(q)->data), sizeof(*(q))))
+
+
+// free all memory, no thread may be using q
+#define spsc_free(q) \
+  __spsc_free(&(q)->s, sizeof(*(q)->data), sizeof(*(q)))
+
+
+// the number of elements q can hold
+#define spsc_cap(q) \
+  ((q)->s.cap)
+
+
+// the number of elements, only a snapshot while the other side runs
+#define spsc_len(q)                                                         \
+  (atomic_load_explicit(&(q)->s.tail, memory_order_acquire)                 \
+   - atomic_load_explicit(&(q)->s.head, memory_order_acquire))
+
+
+// push a value, returns 0 or -1 if the queue is full
+#define spsc_push(q, val)                                                   \
+  (__spsc_room(&(q)->s, 1) == 0 ? -1 :                                      \
+   ((q)->data[__spsc_tail(&(q)->s) & ((q)->s.cap - 1)] = (val),             \
+    __spsc_publish(&(q)->s, 1), 0))
+
+
+// push up to n elements from buffer b, returns count
+#define spsc_push_n(q, b, n)                                                \
+  (__v_check_buf(q, b),                                                     \
+   __spsc_push_n(&(q)->s, (void*)(q)->data, sizeof(*(q)->data), (b), (n)))
+
+
+// pop the oldest element into t, returns 0 or -1 if the queue is empty
+#define spsc_pop(q, t)                                                      \
+  (__spsc_ready(&(q)->s, 1) == 0 ? -1 :                                     \
+   ((t) = (q)->data[__spsc_head(&(q)->s) & ((q)->s.cap - 1)],               \
+    __spsc_consume(&(q)->s, 1), 0))
+
+
+// pop up to n elements into buffer b, returns count
+#define spsc_pop_n(q, b, n)                                                 \
+  (__v_check_buf(q, b),                                                     \
+   __spsc_pop_n(&(q)->s, (void*)(q)->data, sizeof(*(q)->data), (b), (n)))
+
+
+void* __spsc_new(STD_ALLOC_PARAM usize n, usize memsz, usize size) {
+  usize cap = 1;
+  while (cap < n) cap <<= 1;
+  // header and slots in one block, the header aligned to a cache line
+  usize bytes = STD_QUEUE_LINE - 1 + size + cap * memsz;
+  void* mem = std_malloc(alloc, bytes);
+  if (mem == null) return null;
+  char* p = (char*) (((uintptr_t) mem + STD_QUEUE_LINE - 1) & ~(uintptr_t) (STD_QUEUE_LINE - 1));
+  __spsc_state* s = (__spsc_state*) p;
+  memset(s, 0, size);
+  atomic_init(&s->head, 0);
+  atomic_init(&s->tail, 0);
+  s->cap = cap;
+  s->mem = mem;
+  std_alloc_init(s, alloc);
+  // data is the member right after the state, the slots start after the whole struct
+  *(void**) (p + sizeof(__spsc_state)) = p + size;
+  return p;
+}
+
+
+void __spsc_free(__spsc_state* s, usize memsz, usize size) {
+  (void) memsz, (void) size;
+  std_free(s->alloc, s->mem, STD_QUEUE_LINE - 1 + size + s->cap * memsz);
+}
+
+
+// producer: its own tail
+usize __spsc_tail(__spsc_state* s) {
+  return atomic_load_explicit(&s->tail, memory_order_relaxed);
+}
+
+
+// producer: free slots, only reloading head when the cached one says there are fewer than want
+usize __spsc_room(__spsc_state* s, usize want) {
+  usize tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+  usize room = s->cap - (tail - s->head_cache);
+  if (room < want) {
+    s->head_cache = atomic_load_explicit(&s->head, memory_order_acquire);
+    room = s->cap - (tail - s->head_cache);
+  }
+  return room;
+}
+
+
+// producer: make n written slots visible to the consumer
+void __spsc_publish(__spsc_state* s, usize n) {
+  usize tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+  atomic_store_explicit(&s->tail, tail + n, memory_order_release);
+}
+
+
+// consumer: its own head
+usize __spsc_head(__spsc_state* s) {
+  return atomic_load_explicit(&s->head, memory_order_relaxed);
+}
+
+
+// consumer: filled slots, only reloading tail when the cached one says there are fewer than want
+usize __spsc_ready(__spsc_state* s, usize want) {
+  usize head = atomic_load_explicit(&s->head, memory_order_relaxed);
+  usize ready = s->tail_cache - head;
+  if (ready < want) {
+    s->tail_cache = atomic_load_explicit(&s->tail, memory_order_acquire);
+    ready = s->tail_cache - head;
+  }
+  return ready;
+}
+
+
+// consumer: hand n read slots back to the producer
+void __spsc_consume(__spsc_state* s, usize n) {
+  usize head = atomic_load_explicit(&s->head, memory_order_relaxed);
+  atomic_store_explicit(&s->head, head + n, memory_order_release);
+}
+
+
+usize __spsc_push_n(__spsc_state* s, void* data, usize memsz, const void* src, usize n) {
+  usize room = __spsc_room(s, n);
+  if (n > room) n = room;
+  if (n == 0) return 0;
+  __d_write(data, s->cap, __spsc_tail(s) & (s->cap - 1), memsz, 0, src, n);
+  __spsc_publish(s, n);
+  return n;
+}
+
+
+usize __spsc_pop_n(__spsc_state* s, void* data, usize memsz, void* dst, usize n) {
+  usize ready = __spsc_ready(s, n);
+  if (n > ready) n = ready;
+  if (n == 0) return 0;
+  __d_read(data, s->cap, __spsc_head(s) & (s->cap - 1), memsz, 0, dst, n);
+  __spsc_consume(s, n);
+  return n;
+}
+
+
+// indices and wait state of a mpmc queue
+typedef struct {
+  alignas(STD_QUEUE_LINE) atomic_size_t tail;   // next position to push
+  alignas(STD_QUEUE_LINE) atomic_size_t head;   // next position to pop
+  alignas(STD_QUEUE_LINE) usize cap;            // power of two
+  usize stride;                                 // size of a slot
+  void* mem;                                    // the allocation q lives in
+  STD_ALLOC_FIELD
+  alignas(STD_QUEUE_LINE) atomic_uint not_empty;  // futex words, bumped on every wake
+  atomic_uint not_full;
+  atomic_uint pop_waiters;
+  atomic_uint push_waiters;
+} __mpmc_state;
+
+#define mpmc(T)                                                             \
+  struct {                                                                  \
+    __mpmc_state s;                                                         \
+    struct { atomic_size_t seq; T item; }* slots;                           \
+  }*                                                                        \
+
+
+// initialize queue with room for n elements (rounded up to a power of two)
+#define mpmc_init(q, n) \
+  (*(void**)&(q) = __mpmc_new(STD_ALLOC_DEFAULT (n), sizeof(*(q)->slots), sizeof(*(q))))
+
+
+// free all memory, no thread may be using q
+#define mpmc_free(q) \
+  __mpmc_free(&(q)->s, sizeof(*(q)))
+
+
+// the number of elements q can hold
+#define mpmc_cap(q) \
+  ((q)->s.cap)
+
+
+// the number of elements, only a snapshot while others run
+#define mpmc_len(q)                                                         \
+  (atomic_load_explicit(&(q)->s.tail, memory_order_acquire)                 \
+   - atomic_load_explicit(&(q)->s.head, memory_order_acquire))
+
+
+// push a value, returns 0 or -1 if the queue is full
+#define mpmc_try_push(q, val) \
+  __mpmc_push(&(q)->s, (q)->slots, __mpmc_val(q, val), __mpmc_item(q), 0)
+
+
+// pop the oldest element into t, returns 0 or -1 if the queue is empty
+#define mpmc_try_pop(q, t) \
+  __mpmc_pop(&(q)->s, (q)->slots, __mpmc_out(q, t), __mpmc_item(q), 0)
+
+
+// push a value, sleeping while the queue is full
+#define mpmc_push(q, val) \
+  ((void) __mpmc_push(&(q)->s, (q)->slots, __mpmc_val(q, val), __mpmc_item(q), 1))
+
+
+// pop the oldest element into t, sleeping while the queue is empty
+#define mpmc_pop(q, t) \
+  ((void) __mpmc_pop(&(q)->s, (q)->slots, __mpmc_out(q, t), __mpmc_item(q), 1))
+
+
+// val copied into a one element array of the element type, evaluated before any slot is claimed
+#define __mpmc_val(q, val) \
+  ((__typeof__((q)->slots->item)[1]) { (val) })
+
+
+// address of t, which has to have the element type
+#define __mpmc_out(q, t) \
+  ((void) sizeof(&(t) == &(q)->slots->item), (void*) &(t))
+
+
+// size and offset of the element in a slot
+#define __mpmc_item(q) \
+  sizeof((q)->slots->item), offsetof(__typeof__(*(q)->slots), item)
+
+
+void* __mpmc_new(STD_ALLOC_PARAM usize n, usize stride, usize size) {
+  usize cap = 1;
+  while (cap < n) cap <<= 1;
+  usize bytes = STD_QUEUE_LINE - 1 + size + cap * stride;
+  void* mem = std_malloc(alloc, bytes);
+  if (mem == null) return null;
+  char* p = (char*) (((uintptr_t) mem + STD_QUEUE_LINE - 1) & ~(uintptr_t) (STD_QUEUE_LINE - 1));
+  __mpmc_state* s = (__mpmc_state*) p;
+  memset(s, 0, size);
+  atomic_init(&s->tail, 0);
+  atomic_init(&s->head, 0);
+  s->cap = cap;
+  s->stride = stride;
+  s->mem = mem;
+  std_alloc_init(s, alloc);
+  char* slots = p + size;
+  *(void**) (p + sizeof(__mpmc_state)) = slots;
+  // slot i is free for the push at position i
+  for (usize i = 0; i < cap; i++) {
+    atomic_init((atomic_size_t*) (slots + i * stride), i);
+  }
+  return p;
+}
+
+
+void __mpmc_free(__mpmc_state* s, usize size) {
+  (void) size;
+  std_free(s->alloc, s->mem, STD_QUEUE_LINE - 1 + size + s->cap * s->stride);
+}
+
+
+void __q_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+
+void __q_futex_wait(atomic_uint* word, unsigned seen) {
+#ifdef __linux__
+  syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, seen, null, null, 0);
+#else
+  (void) word, (void) seen;
+  sched_yield();
+#endif
+}
+
+
+void __q_futex_wake(atomic_uint* word, int n) {
+#ifdef __linux__
+  syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, n, null, null, 0);
+#else
+  (void) word, (void) n;
+#endif
+}
+
+
+// wakes one sleeper on word if there are any, after a slot changed hands
+void __mpmc_wake(atomic_uint* word, atomic_uint* waiters) {
+  // pairs with the fence in __mpmc_claim: either we see the waiter or it sees our slot
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(waiters, memory_order_relaxed) == 0) return;
+  atomic_fetch_add_explicit(word, 1, memory_order_relaxed);
+  __q_futex_wake(word, 1);
+}
+
+
+// one attempt at claiming the slot at *at, whose sequence has to be the position + ahead,
+// the position claimed goes to *out
+void* __mpmc_try_claim(atomic_size_t* at, char* slots, usize stride, usize mask, usize ahead, usize* out) {
+  usize pos = atomic_load_explicit(at, memory_order_relaxed);
+  for (;;) {
+    char* slot = slots + (pos & mask) * stride;
+    usize seq = atomic_load_explicit((atomic_size_t*) slot, memory_order_acquire);
+    isize dif = (isize) (seq - (pos + ahead));
+    if (dif == 0) {
+      if (atomic_compare_exchange_weak_explicit(at, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        *out = pos;
+        return slot;
+      }
+    } else if (dif < 0) {
+      // the slot is still a lap behind: full for pushes, empty for pops
+      return null;
+    } else {
+      pos = atomic_load_explicit(at, memory_order_relaxed);
+    }
+  }
+}
+
+
+// claims a slot, sleeping on word while there is none if block is set
+void* __mpmc_claim(atomic_size_t* at, char* slots, usize stride, usize mask, usize ahead,
+                   usize* out, int block, atomic_uint* word, atomic_uint* waiters) {
+  void* slot = __mpmc_try_claim(at, slots, stride, mask, ahead, out);
+  if (slot != null || !block) return slot;
+  // the other side is usually about to catch up, try for a while before sleeping
+  for (int i = 0; i < STD_QUEUE_SPIN; i++) {
+    if (i < STD_QUEUE_SPIN / 2) __q_pause();
+    else sched_yield();
+    slot = __mpmc_try_claim(at, slots, stride, mask, ahead, out);
+    if (slot != null) return slot;
+  }
+  for (;;) {
+    unsigned seen = atomic_load_explicit(word, memory_order_acquire);
+    slot = __mpmc_try_claim(at, slots, stride, mask, ahead, out);
+    if (slot != null) return slot;
+    atomic_fetch_add_explicit(waiters, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    // the other side may have handed over a slot before it could see us waiting
+    slot = __mpmc_try_claim(at, slots, stride, mask, ahead, out);
+    if (slot == null) __q_futex_wait(word, seen);
+    atomic_fetch_sub_explicit(waiters, 1, memory_order_relaxed);
+    if (slot != null) return slot;
+  }
+}
+
+
+// claims the slot at tail, copies the size bytes at val into it and hands it to consumers
+int __mpmc_push(__mpmc_state* s, void* slots, const void* val, usize size, usize offset, int block) {
+  usize pos;
+  char* slot = __mpmc_claim(&s->tail, slots, s->stride, s->cap - 1, 0, &pos, block, &s->not_full, &s->push_waiters);
+  if (slot == null) return -1;
+  memcpy(slot + offset, val, size);
+  atomic_store_explicit((atomic_size_t*) slot, pos + 1, memory_order_release);
+  __mpmc_wake(&s->not_empty, &s->pop_waiters);
+  return 0;
+}
+
+
+// claims the slot at head, copies its element to out and hands the slot back to
+// producers, for the push one lap later
+int __mpmc_pop(__mpmc_state* s, void* slots, void* out, usize size, usize offset, int block) {
+  usize pos;
+  char* slot = __mpmc_claim(&s->head, slots, s->stride, s->cap - 1, 1, &pos, block, &s->not_empty, &s->pop_waiters);
+  if (slot == null) return -1;
+  memcpy(out, slot + offset, size);
+  atomic_store_explicit((atomic_size_t*) slot, pos + s->cap, memory_order_release);
+  __mpmc_wake(&s->not_full, &s->push_waiters);
+  return 0;
+}
+
+
+#endif // STD_QUEUE_H
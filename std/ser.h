@@ -0,0 +1,498 @@
+#ifndef STD_SER_H
+#define STD_SER_H
+
+#include "alloc.h"
+#include "array.h"
+#include "cpu.h"
+#include "str.h"
+#include "types.h"
+#include "vec.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+
+ser.h - binary serialization for vec, array and array_str in C
+
+** Streams **
+ser_file(f)                         -- stream through a FILE*
+ser_fd(fd)                          -- stream through a file descriptor
+
+** Dump **
+ser_dump(io, v, flags)              -- write a vec or array of plain data T
+ser_dump_strs(io, a, flags)         -- write an array_str
+
+** Load **
+ser_load_vec(io, v)                 -- replace the contents of initialized vec v
+ser_load_array(io, a)               -- resize initialized array a and fill it
+ser_load_strs(io, a)                -- resize initialized array_str a and fill it with new strs
+
+** Map **
+ser_map(io, s, m)                   -- point span s at the elements of a dump in a regular file, in place
+ser_unmap(m)                        -- release the mapping ser_map made
+
+** Flags **
+STD_SER_CRC                         -- append a CRC-32C of the payload, checked on load
+
+Everything returns 0, or -1 with errno set: EINVAL when the input isn't a dump of the
+right element size (bad header, truncated), EBADMSG when the CRC doesn't match, ESPIPE
+when ser_map isn't given a regular file, or whatever the underlying call failed with.
+
+A dump is a 32-byte header (magic, format version, element size, length, flags), the
+payload, then the CRC if there is one. For vec/array the payload is the raw elements,
+loaded with one read straight into the container's buffer - there's no parsing or
+per-element work, just that one copy. ser_map skips the copy too: it maps the dump and
+points a span(T) (span.h, or anything with data and len) at the payload where it sits
+in the page cache. Writes through the span stay private to the process. The span lives
+until ser_unmap(m), and the payload must land aligned for T, which it does for dumps
+written at 32-byte multiples such as the start of a file. For array_str it's every length as a u64 followed by all the bytes;
+those are read in STD_SER_BLOCK sized reads and split up into strs. Nothing is read past
+the end of a dump, so several can follow each other in one stream. Dumps use the native
+byte order and T must not contain pointers.
+
+Counts and lengths in a dump aren't trusted: when the stream is a regular file they're
+checked against the bytes left in it before anything is allocated, and on pipes and
+sockets the lengths are read a block at a time, so memory only grows with what has
+actually arrived.
+
+*/
+
+// current format version
+#define STD_SER_VERSION 1
+
+// bytes per buffered read/write
+#define STD_SER_BLOCK (1 << 20)
+
+// append a CRC-32C of the payload, checked on load
+#define STD_SER_CRC 1
+
+// a FILE* or a file descriptor
+typedef struct {
+  FILE* file;
+  int fd;
+} ser_io;
+
+// pages of a file ser_map mapped, for ser_unmap
+typedef struct {
+  void* addr;
+  usize size;
+} ser_mapping;
+
+// header in front of each dump
+typedef struct {
+  char magic[8];              // "STDSER\0\0"
+  u32 version;                // STD_SER_VERSION
+  u32 elem_size;              // sizeof(T), 0 for strings
+  u64 len;                    // number of elements
+  u32 flags;                  // STD_SER_CRC
+  u32 reserved;
+} ser_header;
+
+
+// write a vec or array of plain data T
+#define ser_dump(io, v, flags) \
+  __ser_dump((io), (v)->data, (v)->len, sizeof(*(v)->data), (flags))
+
+
+// write an array_str
+#define ser_dump_strs(io, a, flags) \
+  __ser_dump_strs((io), (a)->data, (a)->len, (flags))
+
+
+// replace the contents of initialized vec v
+#define ser_load_vec(io, v) \
+  __ser_load_vec((io), __v_unpack(v))
+
+
+// resize initialized array a and fill it
+#define ser_load_array(io, a) \
+  __ser_load_array((io), __a_unpack(a))
+
+
+// resize initialized array_str a and fill it with new strs
+#define ser_load_strs(io, a) \
+  __ser_load_strs((io), __a_unpack(a))
+
+
+// point span s at the elements of a dump in a regular file, in place
+#define ser_map(io, s, m)                                                                   \
+  __ser_map((io), (void**) &(s).data, &(s).len, sizeof(*(s).data), __alignof__(*(s).data), &(m))
+
+
+// stream through a FILE*
+ser_io ser_file(FILE* f) {
+  return (ser_io) { f, -1 };
+}
+
+
+// stream through a file descriptor
+ser_io ser_fd(int fd) {
+  return (ser_io) { null, fd };
+}
+
+
+// CRC-32C, with the SSE4.2 instruction when the cpu has it
+
+u32 __ser_crc_table[256];
+pthread_once_t __ser_crc_once = PTHREAD_ONCE_INIT;
+
+void __ser_crc_init() {
+  for (u32 i = 0; i < 256; i++) {
+    u32 c = i;
+    for (int k = 0; k < 8; k++) c = c & 1 ? (c >> 1) ^ 0x82F63B78 : c >> 1;
+    __ser_crc_table[i] = c;
+  }
+}
+
+u32 __ser_crc_sw(u32 crc, const u8* p, usize n) {
+  pthread_once(&__ser_crc_once, __ser_crc_init);
+  while (n--) crc = __ser_crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+u32 __ser_crc_sse42(u32 crc, const u8* p, usize n) {
+  u64 c = crc;
+  for (; n >= 8; n -= 8, p += 8) {
+    u64 w;
+    memcpy(&w, p, 8);
+    c = __builtin_ia32_crc32di(c, w);
+  }
+  crc = (u32) c;
+  while (n--) crc = __builtin_ia32_crc32qi(crc, *p++);
+  return crc;
+}
+#endif
+
+// continues a crc over n more bytes, start with 0
+u32 __ser_crc(u32 crc, const void* p, usize n) {
+  crc = ~crc;
+#if defined(__x86_64__)
+  if (std_cpu_has(STD_CPU_SSE42)) return ~__ser_crc_sse42(crc, p, n);
+#endif
+  return ~__ser_crc_sw(crc, p, n);
+}
+
+
+// raw io, loops over short reads/writes
+
+int __ser_write(ser_io io, const void* p, usize n) {
+  if (io.file != null) {
+    return fwrite(p, 1, n, io.file) == n ? 0 : -1;
+  }
+  while (n > 0) {
+    ssize_t w = write(io.fd, p, n);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) return -1;
+    p = (const char*) p + w;
+    n -= w;
+  }
+  return 0;
+}
+
+int __ser_read(ser_io io, void* p, usize n) {
+  if (io.file != null) {
+    if (fread(p, 1, n, io.file) == n) return 0;
+    if (!ferror(io.file)) errno = EINVAL;
+    return -1;
+  }
+  while (n > 0) {
+    ssize_t r = read(io.fd, p, n);
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0) return -1;
+    if (r == 0) {
+      errno = EINVAL;
+      return -1;
+    }
+    p = (char*) p + r;
+    n -= r;
+  }
+  return 0;
+}
+
+
+// buffered writer for many small pieces, crc over everything that goes through it
+typedef struct {
+  ser_io io;
+  char* buf;
+  usize pos;
+  u32 crc;
+  int err;
+} __ser_writer;
+
+void __ser_flush(__ser_writer* w) {
+  if (w->err == 0 && w->pos > 0) w->err = __ser_write(w->io, w->buf, w->pos);
+  w->pos = 0;
+}
+
+void __ser_put(__ser_writer* w, const void* p, usize n) {
+  w->crc = __ser_crc(w->crc, p, n);
+  if (w->pos + n > STD_SER_BLOCK) __ser_flush(w);
+  if (n >= STD_SER_BLOCK) {
+    if (w->err == 0) w->err = __ser_write(w->io, p, n);
+    return;
+  }
+  memcpy(w->buf + w->pos, p, n);
+  w->pos += n;
+}
+
+
+int __ser_write_header(ser_io io, usize memsz, usize len, int flags) {
+  ser_header h = { "STDSER", STD_SER_VERSION, (u32) memsz, len, (u32) flags, 0 };
+  return __ser_write(io, &h, sizeof(h));
+}
+
+// bytes left in a regular file from the current position, or (u64) -1 when that can't be
+// known (pipes, sockets, memory streams)
+u64 __ser_remaining(ser_io io) {
+  struct stat st;
+  int fd = io.file != null ? fileno(io.file) : io.fd;
+  if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return (u64) -1;
+  off_t pos = io.file != null ? ftello(io.file) : lseek(fd, 0, SEEK_CUR);
+  if (pos < 0 || pos > st.st_size) return (u64) -1;
+  return (u64) (st.st_size - pos);
+}
+
+// is h a header for memsz-byte elements with a length whose size can't overflow?
+bool __ser_valid(const ser_header* h, usize memsz) {
+  return memcmp(h->magic, "STDSER\0", 8) == 0 && h->version == STD_SER_VERSION
+      && h->elem_size == memsz && (h->flags & ~STD_SER_CRC) == 0
+      && h->len <= ((u64) -1 >> 1) / (memsz ? memsz : sizeof(u64));
+}
+
+// reads and checks a header, returns the element count or -1
+isize __ser_read_header(ser_io io, usize memsz, u32* flags) {
+  ser_header h;
+  if (__ser_read(io, &h, sizeof(h)) != 0) return -1;
+  if (!__ser_valid(&h, memsz)) {
+    errno = EINVAL;
+    return -1;
+  }
+  // every element takes at least memsz bytes (a u64 length for strings)
+  if (h.len * (memsz ? memsz : sizeof(u64)) > __ser_remaining(io)) {
+    errno = EINVAL;
+    return -1;
+  }
+  *flags = h.flags;
+  return (isize) h.len;
+}
+
+// reads the trailing crc if there is one and checks it
+int __ser_check_crc(ser_io io, u32 flags, u32 crc) {
+  u32 stored;
+  if (!(flags & STD_SER_CRC)) return 0;
+  if (__ser_read(io, &stored, sizeof(stored)) != 0) return -1;
+  if (stored != crc) {
+    errno = EBADMSG;
+    return -1;
+  }
+  return 0;
+}
+
+
+int __ser_dump(ser_io io, const void* data, usize len, usize memsz, int flags) {
+  if (__ser_write_header(io, memsz, len, flags) != 0) return -1;
+  if (__ser_write(io, data, len * memsz) != 0) return -1;
+  if (flags & STD_SER_CRC) {
+    u32 crc = __ser_crc(0, data, len * memsz);
+    if (__ser_write(io, &crc, sizeof(crc)) != 0) return -1;
+  }
+  return 0;
+}
+
+
+int __ser_dump_strs(ser_io io, str* data, usize len, int flags) {
+  if (__ser_write_header(io, 0, len, flags) != 0) return -1;
+  __ser_writer w = { io, std_malloc(std_allocator_get(), STD_SER_BLOCK), 0, 0, 0 };
+  if (w.buf == null) return -1;
+  for (usize i = 0; i < len; i++) {
+    u64 n = data[i]->len;
+    __ser_put(&w, &n, sizeof(n));
+  }
+  for (usize i = 0; i < len; i++) {
+    __ser_put(&w, data[i]->chars, data[i]->len);
+  }
+  __ser_flush(&w);
+  std_free(std_allocator_get(), w.buf, STD_SER_BLOCK);
+  if (w.err != 0) return -1;
+  if ((flags & STD_SER_CRC) && __ser_write(io, &w.crc, sizeof(w.crc)) != 0) return -1;
+  return 0;
+}
+
+
+int __ser_load_vec(ser_io io, STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz) {
+  u32 flags;
+  isize n = __ser_read_header(io, memsz, &flags);
+  if (n < 0) return -1;
+  if (__v_reserve(STD_ALLOC_FWD data, len, cap, memsz, n) != 0) return -1;
+  *len = 0;
+  if (__ser_read(io, *data, n * memsz) != 0) return -1;
+  if (__ser_check_crc(io, flags, __ser_crc(0, *data, n * memsz)) != 0) return -1;
+  *len = n;
+  return 0;
+}
+
+
+int __ser_load_array(ser_io io, STD_ALLOC_PARAM void** data, usize* len, usize memsz, usize align) {
+  u32 flags;
+  isize n = __ser_read_header(io, memsz, &flags);
+  if (n < 0) return -1;
+  if (__a_resize(STD_ALLOC_FWD data, len, memsz, align, n) != 0) return -1;
+  if (__ser_read(io, *data, n * memsz) != 0) return -1;
+  return __ser_check_crc(io, flags, __ser_crc(0, *data, n * memsz));
+}
+
+
+// reads n lengths a block at a time into *out, growing it as they arrive to n * 8 bytes
+int __ser_read_lens(STD_ALLOC_PARAM ser_io io, usize n, u64** out) {
+  u64* lens = null;
+  usize got = 0, cap = 0;
+  while (got < n) {
+    usize want = n - got < STD_SER_BLOCK / sizeof(u64) ? n - got : STD_SER_BLOCK / sizeof(u64);
+    if (got + want > cap) {
+      usize ncap = cap * 2 > got + want ? cap * 2 : got + want;
+      if (ncap > n) ncap = n;
+      u64* p = std_realloc(alloc, lens, cap * sizeof(u64), ncap * sizeof(u64));
+      if (p == null) break;
+      lens = p;
+      cap = ncap;
+    }
+    if (__ser_read(io, lens + got, want * sizeof(u64)) != 0) break;
+    got += want;
+  }
+  if (got < n) {
+    std_free(alloc, lens, cap * sizeof(u64));
+    return -1;
+  }
+  *out = lens;
+  return 0;
+}
+
+
+int __ser_load_strs(ser_io io, STD_ALLOC_PARAM void** data, usize* len, usize memsz, usize align) {
+  u32 flags;
+  isize n = __ser_read_header(io, 0, &flags);
+  if (n < 0) return -1;
+  u64* lens = null;
+  char* buf = null;
+  str* strs = null;
+  int err = -1;
+  if (__ser_read_lens(STD_ALLOC_FWD io, n, &lens) != 0) goto done;
+  buf = std_malloc(alloc, STD_SER_BLOCK);
+  if (buf == null) goto done;
+  u32 crc = __ser_crc(0, lens, n * sizeof(u64));
+  // the bytes of all the strs have to be there too
+  u64 left = __ser_remaining(io);
+  for (isize i = 0; i < n; i++) {
+    if (lens[i] > left || lens[i] >= (u64) -1 >> 1) {
+      errno = EINVAL;
+      goto done;
+    }
+    if (left != (u64) -1) left -= lens[i];
+  }
+
+  if (__a_resize(STD_ALLOC_FWD data, len, memsz, align, n) != 0) goto done;
+  strs = *data;
+  if (n > 0) memset(strs, 0, n * sizeof(str));
+
+  // fill the strs from block sized reads, a str can straddle two blocks
+  usize have = 0, used = 0;
+  for (isize i = 0; i < n; i++) {
+    strs[i] = str_alloc(lens[i]);
+    if (strs[i] == null) goto done;
+    for (usize got = 0; got < lens[i];) {
+      if (used == have) {
+        u64 rest = 0;
+        for (isize j = i; j < n && rest < STD_SER_BLOCK; j++) rest += lens[j] - (j == i ? got : 0);
+        have = rest < STD_SER_BLOCK ? rest : STD_SER_BLOCK;
+        used = 0;
+        if (__ser_read(io, buf, have) != 0) goto done;
+        crc = __ser_crc(crc, buf, have);
+      }
+      usize k = lens[i] - got < have - used ? lens[i] - got : have - used;
+      memcpy(strs[i]->chars + got, buf + used, k);
+      got += k;
+      used += k;
+    }
+  }
+  err = __ser_check_crc(io, flags, crc);
+
+done:
+  // on failure don't hand back half-filled strs
+  if (err != 0 && strs != null) {
+    for (isize i = 0; i < n; i++) {
+      if (strs[i] != null) str_free(strs[i]);
+    }
+    *len = 0;
+  }
+  std_free(alloc, lens, n * sizeof(u64));
+  std_free(alloc, buf, STD_SER_BLOCK);
+  return err;
+}
+
+
+
+int __ser_map(ser_io io, void** data, usize* len, usize memsz, usize align, ser_mapping* m) {
+  int fd = io.file != null ? fileno(io.file) : io.fd;
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) return -1;
+  if (!S_ISREG(st.st_mode)) {
+    errno = ESPIPE;
+    return -1;
+  }
+  off_t pos = io.file != null ? ftello(io.file) : lseek(fd, 0, SEEK_CUR);
+  if (pos < 0) return -1;
+  ser_header h;
+  if (pread(fd, &h, sizeof(h), pos) != (ssize_t) sizeof(h) || !__ser_valid(&h, memsz)) {
+    errno = EINVAL;
+    return -1;
+  }
+  u64 bytes = h.len * memsz;
+  u64 end = (u64) pos + sizeof(h) + bytes + (h.flags & STD_SER_CRC ? sizeof(u32) : 0);
+  if (end > (u64) st.st_size) {
+    errno = EINVAL;
+    return -1;
+  }
+  // mmap wants a page aligned offset, so the mapping starts a little before the dump
+  off_t base = pos - pos % sysconf(_SC_PAGESIZE);
+  usize size = end - base;
+  char* p = mmap(null, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, base);
+  if (p == MAP_FAILED) return -1;
+  char* payload = p + (pos - base) + sizeof(h);
+  int err = 0;
+  if ((uintptr_t) payload % align != 0) {
+    err = EINVAL;
+  } else if (h.flags & STD_SER_CRC) {
+    u32 stored;
+    memcpy(&stored, payload + bytes, sizeof(stored));
+    if (stored != __ser_crc(0, payload, bytes)) err = EBADMSG;
+  }
+  // leave the stream after the dump like a load would
+  if (err == 0 && (io.file != null ? fseeko(io.file, end, SEEK_SET) : lseek(fd, end, SEEK_SET)) < 0) err = errno;
+  if (err != 0) {
+    munmap(p, size);
+    errno = err;
+    return -1;
+  }
+  *data = payload;
+  *len = h.len;
+  *m = (ser_mapping) { p, size };
+  return 0;
+}
+
+
+// release the mapping ser_map made
+int ser_unmap(ser_mapping m) {
+  return munmap(m.addr, m.size);
+}
+
+
+#endif // STD_SER_H
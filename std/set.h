@@ -0,0 +1,349 @@
+#ifndef STD_SET_H
+#define STD_SET_H
+
+#include "alloc.h"
+#include "cpu.h"
+#include "heap.h"
+#include "types.h"
+#include "vec.h"
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/*
+
+set.h - sorted set operations on u32 and u64 vecs in C
+(a set is a sorted vec with no duplicates, dispatched on the element type)
+
+** Operations **
+set_intersect(out, a, b)            -- out = elements in both a and b
+set_intersect_simd(out, a, b)       -- set_intersect, always with the block kernel
+set_intersect_gallop(out, a, b)     -- set_intersect, always galloping the shorter set through the longer
+set_union(out, a, b)                -- out = elements in a or b
+set_difference(out, a, b)           -- out = elements in a but not in b
+set_union_k(out, sets, k)           -- out = elements in any of the k sets in the array sets
+
+Each returns 0, or -1 if out couldn't be grown. out is reserved for the largest possible
+result (plus a few elements of slack for the block kernel) but never shrunk, so once it's
+big enough nothing is allocated. out must not be one of the inputs. For set_union_k, sets
+is an array of vec_u32 or vec_u64, the same type as out.
+
+The block kernel compares 8 u32 or 4 u64 of a against as many of b at once with AVX2,
+every pair through rotated copies of b, then packs the matches to the front with a
+shuffle and advances whichever block ended lower. Without AVX2 it's a branchless
+two-pointer merge. When one set is STD_SET_GALLOP times longer than the other,
+set_intersect gallops instead: each element of the short set is looked for in the long
+one by doubling steps from where the last one was found, then a binary search, which is
+O(n log(m/n)). set_union and set_difference gallop the same way when the sizes are that
+far apart, copying the runs of the long set between matches with memcpy, and otherwise
+are branchless merges. set_union_k pops the smallest head off a heap of the k sets,
+O(n log k).
+
+*/
+
+// intersection and difference gallop when one set is at least this many times longer
+#define STD_SET_GALLOP 32
+
+
+// out = elements in both a and b
+#define set_intersect(out, a, b) \
+  __set_op(out, a, b, intersect, __set_min((a)->len, (b)->len) + __SET_SLACK)
+
+
+// set_intersect, always with the block kernel
+#define set_intersect_simd(out, a, b) \
+  __set_op(out, a, b, intersect_simd, __set_min((a)->len, (b)->len) + __SET_SLACK)
+
+
+// set_intersect, always galloping the shorter set through the longer
+#define set_intersect_gallop(out, a, b) \
+  __set_op(out, a, b, intersect_gallop, __set_min((a)->len, (b)->len))
+
+
+// out = elements in a or b
+#define set_union(out, a, b) \
+  __set_op(out, a, b, union, (a)->len + (b)->len)
+
+
+// out = elements in a but not in b
+#define set_difference(out, a, b) \
+  __set_op(out, a, b, difference, (a)->len)
+
+
+// out = elements in any of the k sets in the array sets
+#define set_union_k(out, sets, k) \
+  __set_generic(out, union_k)(__v_unpack(out), (sets), (k))
+
+
+#define __set_op(out, a, b, name, n)                                                     \
+  (vec_reserve(out, n) != 0 ? -1 :                                                       \
+   ((out)->len = __set_generic(out, name)((a)->data, (a)->len, (b)->data, (b)->len, (out)->data), 0))
+
+
+#define __set_generic(v, name)            \
+  _Generic((v)->data,                     \
+    u32*: __set_##name##_u32,             \
+    u64*: __set_##name##_u64)
+
+
+#define __set_min(a, b) \
+  ((a) < (b) ? (a) : (b))
+
+
+// the block kernel stores 16 bytes at a time, so out needs this many elements past the result
+#define __SET_SLACK 8
+
+
+#if defined(__x86_64__)
+
+#define __SET_L(i) 4 * (i), 4 * (i) + 1, 4 * (i) + 2, 4 * (i) + 3
+
+// pshufb masks moving the 32-bit lanes picked by a 4-bit mask to the front, in order
+const u8 __set_pack[16][16] = {
+  { 0 },
+  { __SET_L(0) },
+  { __SET_L(1) },
+  { __SET_L(0), __SET_L(1) },
+  { __SET_L(2) },
+  { __SET_L(0), __SET_L(2) },
+  { __SET_L(1), __SET_L(2) },
+  { __SET_L(0), __SET_L(1), __SET_L(2) },
+  { __SET_L(3) },
+  { __SET_L(0), __SET_L(3) },
+  { __SET_L(1), __SET_L(3) },
+  { __SET_L(0), __SET_L(1), __SET_L(3) },
+  { __SET_L(2), __SET_L(3) },
+  { __SET_L(0), __SET_L(2), __SET_L(3) },
+  { __SET_L(1), __SET_L(2), __SET_L(3) },
+  { __SET_L(0), __SET_L(1), __SET_L(2), __SET_L(3) },
+};
+
+// stores the lanes of x picked by the 4-bit mask m at out, returns how many
+__attribute__((target("avx2,popcnt")))
+static inline __attribute__((unused)) usize __set_pack_store(void* out, __m128i x, int m) {
+  __m128i p = _mm_loadu_si128((const __m128i*) __set_pack[m]);
+  _mm_storeu_si128((__m128i*) out, _mm_shuffle_epi8(x, p));
+  return __builtin_popcount(m);
+}
+
+usize __set_intersect_merge_u32(const u32* a, usize na, const u32* b, usize nb, u32* out);
+usize __set_intersect_merge_u64(const u64* a, usize na, const u64* b, usize nb, u64* out);
+
+// 8x8 blocks: a against b in both 128-bit lane orders, each rotated by 0 to 3 lanes
+__attribute__((target("avx2,popcnt")))
+usize __set_intersect_u32_avx2(const u32* a, usize na, const u32* b, usize nb, u32* out) {
+  usize i = 0, j = 0, k = 0;
+  while (i + 8 <= na && j + 8 <= nb) {
+    __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*) (b + j));
+    __m256i vc = _mm256_permute2x128_si256(vb, vb, 1);
+    __m256i m0 = _mm256_or_si256(_mm256_cmpeq_epi32(va, vb), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, 0x39)));
+    __m256i m1 = _mm256_or_si256(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, 0x4e)),
+                                 _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, 0x93)));
+    __m256i m2 = _mm256_or_si256(_mm256_cmpeq_epi32(va, vc), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vc, 0x39)));
+    __m256i m3 = _mm256_or_si256(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vc, 0x4e)),
+                                 _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vc, 0x93)));
+    __m256i m = _mm256_or_si256(_mm256_or_si256(m0, m1), _mm256_or_si256(m2, m3));
+    int bits = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+    k += __set_pack_store(out + k, _mm256_castsi256_si128(va), bits & 15);
+    k += __set_pack_store(out + k, _mm256_extracti128_si256(va, 1), bits >> 4);
+    u32 amax = a[i + 7], bmax = b[j + 7];
+    i += amax <= bmax ? 8 : 0;
+    j += bmax <= amax ? 8 : 0;
+  }
+  return k + __set_intersect_merge_u32(a + i, na - i, b + j, nb - j, out + k);
+}
+
+// 4x4 blocks: a against b rotated by 0 to 3 lanes, each u64 lane is two lanes of __set_pack
+__attribute__((target("avx2,popcnt")))
+usize __set_intersect_u64_avx2(const u64* a, usize na, const u64* b, usize nb, u64* out) {
+  usize i = 0, j = 0, k = 0;
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*) (b + j));
+    __m256i m0 = _mm256_or_si256(_mm256_cmpeq_epi64(va, vb), _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39)));
+    __m256i m1 = _mm256_or_si256(_mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4e)),
+                                 _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93)));
+    int bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_or_si256(m0, m1)));
+    int lo = (bits & 1) * 3 | (bits & 2) * 6, hi = (bits >> 2 & 1) * 3 | (bits >> 2 & 2) * 6;
+    k += __set_pack_store(out + k, _mm256_castsi256_si128(va), lo) / 2;
+    k += __set_pack_store(out + k, _mm256_extracti128_si256(va, 1), hi) / 2;
+    u64 amax = a[i + 3], bmax = b[j + 3];
+    i += amax <= bmax ? 4 : 0;
+    j += bmax <= amax ? 4 : 0;
+  }
+  return k + __set_intersect_merge_u64(a + i, na - i, b + j, nb - j, out + k);
+}
+
+#define __SET_BLOCK(T) \
+  (std_cpu_has(STD_CPU_AVX2 | STD_CPU_POPCNT) ? __set_intersect_##T##_avx2 : __set_intersect_merge_##T)
+
+#else
+
+#define __SET_BLOCK(T) \
+  __set_intersect_merge_##T
+
+#endif
+
+
+// the kernels for one element type
+#define __SET_DEFINE(T)                                                                   \
+  usize __set_intersect_merge_##T(const T* a, usize na, const T* b, usize nb, T* out) {   \
+    usize i = 0, j = 0, k = 0;                                                            \
+    while (i < na && j < nb) {                                                            \
+      T x = a[i], y = b[j];                                                               \
+      out[k] = x;                                                                         \
+      k += x == y;                                                                        \
+      i += x <= y;                                                                        \
+      j += y <= x;                                                                        \
+    }                                                                                     \
+    return k;                                                                             \
+  }                                                                                       \
+                                                                                          \
+  /* first index from lo on with b[i] >= x, by doubling steps then a binary search */     \
+  usize __set_gallop_##T(const T* b, usize lo, usize nb, T x) {                           \
+    usize hi = lo, step = 1;                                                              \
+    while (hi < nb && b[hi] < x) {                                                        \
+      lo = hi + 1;                                                                        \
+      hi += step;                                                                         \
+      step <<= 1;                                                                         \
+    }                                                                                     \
+    if (hi > nb) hi = nb;                                                                 \
+    while (lo < hi) {                                                                     \
+      usize mid = lo + (hi - lo) / 2;                                                     \
+      if (b[mid] < x) lo = mid + 1;                                                       \
+      else hi = mid;                                                                      \
+    }                                                                                     \
+    return lo;                                                                            \
+  }                                                                                       \
+                                                                                          \
+  usize __set_intersect_gallop_##T(const T* a, usize na, const T* b, usize nb, T* out) {  \
+    if (na > nb) return __set_intersect_gallop_##T(b, nb, a, na, out);                    \
+    usize j = 0, k = 0;                                                                   \
+    for (usize i = 0; i < na; i++) {                                                      \
+      j = __set_gallop_##T(b, j, nb, a[i]);                                               \
+      if (j == nb) break;                                                                 \
+      out[k] = a[i];                                                                      \
+      k += b[j] == a[i];                                                                  \
+    }                                                                                     \
+    return k;                                                                             \
+  }                                                                                       \
+                                                                                          \
+  usize __set_intersect_simd_##T(const T* a, usize na, const T* b, usize nb, T* out) {    \
+    return __SET_BLOCK(T)(a, na, b, nb, out);                                             \
+  }                                                                                       \
+                                                                                          \
+  usize __set_intersect_##T(const T* a, usize na, const T* b, usize nb, T* out) {         \
+    if (na / STD_SET_GALLOP >= nb || nb / STD_SET_GALLOP >= na) {                         \
+      return __set_intersect_gallop_##T(a, na, b, nb, out);                               \
+    }                                                                                     \
+    return __SET_BLOCK(T)(a, na, b, nb, out);                                             \
+  }                                                                                       \
+                                                                                          \
+  /* copies the runs of b between the elements of a, which is much shorter */             \
+  usize __set_union_gallop_##T(const T* a, usize na, const T* b, usize nb, T* out) {      \
+    usize j = 0, k = 0;                                                                   \
+    for (usize i = 0; i < na; i++) {                                                      \
+      usize p = __set_gallop_##T(b, j, nb, a[i]);                                         \
+      memcpy(out + k, b + j, (p - j) * sizeof(T));                                        \
+      k += p - j;                                                                         \
+      j = p;                                                                              \
+      out[k] = a[i];                                                                      \
+      k += j == nb || b[j] != a[i];                                                       \
+    }                                                                                     \
+    if (j < nb) memcpy(out + k, b + j, (nb - j) * sizeof(T));                             \
+    return k + nb - j;                                                                    \
+  }                                                                                       \
+                                                                                          \
+  usize __set_union_##T(const T* a, usize na, const T* b, usize nb, T* out) {             \
+    usize i = 0, j = 0, k = 0;                                                            \
+    if (nb / STD_SET_GALLOP >= na) return __set_union_gallop_##T(a, na, b, nb, out);      \
+    if (na / STD_SET_GALLOP >= nb) return __set_union_gallop_##T(b, nb, a, na, out);      \
+    while (i < na && j < nb) {                                                            \
+      T x = a[i], y = b[j];                                                               \
+      out[k++] = x <= y ? x : y;                                                          \
+      i += x <= y;                                                                        \
+      j += y <= x;                                                                        \
+    }                                                                                     \
+    if (i < na) memcpy(out + k, a + i, (na - i) * sizeof(T));                             \
+    k += na - i;                                                                          \
+    if (j < nb) memcpy(out + k, b + j, (nb - j) * sizeof(T));                             \
+    return k + nb - j;                                                                    \
+  }                                                                                       \
+                                                                                          \
+  usize __set_difference_##T(const T* a, usize na, const T* b, usize nb, T* out) {        \
+    usize i = 0, j = 0, k = 0;                                                            \
+    if (nb / STD_SET_GALLOP >= na) {                                                      \
+      for (; i < na && j < nb; i++) {                                                     \
+        j = __set_gallop_##T(b, j, nb, a[i]);                                             \
+        out[k] = a[i];                                                                    \
+        k += j == nb || b[j] != a[i];                                                     \
+      }                                                                                   \
+    } else if (na / STD_SET_GALLOP >= nb) {                                               \
+      /* copy the runs of a between the elements of b */                                  \
+      for (; i < na && j < nb; j++) {                                                     \
+        usize p = __set_gallop_##T(a, i, na, b[j]);                                       \
+        memcpy(out + k, a + i, (p - i) * sizeof(T));                                      \
+        k += p - i;                                                                       \
+        i = p + (p < na && a[p] == b[j]);                                                 \
+      }                                                                                   \
+    } else {                                                                              \
+      while (i < na && j < nb) {                                                          \
+        T x = a[i], y = b[j];                                                             \
+        out[k] = x;                                                                       \
+        k += x < y;                                                                       \
+        i += x <= y;                                                                      \
+        j += y <= x;                                                                      \
+      }                                                                                   \
+    }                                                                                     \
+    if (i < na) memcpy(out + k, a + i, (na - i) * sizeof(T));                             \
+    return k + na - i;                                                                    \
+  }                                                                                       \
+                                                                                          \
+  typedef struct {                                                                        \
+    T val;                                                                                \
+    usize set;                                                                            \
+  } __set_head_##T;                                                                       \
+                                                                                          \
+  int __set_union_k_##T(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, \
+                        const vec_##T* sets, usize k) {                                   \
+    usize total = 0, n = 0;                                                               \
+    for (usize s = 0; s < k; s++) total += sets[s]->len;                                  \
+    if (__v_reserve(STD_ALLOC_FWD data, len, cap, memsz, total) != 0) return -1;          \
+    struct { __set_head_##T* data; usize len; } h = { null, 0 };                          \
+    usize* pos = std_malloc(alloc, k * (sizeof(*h.data) + sizeof(usize)) + 1);           \
+    if (pos == null) return -1;                                                           \
+    h.data = (__set_head_##T*) (pos + k);                                                 \
+    for (usize s = 0; s < k; s++) {                                                       \
+      pos[s] = 1;                                                                         \
+      if (sets[s]->len > 0) h.data[h.len++] = (__set_head_##T) { sets[s]->data[0], s };   \
+    }                                                                                     \
+    for (usize i = h.len / 2; i-- > 0;) __h_sift_down(&h, i, __set_head_less);            \
+    T* out = *data;                                                                       \
+    while (h.len > 0) {                                                                   \
+      __set_head_##T top = h.data[0];                                                     \
+      out[n] = top.val;                                                                   \
+      n += n == 0 || out[n - 1] != top.val;                                               \
+      usize s = top.set;                                                                  \
+      if (pos[s] < sets[s]->len) h.data[0].val = sets[s]->data[pos[s]++];                 \
+      else h.data[0] = h.data[--h.len];                                                   \
+      if (h.len > 0) __h_sift_down(&h, 0, __set_head_less);                               \
+    }                                                                                     \
+    std_free(alloc, pos, k * (sizeof(*h.data) + sizeof(usize)) + 1);                     \
+    *len = n;                                                                             \
+    return 0;                                                                             \
+  }                                                                                       \
+
+
+#define __set_head_less(a, b) \
+  ((a).val < (b).val)
+
+
+__SET_DEFINE(u32)
+__SET_DEFINE(u64)
+
+
+#endif // STD_SET_H
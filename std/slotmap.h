@@ -0,0 +1,262 @@
+#ifndef STD_SLOTMAP_H
+#define STD_SLOTMAP_H
+
+#include "alloc.h"
+#include "types.h"
+#include "vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+slotmap.h - slot map: stable generational handles to densely packed values
+
+slotmap(T) - the type of a slot map. Until C23, typedef this to something before using.
+
+Inserting a value gives back a slotmap_id handle. A handle stays valid until its value
+is removed, no matter what else is inserted or removed, and a removed value's handle
+never finds anything again, even once its slot is reused. Insert, remove and lookup are
+O(1). The values themselves sit packed in a vec with no holes, so iterating over them is
+a plain loop over an array.
+
+** Memory management **
+slotmap_init(m)                     -- initialize slot map
+slotmap_init_with(m, a)             -- initialize slot map using allocator a (STD_USE_ALLOCATOR only)
+slotmap_free(m)                     -- free all memory
+slotmap_reserve(m, n)               -- reserve size for n values, returns 0 or -1 if out of memory
+slotmap_clear(m)                    -- remove every value, invalidating every handle
+
+** Properties **
+slotmap_len(m)                      -- number of values
+slotmap_is_empty(m)                 -- is the slot map empty?
+slotmap_contains(m, id)             -- is there a value for handle id?
+slotmap_get(m, id)                  -- pointer to the value for handle id, or null
+slotmap_at(m, id)                   -- the value for handle id, which must be valid
+slotmap_values(m)                   -- the vec of values, in no particular order
+slotmap_id_at(m, i)                 -- handle of the value at index i of slotmap_values
+
+** Operations **
+slotmap_insert(m, val)              -- add a value and return its handle, 0 if out of memory
+slotmap_remove(m, id)               -- remove the value for handle id, returns 0 or -1 if there's none
+
+** Iteration **
+slotmap_iter(m, t)                  -- stores each value in t
+slotmap_enum(m, id, t)              -- stores each handle in id and each value in t
+
+A handle is the slot's index in its low 32 bits and the slot's generation in the high 32.
+A slot's generation goes up on every insert and every remove, so it's odd while the slot
+holds a value, and 0 is never a valid handle (a zeroed slotmap_id means none). Removing
+moves the last value into the hole, so removing while iterating skips the moved value
+unless the loop goes backwards, and pointers from slotmap_get only last until the next
+insert or remove.
+
+The values vec, the slots (generation plus where the value is) and the back-index from
+each value to its slot are all vecs, growing the usual way.
+
+*/
+
+// handle to a value in a slot map
+typedef u64 slotmap_id;
+
+// a slot: its generation and, while live, the index of its value, else the next free slot
+typedef struct {
+  u32 gen;
+  u32 idx;
+} __sm_slot;
+
+typedef vec(__sm_slot) __sm_slots;
+typedef vec(u32) __sm_owners;
+
+// end of the free list
+#define __SM_NONE ((u32) -1)
+
+#define slotmap(T)            \
+  struct {                    \
+    vec(T) values;            \
+    __sm_slots slots;         \
+    __sm_owners owners;       \
+    u32 free;                 \
+    STD_ALLOC_FIELD           \
+  }*                          \
+
+
+#define __sm_unpack(m) \
+  (m)->slots, (m)->owners, &(m)->free
+
+
+// initialize slot map
+#define slotmap_init(m) \
+  __sm_init_with(m, std_allocator_get())
+
+
+#ifdef STD_USE_ALLOCATOR
+// initialize slot map using allocator a
+#define slotmap_init_with(m, a) \
+  __sm_init_with(m, a)
+#endif
+
+
+#define __sm_init_with(m, a)                                        \
+  do {                                                              \
+    *(void**)&(m) = std_calloc((a), 1, sizeof(*(m)));               \
+    std_alloc_init((m), (a));                                       \
+    __v_init_with((m)->values, (a));                                \
+    __v_init_with((m)->slots, (a));                                 \
+    __v_init_with((m)->owners, (a));                                \
+    (m)->free = __SM_NONE;                                          \
+  } while(0)
+
+
+// free all memory
+#define slotmap_free(m)                                             \
+  do {                                                              \
+    vec_free((m)->values);                                          \
+    vec_free((m)->slots);                                           \
+    vec_free((m)->owners);                                          \
+    std_free((m)->alloc, (m), sizeof(*(m)));                        \
+  } while(0)
+
+
+// reserve size for n values, returns 0 or -1 if out of memory
+#define slotmap_reserve(m, n) \
+  __sm_reserve(vec_reserve((m)->values, n), (m)->slots, (m)->owners, n)
+
+
+// remove every value, invalidating every handle
+#define slotmap_clear(m) \
+  (__sm_clear(__sm_unpack(m)), vec_clear((m)->values))
+
+
+// number of values
+#define slotmap_len(m) \
+  ((m)->values->len)
+
+
+// is the slot map empty?
+#define slotmap_is_empty(m) \
+  ((m)->values->len == 0)
+
+
+// is there a value for handle id?
+#define slotmap_contains(m, id) \
+  (__sm_find((m)->slots, id) != __SM_NONE)
+
+
+// pointer to the value for handle id, or null
+#define slotmap_get(m, id) \
+  ((__typeof__((m)->values->data)) __sm_get((m)->values->data, sizeof(*(m)->values->data), (m)->slots, id))
+
+
+// the value for handle id, which must be valid
+#define slotmap_at(m, id) \
+  ((m)->values->data[(m)->slots->data[(u32) (id)].idx])
+
+
+// the vec of values, in no particular order
+#define slotmap_values(m) \
+  ((m)->values)
+
+
+// handle of the value at index i of slotmap_values
+#define slotmap_id_at(m, i) \
+  __sm_id((m)->slots, (m)->owners->data[i])
+
+
+// add a value and return its handle, 0 if out of memory
+#define slotmap_insert(m, val)                                                              \
+  (__v_expand(__v_unpack((m)->values)) != 0 ? 0 :                                           \
+   ((m)->values->data[(m)->values->len++] = (val), __sm_insert(__sm_unpack(m), &(m)->values->len)))
+
+
+// remove the value for handle id, returns 0 or -1 if there's none
+#define slotmap_remove(m, id) \
+  __sm_remove(__sm_unpack(m), (m)->values->data, sizeof(*(m)->values->data), &(m)->values->len, id)
+
+
+// stores each value in t
+#define slotmap_iter(m, t) \
+  vec_iter((m)->values, t)
+
+
+// stores each handle in id and each value in t
+#define slotmap_enum(m, id, t)                                                                \
+  if ((m)->values->len > 0)                                                                   \
+  for (usize __i = 0; __i < (m)->values->len &&                                               \
+       (((id) = slotmap_id_at(m, __i)), ((t) = (m)->values->data[__i]), 1); ++__i)            \
+
+
+slotmap_id __sm_id(__sm_slots slots, u32 s) {
+  return ((u64) slots->data[s].gen << 32) | s;
+}
+
+// slot of a live handle, or __SM_NONE
+u32 __sm_find(__sm_slots slots, slotmap_id id) {
+  u32 s = (u32) id;
+  if (s >= slots->len || slots->data[s].gen != (u32) (id >> 32) || (id >> 32) % 2 == 0) return __SM_NONE;
+  return s;
+}
+
+void* __sm_get(void* values, usize memsz, __sm_slots slots, slotmap_id id) {
+  u32 s = __sm_find(slots, id);
+  return s == __SM_NONE ? null : (char*) values + (usize) slots->data[s].idx * memsz;
+}
+
+// err is what reserving the values gave
+int __sm_reserve(int err, __sm_slots slots, __sm_owners owners, usize n) {
+  return vec_reserve(slots, n) | vec_reserve(owners, n) | err;
+}
+
+// give the value just pushed (the last of len) a slot and return its handle; the owners
+// grow first so a fresh slot is never left behind half made
+slotmap_id __sm_insert(__sm_slots slots, __sm_owners owners, u32* free, usize* len) {
+  u32 s = *free;
+  if (__v_expand(__v_unpack(owners)) != 0) goto fail;
+  if (s == __SM_NONE) {
+    if (__v_expand(__v_unpack(slots)) != 0) goto fail;
+    s = slots->len++;
+    slots->data[s] = (__sm_slot) { 0, __SM_NONE };
+  } else {
+    *free = slots->data[s].idx;
+  }
+  owners->data[owners->len++] = s;
+  slots->data[s].gen++;
+  slots->data[s].idx = *len - 1;
+  return __sm_id(slots, s);
+fail:
+  (*len)--;
+  return 0;
+}
+
+int __sm_remove(__sm_slots slots, __sm_owners owners, u32* free, void* values, usize memsz, usize* len,
+                slotmap_id id) {
+  u32 s = __sm_find(slots, id);
+  if (s == __SM_NONE) return -1;
+  // move the last value into the hole and point its slot at the new place
+  u32 hole = slots->data[s].idx;
+  usize last = *len - 1;
+  if (hole != last) {
+    memcpy((char*) values + hole * memsz, (char*) values + last * memsz, memsz);
+    owners->data[hole] = owners->data[last];
+    slots->data[owners->data[hole]].idx = hole;
+  }
+  (*len)--;
+  owners->len--;
+  slots->data[s].gen++;
+  slots->data[s].idx = *free;
+  *free = s;
+  return 0;
+}
+
+// free every live slot, the values are dropped by the caller
+void __sm_clear(__sm_slots slots, __sm_owners owners, u32* free) {
+  for (usize i = 0; i < owners->len; i++) {
+    u32 s = owners->data[i];
+    slots->data[s].gen++;
+    slots->data[s].idx = *free;
+    *free = s;
+  }
+  owners->len = 0;
+}
+
+#endif // STD_SLOTMAP_H
@@ -0,0 +1,259 @@
+#ifndef STD_SOA_H
+#define STD_SOA_H
+
+#include "alloc.h"
+#include "types.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+soa.h - struct-of-arrays container generator in C
+
+SOA_DEFINE(name, (T1, f1), (T2, f2), ...) defines the type `name`: a dynamic array of
+records stored as one contiguous column per field. All columns share one len/cap and
+grow together: a reserve that can't get every column leaves all of them as they were.
+Up to 16 fields; fields can't be called len, cap, ncols, sizes or cols.
+
+The soa_* operations follow the vec_* names. Making one is the exception: the column
+sizes are in a table only SOA_DEFINE can name, so it generates name_new() to go with
+name_push() where a vec has vec_init(v).
+
+    SOA_DEFINE(particles, (float, x), (float, y), (int, id))
+
+    particles p = particles_new();
+    particles_push(p, 1.0f, 2.0f, 7);
+    float* xs = soa_col(p, x);          -- scan one field without touching the others
+
+** Generated **
+name_new()                          -- new empty container
+name_push(s, v1, v2, ...)           -- push one record, a value per field in order
+
+** Memory management **
+soa_free(s)                         -- free all memory
+soa_reserve(s, n)                   -- reserve size for n records in every column
+soa_truncate(s, n)                  -- reduce to just the first n records
+soa_clear(s)                        -- len = 0
+
+** Properties **
+soa_len(s)                          -- the number of records
+soa_is_empty(s)                     -- is the container empty?
+soa_col(s, f)                       -- pointer to the column of field f
+soa_at(s, f, i)                     -- field f of record i
+
+** Operations **
+soa_pop(s)                          -- remove the last record
+soa_swap(s, i, j)                   -- swap 2 records
+soa_swapsplice(s, i, n)             -- remove n records starting at i, replacing them with the last n
+
+** Iteration **
+soa_enum(s, i)                      -- stores each record index in i
+
+*/
+
+#define SOA_DEFINE(name, ...)                                                           \
+  typedef struct {                                                                      \
+    usize len;                                                                          \
+    usize cap;                                                                          \
+    usize ncols;                                                                        \
+    const usize* sizes;                                                                 \
+    STD_ALLOC_FIELD                                                                     \
+    union {                                                                             \
+      struct { __SOA_MAP(__SOA_FIELD, __VA_ARGS__) };                                   \
+      void* cols[__SOA_NARGS(__VA_ARGS__)];                                             \
+    };                                                                                  \
+  }* name;                                                                              \
+                                                                                        \
+  static const usize name##__sizes[] = { __SOA_MAP(__SOA_SIZE, __VA_ARGS__) };          \
+                                                                                        \
+  static inline __attribute__((unused)) name name##_new() {                             \
+    return (name) __soa_new(STD_ALLOC_DEFAULT sizeof(*(name) null),                     \
+                            __SOA_NARGS(__VA_ARGS__), name##__sizes);                   \
+  }                                                                                     \
+                                                                                        \
+  static inline __attribute__((unused))                                                 \
+  int name##_push(name __s __SOA_MAP(__SOA_PARAM, __VA_ARGS__)) {                       \
+    if (__s->len == __s->cap                                                            \
+        && __soa_reserve(__s, __s->cap == 0 ? 4 : __s->cap << 1) != 0) return -1;       \
+    __SOA_MAP(__SOA_STORE, __VA_ARGS__)                                                 \
+    __s->len++;                                                                         \
+    return 0;                                                                           \
+  }                                                                                     \
+
+
+// free all memory
+#define soa_free(s) \
+  __soa_free(s)
+
+
+// reserve size for n records in every column
+#define soa_reserve(s, n) \
+  __soa_reserve(s, n)
+
+
+// reduce to just the first n records
+#define soa_truncate(s, n) \
+  ((s)->len = (n) < (s)->len ? (n) : (s)->len)
+
+
+// len = 0
+#define soa_clear(s) \
+  ((s)->len = 0)
+
+
+// the number of records
+#define soa_len(s) \
+  ((s)->len)
+
+
+// is the container empty?
+#define soa_is_empty(s) \
+  ((s)->len == 0)
+
+
+// pointer to the column of field f
+#define soa_col(s, f) \
+  ((s)->f)
+
+
+// field f of record i
+#define soa_at(s, f, i) \
+  ((s)->f[i])
+
+
+// remove the last record
+#define soa_pop(s) \
+  ((s)->len--)
+
+
+// swap 2 records
+#define soa_swap(s, i, j) \
+  __soa_swap(s, i, j)
+
+
+// remove n records starting at i, replacing them with the last n
+#define soa_swapsplice(s, i, n) \
+  __soa_swapsplice(s, i, n)
+
+
+// stores each record index in i
+#define soa_enum(s, i) \
+  for ((i) = 0; (i) < (s)->len; ++(i))
+
+
+// field and argument lists, applied to each (T, f) pair
+
+#define __SOA_FIELD(T, f)   T* f;
+#define __SOA_SIZE(T, f)    sizeof(T),
+#define __SOA_PARAM(T, f)   , T f
+#define __SOA_STORE(T, f)   __s->f[__s->len] = f;
+
+#define __SOA_NARGS(...) \
+  __SOA_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define __SOA_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+
+#define __SOA_CAT(a, b)     __SOA_CAT_(a, b)
+#define __SOA_CAT_(a, b)    a ## b
+
+#define __SOA_MAP(m, ...)   __SOA_CAT(__SOA_MAP_, __SOA_NARGS(__VA_ARGS__))(m, __VA_ARGS__)
+#define __SOA_MAP_1(m, x)         m x
+#define __SOA_MAP_2(m, x, ...)    m x __SOA_MAP_1(m, __VA_ARGS__)
+#define __SOA_MAP_3(m, x, ...)    m x __SOA_MAP_2(m, __VA_ARGS__)
+#define __SOA_MAP_4(m, x, ...)    m x __SOA_MAP_3(m, __VA_ARGS__)
+#define __SOA_MAP_5(m, x, ...)    m x __SOA_MAP_4(m, __VA_ARGS__)
+#define __SOA_MAP_6(m, x, ...)    m x __SOA_MAP_5(m, __VA_ARGS__)
+#define __SOA_MAP_7(m, x, ...)    m x __SOA_MAP_6(m, __VA_ARGS__)
+#define __SOA_MAP_8(m, x, ...)    m x __SOA_MAP_7(m, __VA_ARGS__)
+#define __SOA_MAP_9(m, x, ...)    m x __SOA_MAP_8(m, __VA_ARGS__)
+#define __SOA_MAP_10(m, x, ...)   m x __SOA_MAP_9(m, __VA_ARGS__)
+#define __SOA_MAP_11(m, x, ...)   m x __SOA_MAP_10(m, __VA_ARGS__)
+#define __SOA_MAP_12(m, x, ...)   m x __SOA_MAP_11(m, __VA_ARGS__)
+#define __SOA_MAP_13(m, x, ...)   m x __SOA_MAP_12(m, __VA_ARGS__)
+#define __SOA_MAP_14(m, x, ...)   m x __SOA_MAP_13(m, __VA_ARGS__)
+#define __SOA_MAP_15(m, x, ...)   m x __SOA_MAP_14(m, __VA_ARGS__)
+#define __SOA_MAP_16(m, x, ...)   m x __SOA_MAP_15(m, __VA_ARGS__)
+
+
+// layout shared by every generated container
+typedef struct {
+  usize len;
+  usize cap;
+  usize ncols;
+  const usize* sizes;
+  STD_ALLOC_FIELD
+  void* cols[];
+} __soa_header;
+
+
+void* __soa_new(STD_ALLOC_PARAM usize size, usize ncols, const usize* sizes) {
+  __soa_header* h = std_calloc(alloc, 1, size);
+  if (h == null) return null;
+  std_alloc_init(h, alloc);
+  h->ncols = ncols;
+  h->sizes = sizes;
+  return h;
+}
+
+
+void __soa_free(void* s) {
+  __soa_header* h = s;
+  for (usize c = 0; c < h->ncols; c++) {
+    std_free(h->alloc, h->cols[c], h->cap * h->sizes[c]);
+  }
+  std_free(h->alloc, h, sizeof(__soa_header) + h->ncols * sizeof(void*));
+}
+
+
+// every column moves to a new block, or none does and cap stays what the blocks are
+int __soa_reserve(void* s, usize n) {
+  __soa_header* h = s;
+  void* fresh[16];
+  if (n <= h->cap) return 0;
+  for (usize c = 0; c < h->ncols; c++) {
+    fresh[c] = std_malloc(h->alloc, n * h->sizes[c]);
+    if (fresh[c] == null) {
+      while (c-- > 0) std_free(h->alloc, fresh[c], n * h->sizes[c]);
+      return -1;
+    }
+  }
+  for (usize c = 0; c < h->ncols; c++) {
+    if (h->len > 0) memcpy(fresh[c], h->cols[c], h->len * h->sizes[c]);
+    std_free(h->alloc, h->cols[c], h->cap * h->sizes[c]);
+    h->cols[c] = fresh[c];
+  }
+  h->cap = n;
+  return 0;
+}
+
+
+void __soa_swap(void* s, usize i, usize j) {
+  __soa_header* h = s;
+  unsigned char tmp[64];
+  if (i == j) return;
+  for (usize c = 0; c < h->ncols; c++) {
+    usize sz = h->sizes[c];
+    unsigned char* a = (unsigned char*) h->cols[c] + i * sz;
+    unsigned char* b = (unsigned char*) h->cols[c] + j * sz;
+    while (sz > 0) {
+      usize n = sz < sizeof(tmp) ? sz : sizeof(tmp);
+      memcpy(tmp, a, n);
+      memcpy(a, b, n);
+      memcpy(b, tmp, n);
+      a += n, b += n, sz -= n;
+    }
+  }
+}
+
+
+void __soa_swapsplice(void* s, usize i, usize n) {
+  __soa_header* h = s;
+  for (usize c = 0; c < h->ncols; c++) {
+    usize sz = h->sizes[c];
+    memmove((char*) h->cols[c] + i * sz, (char*) h->cols[c] + (h->len - n) * sz, n * sz);
+  }
+  h->len -= n;
+}
+
+
+#endif // STD_SOA_H
@@ -0,0 +1,520 @@
+#ifndef STD_SORT_H
+#define STD_SORT_H
+
+#include "alloc.h"
+#include "heap.h"
+#include "types.h"
+#include "vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+sort.h - selection, partial sorting and top-k in C
+(the selection macros work on anything with data and len fields, vec, array or svec)
+
+** Selection **
+vec_nth_element(v, k)               -- put the element that sorts to index k there, smaller ones before it, larger after
+vec_nth_element_by(v, k, less)      -- vec_nth_element with less(a, b) instead of a < b
+vec_partial_sort(v, k)              -- sort the k smallest elements into the first k places, the rest in no order
+vec_partial_sort_by(v, k, less)     -- vec_partial_sort with less(a, b) instead of a < b
+array_nth_element(a, k)             -- same for arrays
+array_nth_element_by(a, k, less)
+array_partial_sort(a, k)
+array_partial_sort_by(a, k, less)
+
+** Stable sorting **
+vec_stable_sort(v, tmp)             -- sort v keeping equal elements in order, tmp is a scratch vec of the same type
+vec_stable_sort_by(v, tmp, less)    -- vec_stable_sort with less(a, b) instead of a < b
+array_stable_sort(a, tmp)           -- same for arrays
+array_stable_sort_by(a, tmp, less)
+
+topk(T) - the k largest values of a stream, in a min-heap of at most k elements with the
+same layout as vec(T) and heap(T)
+
+** Top-k **
+topk_init(t, k)                     -- initialize top-k accumulator keeping k values
+topk_free(t)                        -- free all memory
+topk_clear(t)                       -- forget every value
+topk_len(t)                         -- values kept so far, at most k
+topk_min(t)                         -- smallest value kept, the one the next bigger value replaces
+topk_push(t, val)                   -- offer val, kept if it's among the k largest so far
+topk_push_by(t, val, less)          -- topk_push with less(a, b) instead of a < b
+topk_sort(t)                        -- sort the kept values smallest first
+topk_sort_by(t, less)               -- topk_sort with less(a, b) instead of a < b
+
+vec_nth_element is introselect: quickselect with a median-of-3 pivot, O(n) on average,
+switching to a heap select if it recurses too deep so the worst case is O(n log n).
+For a quantile q of n values, vec_nth_element(v, (usize) (q * (n - 1))) then read
+v->data[k]. vec_partial_sort selects first and then heapsorts the k smallest, so it's
+O(n + k log k) rather than the O(n log n) of sorting everything.
+
+vec_stable_sort is a natural merge sort in the style of timsort. It splits v into the
+runs already in it (strictly descending ones get reversed), extends short runs to 32-64
+elements with binary insertion sort, and merges neighbouring runs in the order powersort
+picks. A merge first skips the elements already in place at both ends, then copies the
+left run to tmp and merges back; when one side keeps winning it gallops, moving whole
+blocks found by a doubling search. Sorted input takes one pass of n - 1 comparisons and
+never touches tmp. Sorted input with a few new elements appended costs sorting those
+plus a merge that gallops past most of the old ones. Otherwise tmp is reserved to n
+elements, so passing the same tmp to every sort allocates once. If tmp can't be grown,
+v is left as it was.
+
+less is a function or macro taking two values and everything is a macro over the
+element type, so comparisons are inlined instead of going through a qsort callback.
+For the k smallest values of a stream, give topk_push_by a less that compares the other
+way round. An ascending array is still a min-heap, so pushing can go on after topk_sort.
+
+*/
+
+// ranges at most this long are finished with insertion sort
+#define STD_SORT_SMALL 16
+
+// wins in a row before a stable sort merge starts galloping
+#define STD_SORT_GALLOP 7
+
+
+// put the element that sorts to index k there, smaller ones before it, larger after
+#define vec_nth_element(v, k) \
+  vec_nth_element_by(v, k, __h_less)
+
+
+// vec_nth_element with less(a, b) instead of a < b
+#define vec_nth_element_by(v, k, less) \
+  __s_select((v)->data, (v)->len, (k), less)
+
+
+// sort the k smallest elements into the first k places, the rest in no order
+#define vec_partial_sort(v, k) \
+  vec_partial_sort_by(v, k, __h_less)
+
+
+// vec_partial_sort with less(a, b) instead of a < b
+#define vec_partial_sort_by(v, k, less)                                     \
+  do {                                                                      \
+    usize __pk = (k) < (v)->len ? (k) : (v)->len;                           \
+    if (__pk == 0) break;                                                   \
+    if (__pk < (v)->len) __s_select((v)->data, (v)->len, __pk - 1, less);   \
+    __s_heapsort((v)->data, __pk, less);                                    \
+  } while (0)
+
+
+#define array_nth_element(a, k)             vec_nth_element(a, k)
+#define array_nth_element_by(a, k, less)    vec_nth_element_by(a, k, less)
+#define array_partial_sort(a, k)            vec_partial_sort(a, k)
+#define array_partial_sort_by(a, k, less)   vec_partial_sort_by(a, k, less)
+
+
+// sort v keeping equal elements in order, tmp is a scratch vec of the same type
+#define vec_stable_sort(v, tmp) \
+  vec_stable_sort_by(v, tmp, __h_less)
+
+
+// vec_stable_sort with less(a, b) instead of a < b
+#define vec_stable_sort_by(v, tmp, less) \
+  __s_stable((v)->data, (v)->len, tmp, less)
+
+
+#define array_stable_sort(a, tmp)           vec_stable_sort(a, tmp)
+#define array_stable_sort_by(a, tmp, less)  vec_stable_sort_by(a, tmp, less)
+
+
+#define topk(T)       \
+  struct {            \
+    T* data;          \
+    usize len;        \
+    usize cap;        \
+    STD_ALLOC_FIELD   \
+    usize k;          \
+  }*                  \
+
+
+// initialize top-k accumulator keeping k values
+#define topk_init(t, n)                                                     \
+  do {                                                                      \
+    vec_init(t);                                                            \
+    vec_reserve(t, n);                                                      \
+    (t)->k = (n);                                                           \
+  } while (0)
+
+
+// free all memory
+#define topk_free(t) \
+  vec_free(t)
+
+
+// forget every value
+#define topk_clear(t) \
+  ((t)->len = 0)
+
+
+// values kept so far, at most k
+#define topk_len(t) \
+  ((t)->len)
+
+
+// smallest value kept, the one the next bigger value replaces
+#define topk_min(t) \
+  ((t)->data[0])
+
+
+// offer val, kept if it's among the k largest so far
+#define topk_push(t, val) \
+  topk_push_by(t, val, __h_less)
+
+
+// topk_push with less(a, b) instead of a < b
+#define topk_push_by(t, val, less)                                          \
+  do {                                                                      \
+    __typeof__(*(t)->data) __tv = (val);                                    \
+    if ((t)->len < (t)->k) {                                                \
+      heap_push_by(t, __tv, less);                                          \
+    } else if ((t)->k > 0 && less((t)->data[0], __tv)) {                    \
+      (t)->data[0] = __tv;                                                  \
+      __h_sift_down(t, 0, less);                                            \
+    }                                                                       \
+  } while (0)
+
+
+// sort the kept values smallest first
+#define topk_sort(t) \
+  topk_sort_by(t, __h_less)
+
+
+// topk_sort with less(a, b) instead of a < b
+#define topk_sort_by(t, less)                                               \
+  do {                                                                      \
+    usize __tn = (t)->len;                                                  \
+    /* popping the minimum to the back leaves them largest first */         \
+    while ((t)->len > 1) {                                                  \
+      __typeof__(*(t)->data) __tm = (t)->data[0];                           \
+      (t)->data[0] = (t)->data[--(t)->len];                                 \
+      (t)->data[(t)->len] = __tm;                                           \
+      __h_sift_down(t, 0, less);                                            \
+    }                                                                       \
+    (t)->len = __tn;                                                        \
+    vec_reverse(t);                                                         \
+  } while (0)
+
+
+// floor(log2(n)) for n > 0
+usize __s_log2(usize n) {
+  return 63 - __builtin_clzll((unsigned long long) n);
+}
+
+
+#define __s_swap(p, i, j)                                                   \
+  do {                                                                      \
+    __typeof__(*(p)) __st = (p)[i];                                         \
+    (p)[i] = (p)[j];                                                        \
+    (p)[j] = __st;                                                          \
+  } while (0)
+
+
+// insertion sort of n elements at p
+#define __s_insertion(p, n, less)                                           \
+  do {                                                                      \
+    __typeof__(p) __ip = (p);                                               \
+    for (usize __ia = 1, __in = (n); __ia < __in; __ia++) {                 \
+      __typeof__(*__ip) __ix = __ip[__ia];                                  \
+      usize __ib = __ia;                                                    \
+      for (; __ib > 0 && less(__ix, __ip[__ib - 1]); __ib--) {              \
+        __ip[__ib] = __ip[__ib - 1];                                        \
+      }                                                                     \
+      __ip[__ib] = __ix;                                                    \
+    }                                                                       \
+  } while (0)
+
+
+// moves element i of the max-heap of n elements at p down into place
+#define __s_sift_down(p, n, i, less)                                        \
+  do {                                                                      \
+    usize __di = (i), __dn = (n);                                           \
+    __typeof__(*(p)) __dx = (p)[__di];                                      \
+    for (;;) {                                                              \
+      usize __dc = 2 * __di + 1;                                            \
+      if (__dc >= __dn) break;                                              \
+      if (__dc + 1 < __dn && less((p)[__dc], (p)[__dc + 1])) __dc++;        \
+      if (!less(__dx, (p)[__dc])) break;                                    \
+      (p)[__di] = (p)[__dc];                                                \
+      __di = __dc;                                                          \
+    }                                                                       \
+    (p)[__di] = __dx;                                                       \
+  } while (0)
+
+
+// heapsort of n elements at p
+#define __s_heapsort(p, n, less)                                            \
+  do {                                                                      \
+    __typeof__(p) __hp = (p);                                               \
+    usize __hn = (n);                                                       \
+    for (usize __hi = __hn / 2; __hi-- > 0;) {                              \
+      __s_sift_down(__hp, __hn, __hi, less);                                \
+    }                                                                       \
+    while (__hn > 1) {                                                      \
+      __hn--;                                                               \
+      __s_swap(__hp, 0, __hn);                                              \
+      __s_sift_down(__hp, __hn, 0, less);                                   \
+    }                                                                       \
+  } while (0)
+
+
+// puts the element that sorts to k of n at p there through a max-heap of the first k+1
+#define __s_heap_select(p, n, k, less)                                      \
+  do {                                                                      \
+    __typeof__(p) __hp = (p);                                               \
+    usize __hk = (k) + 1, __hn = (n);                                       \
+    for (usize __hi = __hk / 2; __hi-- > 0;) {                              \
+      __s_sift_down(__hp, __hk, __hi, less);                                \
+    }                                                                       \
+    for (usize __hi = __hk; __hi < __hn; __hi++) {                          \
+      if (less(__hp[__hi], __hp[0])) {                                      \
+        __s_swap(__hp, 0, __hi);                                            \
+        __s_sift_down(__hp, __hk, 0, less);                                 \
+      }                                                                     \
+    }                                                                       \
+    __s_swap(__hp, 0, __hk - 1);                                            \
+  } while (0)
+
+
+// partitions [lo, hi) around the median of its first, middle and last elements,
+// which ends up at j with nothing bigger before it and nothing smaller after
+#define __s_partition(p, lo, hi, less, j)                                   \
+  do {                                                                      \
+    usize __pl = (lo), __ph = (hi) - 1, __pm = __pl + (__ph - __pl) / 2;    \
+    if (less((p)[__pm], (p)[__pl])) __s_swap(p, __pm, __pl);                \
+    if (less((p)[__ph], (p)[__pm])) {                                       \
+      __s_swap(p, __ph, __pm);                                              \
+      if (less((p)[__pm], (p)[__pl])) __s_swap(p, __pm, __pl);             \
+    }                                                                       \
+    __s_swap(p, __pl, __pm);                                                \
+    __typeof__(*(p)) __pv = (p)[__pl];                                      \
+    /* the last element is at least the pivot, so the scans stop in range */ \
+    usize __pi = __pl + 1, __pj = __ph;                                     \
+    for (;;) {                                                              \
+      while (less((p)[__pi], __pv)) __pi++;                                 \
+      while (less(__pv, (p)[__pj])) __pj--;                                 \
+      if (__pi >= __pj) break;                                              \
+      __s_swap(p, __pi, __pj);                                              \
+      __pi++;                                                               \
+      __pj--;                                                               \
+    }                                                                       \
+    __s_swap(p, __pl, __pj);                                                \
+    (j) = __pj;                                                             \
+  } while (0)
+
+
+// introselect: puts the element that sorts to k of n at p there
+#define __s_select(p, n, k, less)                                           \
+  do {                                                                      \
+    __typeof__(p) __sp = (p);                                               \
+    usize __sl = 0, __sh = (n), __sk = (k);                                 \
+    if (__sk >= __sh) break;                                                \
+    usize __depth = 2 * __s_log2(__sh);                                     \
+    while (__sh - __sl > STD_SORT_SMALL) {                                  \
+      if (__depth-- == 0) {                                                 \
+        __s_heap_select(__sp + __sl, __sh - __sl, __sk - __sl, less);       \
+        __sl = __sh;                                                        \
+        break;                                                              \
+      }                                                                     \
+      usize __sj;                                                           \
+      __s_partition(__sp, __sl, __sh, less, __sj);                          \
+      if (__sk == __sj) {                                                   \
+        __sl = __sh;                                                        \
+      } else if (__sk < __sj) {                                             \
+        __sh = __sj;                                                        \
+      } else {                                                              \
+        __sl = __sj + 1;                                                    \
+      }                                                                     \
+    }                                                                       \
+    if (__sl < __sh) __s_insertion(__sp + __sl, __sh - __sl, less);         \
+  } while (0)
+
+
+// minimum run length for n elements, between 32 and 64 so n / minrun is close to a power of 2
+usize __s_minrun(usize n) {
+  usize r = 0;
+  while (n >= 64) {
+    r |= n & 1;
+    n >>= 1;
+  }
+  return n + r;
+}
+
+// powersort's power of the boundary between the run of n1 at s1 and the next run of n2:
+// the first bit where the two runs' midpoints, as fractions of n, differ
+int __s_power(usize s1, usize n1, usize n2, usize n) {
+  usize a = 2 * s1 + n1, b = a + n1 + n2;
+  int power = 0;
+  for (;;) {
+    power++;
+    if (a >= n) {
+      a -= n;
+      b -= n;
+    } else if (b >= n) {
+      break;
+    }
+    a <<= 1;
+    b <<= 1;
+  }
+  return power;
+}
+
+// pending runs of a stable sort, enough for any n since their powers strictly increase
+#define __S_STACK 80
+
+
+// number of leading elements of the n at arr for which cond holds, cond being true for a
+// prefix and looking at the element through the pointer __gx; doubling steps, then bisection
+#define __s_gallop(arr, n, out, cond)                                       \
+  do {                                                                      \
+    const __typeof__(*(arr))* __ga = (arr);                                 \
+    const __typeof__(*(arr))* __gx;                                         \
+    usize __gn = (n), __gl = 0, __gh = 1;                                   \
+    while (__gh <= __gn && (__gx = &__ga[__gh - 1], (cond))) {              \
+      __gl = __gh;                                                          \
+      __gh = 2 * __gh + 1;                                                  \
+    }                                                                       \
+    if (__gh > __gn) __gh = __gn;                                           \
+    while (__gl < __gh) {                                                   \
+      usize __gm = __gl + (__gh - __gl) / 2;                                \
+      __gx = &__ga[__gm];                                                   \
+      if (cond) __gl = __gm + 1;                                            \
+      else __gh = __gm;                                                     \
+    }                                                                       \
+    (out) = __gl;                                                           \
+  } while (0)
+
+
+// end of the run starting at lo, reversed in place if it was strictly descending
+#define __s_run(p, lo, n, less, end)                                        \
+  do {                                                                      \
+    usize __rl = (lo), __re = __rl + 1, __rn = (n);                         \
+    if (__re < __rn && less((p)[__re], (p)[__re - 1])) {                    \
+      while (__re < __rn && less((p)[__re], (p)[__re - 1])) __re++;         \
+      __v_reverse((p) + __rl, __re - __rl, sizeof(*(p)));                   \
+    } else {                                                                \
+      while (__re < __rn && !less((p)[__re], (p)[__re - 1])) __re++;        \
+    }                                                                       \
+    (end) = __re;                                                           \
+  } while (0)
+
+
+// binary insertion of [mid, hi) into the sorted [lo, mid), after any equal elements
+#define __s_insertion_binary(p, lo, mid, hi, less)                          \
+  do {                                                                      \
+    for (usize __bi = (mid), __bn = (hi); __bi < __bn; __bi++) {            \
+      __typeof__(*(p)) __bx = (p)[__bi];                                    \
+      usize __bl = (lo), __bh = __bi;                                       \
+      while (__bl < __bh) {                                                 \
+        usize __bm = __bl + (__bh - __bl) / 2;                              \
+        if (less(__bx, (p)[__bm])) __bh = __bm;                             \
+        else __bl = __bm + 1;                                               \
+      }                                                                     \
+      memmove((p) + __bl + 1, (p) + __bl, (__bi - __bl) * sizeof(*(p)));    \
+      (p)[__bl] = __bx;                                                     \
+    }                                                                       \
+  } while (0)
+
+
+// merges [lo, mid) and [mid, hi) through t, which holds mid - lo elements; ties go left,
+// and after STD_SORT_GALLOP wins in a row by one side, blocks move at once until both
+// sides' blocks are short again
+#define __s_merge_lo(p, lo, mid, hi, t, less)                               \
+  do {                                                                      \
+    usize __ln = (mid) - (lo), __li = 0, __lj = (mid), __lk = (lo), __lh = (hi); \
+    memcpy((t), (p) + __lk, __ln * sizeof(*(p)));                           \
+    while (__li < __ln && __lj < __lh) {                                    \
+      usize __wa = 0, __wb = 0;                                             \
+      while (__li < __ln && __lj < __lh) {                                  \
+        if (less((p)[__lj], (t)[__li])) {                                   \
+          (p)[__lk++] = (p)[__lj++];                                        \
+          __wa = 0;                                                         \
+          if (++__wb >= STD_SORT_GALLOP) break;                             \
+        } else {                                                            \
+          (p)[__lk++] = (t)[__li++];                                        \
+          __wb = 0;                                                         \
+          if (++__wa >= STD_SORT_GALLOP) break;                             \
+        }                                                                   \
+      }                                                                     \
+      while (__li < __ln && __lj < __lh) {                                  \
+        usize __lc, __ld;                                                   \
+        __s_gallop((t) + __li, __ln - __li, __lc, !less((p)[__lj], *__gx)); \
+        memcpy((p) + __lk, (t) + __li, __lc * sizeof(*(p)));                \
+        __lk += __lc;                                                       \
+        __li += __lc;                                                       \
+        if (__li == __ln) break;                                            \
+        (p)[__lk++] = (p)[__lj++];                                          \
+        if (__lj == __lh) break;                                            \
+        __s_gallop((p) + __lj, __lh - __lj, __ld, less(*__gx, (t)[__li]));  \
+        memmove((p) + __lk, (p) + __lj, __ld * sizeof(*(p)));               \
+        __lk += __ld;                                                       \
+        __lj += __ld;                                                       \
+        if (__lj == __lh) break;                                            \
+        (p)[__lk++] = (t)[__li++];                                          \
+        if (__lc < STD_SORT_GALLOP && __ld < STD_SORT_GALLOP) break;        \
+      }                                                                     \
+    }                                                                       \
+    /* what's left of the right run is already in place */                 \
+    memcpy((p) + __lk, (t) + __li, (__ln - __li) * sizeof(*(p)));           \
+  } while (0)
+
+
+// merges the sorted runs [lo, mid) and [mid, hi) using t
+#define __s_merge(p, lo, mid, hi, t, less)                                  \
+  do {                                                                      \
+    usize __ml = (lo), __mm = (mid), __mh = (hi), __mc;                     \
+    /* the left run's elements up to the right's first, and the right's */  \
+    /* from the left's last on, are in place already */                     \
+    __s_gallop((p) + __ml, __mm - __ml, __mc, !less((p)[__mm], *__gx));     \
+    __ml += __mc;                                                           \
+    if (__ml == __mm) break;                                                \
+    __s_gallop((p) + __mm, __mh - __mm, __mc, less(*__gx, (p)[__mm - 1]));  \
+    __mh = __mm + __mc;                                                     \
+    __s_merge_lo(p, __ml, __mm, __mh, t, less);                             \
+  } while (0)
+
+
+// natural merge sort of n at p with scratch vec tmp
+#define __s_stable(p, n, tmp, less)                                         \
+  do {                                                                      \
+    __typeof__(p) __sp = (p);                                               \
+    usize __sn = (n), __se = 1;                                             \
+    while (__se < __sn && !less(__sp[__se], __sp[__se - 1])) __se++;        \
+    if (__se >= __sn) break;                                                \
+    if (vec_reserve(tmp, __sn) != 0) break;                                 \
+    __typeof__(p) __st = (tmp)->data;                                       \
+    usize __base[__S_STACK], __len[__S_STACK], __top = 0;                   \
+    int __pow[__S_STACK];                                                   \
+    usize __minrun = __s_minrun(__sn);                                      \
+    for (usize __sl = 0; __sl < __sn; __sl = __se) {                        \
+      __s_run(__sp, __sl, __sn, less, __se);                                \
+      if (__se - __sl < __minrun && __se < __sn) {                          \
+        usize __sx = __sl + __minrun < __sn ? __sl + __minrun : __sn;       \
+        __s_insertion_binary(__sp, __sl, __se, __sx, less);                 \
+        __se = __sx;                                                        \
+      }                                                                     \
+      if (__top > 0) {                                                      \
+        int __sw = __s_power(__base[__top - 1], __len[__top - 1], __se - __sl, __sn); \
+        while (__top > 1 && __pow[__top - 2] > __sw) {                      \
+          usize __sb = __base[__top - 2], __sm = __sb + __len[__top - 2];   \
+          __s_merge(__sp, __sb, __sm, __sm + __len[__top - 1], __st, less); \
+          __len[__top - 2] += __len[__top - 1];                             \
+          __top--;                                                          \
+        }                                                                   \
+        __pow[__top - 1] = __sw;                                            \
+      }                                                                     \
+      __base[__top] = __sl;                                                 \
+      __len[__top] = __se - __sl;                                           \
+      __top++;                                                              \
+    }                                                                       \
+    for (; __top > 1; __top--) {                                            \
+      usize __sb = __base[__top - 2], __sm = __sb + __len[__top - 2];       \
+      __s_merge(__sp, __sb, __sm, __sm + __len[__top - 1], __st, less);     \
+      __len[__top - 2] += __len[__top - 1];                                 \
+    }                                                                       \
+  } while (0)
+
+
+#endif // STD_SORT_H
@@ -0,0 +1,206 @@
+#ifndef STD_SPAN_H
+#define STD_SPAN_H
+
+#include "types.h"
+#include "vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+span.h - non-owning view of a range of elements in C
+
+span(T) - the type of a span. Until C23, typedef this to something before using.
+
+A span is a pointer and a length passed by value: making one, slicing it and handing it
+to another function never allocates or copies elements. It doesn't own the elements, so
+it must not outlive the container it views, and growing a vec can move its data out from
+under a span of it.
+
+** Construction **
+span_init(s, p, n)                  -- view n elements at pointer p
+span_of(s, v)                       -- view every element of a vec, array or svec v
+span_from(s, v, i, n)               -- view n elements of v starting at index i
+span_sub(s, i, n)                   -- span of n elements of s starting at index i
+span_take(s, n)                     -- span of the first n elements of s
+span_drop(s, n)                     -- span of s without its first n elements
+
+** Properties **
+span_len(s)                         -- number of elements
+span_is_empty(s)                    -- is the span empty?
+span_at(s, i)                       -- return value at index i
+span_first(s)                       -- get first element
+span_last(s)                        -- get last element
+
+** Operations **
+span_fill(s, val)                   -- write val to every element
+span_copy(dst, src)                 -- copy the elements of src over dst, as many as fit
+span_swap(s, i, j)                  -- swap 2 values
+span_sort(s, fn)                    -- qsort in-place
+span_reverse(s)                     -- reverse elements in-place
+span_find(s, val, i)                -- stores index of val in i, or -1
+
+** Sorted spans **
+span_lower_bound(s, val, i)         -- stores index of first element not less than val in i
+span_upper_bound(s, val, i)         -- stores index of first element greater than val in i
+span_bsearch(s, val, i)             -- stores index of val in i, or -1
+
+** Iteration **
+span_iter(s, t)                     -- stores each value in t
+span_enum(s, i, t)                  -- enumerate: stores each index in i and each value in t
+
+span_sub, span_take and span_drop are expressions of the same span type, so stages of a
+pipeline can cut a buffer up as they go (s = span_drop(s, used)). A span has data and
+len fields like the containers do, so &s can be passed to the vec searches and to the
+par.h algorithms.
+
+*/
+
+#define span(T)       \
+  struct {            \
+    T* data;          \
+    usize len;        \
+  }                   \
+
+
+// predefined types
+
+typedef span(int)    span_int;
+typedef span(char)   span_char;
+typedef span(u8)     span_u8;
+typedef span(float)  span_float;
+typedef span(double) span_double;
+
+
+// view n elements at pointer p
+#define span_init(s, p, n) \
+  ((s).data = (p), (s).len = (n))
+
+
+// view every element of a vec, array or svec v
+#define span_of(s, v) \
+  span_init(s, (v)->data, (v)->len)
+
+
+// view n elements of v starting at index i
+#define span_from(s, v, i, n) \
+  span_init(s, (v)->data + (i), (n))
+
+
+// span of n elements of s starting at index i
+#define span_sub(s, i, n) \
+  ((__typeof__(s)) { (s).data + (i), (n) })
+
+
+// span of the first n elements of s
+#define span_take(s, n) \
+  span_sub(s, 0, n)
+
+
+// span of s without its first n elements
+#define span_drop(s, n) \
+  span_sub(s, n, (s).len - (n))
+
+
+// number of elements
+#define span_len(s) \
+  ((s).len)
+
+
+// is the span empty?
+#define span_is_empty(s) \
+  ((s).len == 0)
+
+
+// return value at index i
+#define span_at(s, i) \
+  ((s).data[i])
+
+
+// get first element
+#define span_first(s) \
+  ((s).data[0])
+
+
+// get last element
+#define span_last(s) \
+  ((s).data[(s).len - 1])
+
+
+// write val to every element
+#define span_fill(s, val)                                             \
+  do {                                                                \
+    __typeof__(*(s).data) __fv = (val);                               \
+    for (usize __i = 0; __i < (s).len; __i++) {                       \
+      (s).data[__i] = __fv;                                           \
+    }                                                                 \
+  } while (0)
+
+
+// copy the elements of src over dst, as many as fit
+#define span_copy(dst, src)                                           \
+  ((void) sizeof(*(dst).data = *(src).data),                          \
+   memmove((dst).data, (src).data,                                    \
+           ((dst).len < (src).len ? (dst).len : (src).len) * sizeof(*(dst).data)))
+
+
+// swap 2 values
+#define span_swap(s, i, j)                                            \
+  do {                                                                \
+    __typeof__(*(s).data) __sw = (s).data[i];                         \
+    (s).data[i] = (s).data[j];                                        \
+    (s).data[j] = __sw;                                               \
+  } while (0)
+
+
+// qsort in-place
+#define span_sort(s, fn) \
+  qsort((s).data, (s).len, sizeof(*(s).data), fn)
+
+
+// reverse elements in-place
+#define span_reverse(s)                                               \
+  do {                                                                \
+    usize __lo = 0, __hi = (s).len;                                   \
+    while (__hi > __lo + 1) {                                         \
+      __hi--;                                                         \
+      span_swap(s, __lo, __hi);                                       \
+      __lo++;                                                         \
+    }                                                                 \
+  } while (0)
+
+
+// stores index of val in i, or -1
+#define span_find(s, val, i) \
+  vec_find(&(s), val, i)
+
+
+// stores index of first element not less than val in i
+#define span_lower_bound(s, val, i) \
+  vec_lower_bound(&(s), val, i)
+
+
+// stores index of first element greater than val in i
+#define span_upper_bound(s, val, i) \
+  vec_upper_bound(&(s), val, i)
+
+
+// stores index of val in i, or -1
+#define span_bsearch(s, val, i) \
+  vec_bsearch(&(s), val, i)
+
+
+// stores each value in t
+#define span_iter(s, t)                                                       \
+  if ((s).len > 0)                                                            \
+  for (usize __i = 0; __i < (s).len && (((t) = (s).data[__i]), 1); ++__i)     \
+
+
+// enumerate: stores each index in i and each value in t
+#define span_enum(s, i, t)                                                    \
+  if ((s).len > 0)                                                            \
+  for ((i) = 0; (i) < (s).len && (((t) = (s).data[(i)]), 1); ++(i))           \
+
+
+#endif // STD_SPAN_H
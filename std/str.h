@@ -7,7 +7,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "array.h"
+#include "pool.h"
 #include "types.h"
 
 // str.h - string library in C
@@ -21,6 +23,7 @@
 typedef struct __str {
     char* chars;
     usize len;
+    STD_ALLOC_FIELD
 }* str;
 
 // c-string type
@@ -44,6 +47,12 @@ void        str_print(str s);                       // str("my contents")\n
 str         str_format(c_str fmt, ...);             // sprintf into a string
 c_str       str_format_c(c_str fmt, ...);           // sprintf into a c-string
 
+#ifdef STD_USE_ALLOCATOR
+str         str_new_with(allocator* a);             // empty string using allocator a
+str         str_alloc_with(usize n, allocator* a);  // allocate n bytes using allocator a
+str         str_from_with(c_str cs, allocator* a);  // deep copy c-string using allocator a
+#endif
+
 /*
 
 Generic methods
@@ -339,48 +348,136 @@ STD_STR_DECL str __srepch(char, usize);
 // DEFINITIONS
 
 
+#ifdef STD_USE_POOL
+
+// headers of heap-allocated strings come from one pool shared by every thread, each
+// going through its own cache, so a str can be freed on another thread than the one
+// that made it; a thread's cache goes back to the pool when the thread exits
+pool __str_pool = null;
+_Thread_local pool_cache __str_cache;
+pthread_once_t __str_pool_once = PTHREAD_ONCE_INIT;
+pthread_key_t __str_pool_key;
+
+void __str_cache_exit(void* c) {
+    pool_cache_flush((pool_cache*) c);
+}
+
+void __str_pool_init() {
+    __str_pool = pool_new(sizeof(struct __str));
+    pthread_key_create(&__str_pool_key, __str_cache_exit);
+}
+
+// this thread's cache, set up on first use
+pool_cache* __str_cache_get() {
+    if (__str_cache.p == null) {
+        pthread_once(&__str_pool_once, __str_pool_init);
+        __str_cache = pool_cache_new(__str_pool);
+        pthread_setspecific(__str_pool_key, &__str_cache);
+    }
+    return &__str_cache;
+}
+
+void* __str_header_new(STD_ALLOC_PARAM usize size) {
+#ifdef STD_USE_ALLOCATOR
+    if (alloc != &std_allocator_heap) return std_malloc(alloc, size);
+#endif
+    (void) size;
+    return pool_cache_alloc(__str_cache_get());
+}
+
+void __str_header_free(STD_ALLOC_PARAM void* s, usize size) {
+#ifdef STD_USE_ALLOCATOR
+    if (alloc != &std_allocator_heap) {
+        std_free(alloc, s, size);
+        return;
+    }
+#endif
+    (void) size;
+    pool_cache_release(__str_cache_get(), s);
+}
+
+#else
+
+void* __str_header_new(STD_ALLOC_PARAM usize size) {
+    return std_malloc(alloc, size);
+}
+
+void __str_header_free(STD_ALLOC_PARAM void* s, usize size) {
+    (void) size;
+    std_free(alloc, s, size);
+}
+
+#endif // STD_USE_POOL
+
+// allocate n bytes from an allocator, zero out, null if either allocation fails
+str __str_alloc(STD_ALLOC_PARAM usize n) {
+    str s = (str) __str_header_new(STD_ALLOC_FWD sizeof(struct __str));
+    if (s == null) return null;
+    s->chars = (char*) std_calloc(alloc, n + 1, sizeof(char));
+    if (s->chars == null) {
+        __str_header_free(STD_ALLOC_FWD s, sizeof(struct __str));
+        return null;
+    }
+    s->len = n;
+    std_alloc_init(s, alloc);
+    return s;
+}
+
 // empty string
 str str_new() {
-    str s = (str) calloc(1, sizeof(struct __str));
-    s->chars = (char*) calloc(1, sizeof(char));
-    return s;
+    return __str_alloc(STD_ALLOC_DEFAULT 0);
 }
 
 // allocate n bytes, zero out
 str str_alloc(usize n) {
-    str s = (str) calloc(1, sizeof(struct __str));
-    s->chars = (char*) calloc(n + 1, sizeof(char));
-    s->len = n;
-    return s;
+    return __str_alloc(STD_ALLOC_DEFAULT n);
 }
 
 // free memory
 void str_free(str s) {
-    free(s->chars);
+    std_free(s->alloc, s->chars, s->len + 1);
     s->chars = null;
     s->len = 0;
-    free(s);
+    __str_header_free(STD_ALLOC_ARG(s) s, sizeof(struct __str));
 }
 
 // deep copy c-string
 str str_from(c_str cs) {
     usize len = strlen(cs);
-    str s = (str) calloc(1, sizeof(struct __str));
-    s->chars = (char*) calloc(len + 1, sizeof(char));
-    s->len = len;
+    str s = __str_alloc(STD_ALLOC_DEFAULT len);
     memcpy(s->chars, cs, len);
     return s;
 }
 
 // deep copy string
 str str_copy(str s) {
-    str s2 = (str) calloc(1, sizeof(struct __str));
-    s2->chars = (char*) calloc(s->len + 1, sizeof(char));
-    s2->len = s->len;
+    str s2 = __str_alloc(STD_ALLOC_DEFAULT s->len);
     memcpy(s2->chars, s->chars, s->len);
     return s2;
 }
 
+#ifdef STD_USE_ALLOCATOR
+
+// empty string using allocator a
+str str_new_with(allocator* a) {
+    return __str_alloc(a, 0);
+}
+
+// allocate n bytes using allocator a
+str str_alloc_with(usize n, allocator* a) {
+    return __str_alloc(a, n);
+}
+
+// deep copy c-string using allocator a
+str str_from_with(c_str cs, allocator* a) {
+    usize len = strlen(cs);
+    str s = __str_alloc(a, len);
+    memcpy(s->chars, cs, len);
+    return s;
+}
+
+#endif // STD_USE_ALLOCATOR
+
 // returns pointer to self.chars
 c_str str_chars(str s) {
     return s->chars;
@@ -403,7 +500,7 @@ void str_remove(str s, usize i, usize n) {
         end = s->len - 1;
     }
     usize new_len = s->len - n;
-    s->chars = (char*)realloc(s->chars, (new_len + 1) * sizeof(char));
+    s->chars = (char*) std_realloc(s->alloc, s->chars, s->len + 1, (new_len + 1) * sizeof(char));
     memmove(s->chars + i, s->chars + end + 1, s->len - end);
     s->len = new_len;
 }
@@ -631,20 +728,20 @@ str __sslc(c_str cs, isize start, isize stop) {
 }
 
 void __saps(str a, str b) {
-    a->chars = (char*) realloc(a->chars, (a->len + b->len + 1) * sizeof(char));
+    a->chars = (char*) std_realloc(a->alloc, a->chars, a->len + 1, (a->len + b->len + 1) * sizeof(char));
     memcpy(a->chars + a->len, b->chars, b->len + 1);
     a->len += b->len;
 }
 
 void __sapc(str s, c_str cs) {
     usize cs_len = strlen(cs);
-    s->chars = (char*) realloc(s->chars, (s->len + cs_len + 1) * sizeof(char));
+    s->chars = (char*) std_realloc(s->alloc, s->chars, s->len + 1, (s->len + cs_len + 1) * sizeof(char));
     memcpy(s->chars + s->len, cs, cs_len + 1);
     s->len += cs_len;
 }
 
 void __sapch(str s, char c) {
-    s->chars = (char*) realloc(s->chars, (s->len + 2) * sizeof(char));
+    s->chars = (char*) std_realloc(s->alloc, s->chars, s->len + 1, (s->len + 2) * sizeof(char));
     s->chars[s->len] = c;
     s->chars[s->len + 1] = '\0';
     s->len++;
@@ -652,7 +749,7 @@ void __sapch(str s, char c) {
 
 void __sprs(str a, str b) {
     usize new_len = a->len + b->len;
-    a->chars = (char*) realloc(a->chars, (new_len + 1) * sizeof(char));
+    a->chars = (char*) std_realloc(a->alloc, a->chars, a->len + 1, (new_len + 1) * sizeof(char));
     memmove(a->chars + b->len, a->chars, a->len + 1);
     memcpy(a->chars, b->chars, b->len);
     a->len = new_len;
@@ -660,14 +757,14 @@ void __sprs(str a, str b) {
 
 void __sprc(str s, c_str cs) {
     usize cs_len = strlen(cs);
-    s->chars = (char*) realloc(s->chars, (s->len + cs_len + 1) * sizeof(char));
+    s->chars = (char*) std_realloc(s->alloc, s->chars, s->len + 1, (s->len + cs_len + 1) * sizeof(char));
     memmove(s->chars + cs_len, s->chars, s->len + 1);
     memcpy(s->chars, cs, cs_len);
     s->len += cs_len;
 }
 
 void __sprch(str s, char c) {
-    s->chars = (char*) realloc(s->chars, (s->len + 2) * sizeof(char));
+    s->chars = (char*) std_realloc(s->alloc, s->chars, s->len + 1, (s->len + 2) * sizeof(char));
     memmove(s->chars + 1, s->chars, s->len + 1);
     s->chars[0] = c;
     s->len++;
@@ -675,11 +772,11 @@ void __sprch(str s, char c) {
 
 void __sinss(str big, str small, usize i) {
     if (i > big->len) {
-        big->chars = (char*) realloc(big->chars, (big->len + small->len + 1) * sizeof(char));
+        big->chars = (char*) std_realloc(big->alloc, big->chars, big->len + 1, (big->len + small->len + 1) * sizeof(char));
         strcat(big->chars, small->chars);
         big->len = big->len + small->len;
     } else {
-        big->chars = (char*) realloc(big->chars, (big->len + small->len + 1) * sizeof(char));
+        big->chars = (char*) std_realloc(big->alloc, big->chars, big->len + 1, (big->len + small->len + 1) * sizeof(char));
         memmove(big->chars + i + small->len, big->chars + i, big->len - i + 1);
         memcpy(big->chars + i, small->chars, small->len);
         big->len = big->len + small->len;
@@ -688,7 +785,7 @@ void __sinss(str big, str small, usize i) {
 
 void __sinsc(str s, c_str cs, usize i) {
     usize cs_len = strlen(cs);
-    s->chars = (char*) realloc(s->chars, (s->len + cs_len + 1) * sizeof(char));
+    s->chars = (char*) std_realloc(s->alloc, s->chars, s->len + 1, (s->len + cs_len + 1) * sizeof(char));
     if (i > s->len) {
         strcat(s->chars, cs);
     } else {
@@ -699,7 +796,7 @@ void __sinsc(str s, c_str cs, usize i) {
 }
 
 void __sinsch(str s, char c, usize i) {
-    s->chars = (char*) realloc(s->chars, (s->len + 2) * sizeof(char));
+    s->chars = (char*) std_realloc(s->alloc, s->chars, s->len + 1, (s->len + 2) * sizeof(char));
     if (i > s->len) {
         s->chars[s->len] = c;
         s->chars[s->len + 1] = '\0';
@@ -730,12 +827,12 @@ array_str __ssplss(str s, str delim) {
     token = strstr(cs, delim->chars);
     while (token != null) {
         *token = '\0';
-        result = (char**) realloc(result, sizeof(char *) * (count + 1));
+        result = (char**) std_realloc(s_copy->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 1));
         result[count++] = cs;
         cs = token + delim->len;
         token = strstr(cs, delim->chars);
     }
-    result = (char**) realloc(result, sizeof(char *) * (count + 2));
+    result = (char**) std_realloc(s_copy->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 2));
     result[count++] = cs;
     result[count] = null;
     array_str a;
@@ -743,6 +840,7 @@ array_str __ssplss(str s, str delim) {
     for(usize i = 0; i < count; i++) {
         array_write(a, i, str_from(result[i]));
     }
+    std_free(s_copy->alloc, result, sizeof(char *) * (count + 1));
     str_free(s_copy);
     return a;
 }
@@ -767,12 +865,12 @@ array_str __ssplsc(str s, c_str delim) {
     token = strstr(cs, delim);
     while (token != null) {
         *token = '\0';
-        result = (char**) realloc(result, sizeof(char *) * (count + 1));
+        result = (char**) std_realloc(s_copy->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 1));
         result[count++] = cs;
         cs = token + delim_len;
         token = strstr(cs, delim);
     }
-    result = (char**) realloc(result, sizeof(char *) * (count + 2));
+    result = (char**) std_realloc(s_copy->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 2));
     result[count++] = cs;
     result[count] = null;
     array_str a;
@@ -780,6 +878,7 @@ array_str __ssplsc(str s, c_str delim) {
     for(usize i = 0; i < count; i++) {
         array_write(a, i, str_from(result[i]));
     }
+    std_free(s_copy->alloc, result, sizeof(char *) * (count + 1));
     str_free(s_copy);
     return a;
 }
@@ -808,12 +907,12 @@ array_str __ssplcs(c_str cs, str delim) {
     token = strstr(cs_copy, delim->chars);
     while (token != null) {
         *token = '\0';
-        result = (char**) realloc(result, sizeof(char *) * (count + 1));
+        result = (char**) std_realloc(s->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 1));
         result[count++] = cs_copy;
         cs_copy = token + delim->len;
         token = strstr(cs_copy, delim->chars);
     }
-    result = (char**) realloc(result, sizeof(char *) * (count + 2));
+    result = (char**) std_realloc(s->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 2));
     result[count++] = cs_copy;
     result[count] = null;
     array_str a;
@@ -821,6 +920,7 @@ array_str __ssplcs(c_str cs, str delim) {
     for(usize i = 0; i < count; i++) {
         array_write(a, i, str_from(result[i]));
     }
+    std_free(s->alloc, result, sizeof(char *) * (count + 1));
     str_free(s);
     return a;
 }
@@ -845,19 +945,20 @@ array_str __ssplcc(c_str cs, c_str delim) {
     token = strstr(cs_copy, delim);
     while (token != null) {
         *token = '\0';
-        result = (char**) realloc(result, sizeof(char *) * (count + 1));
+        result = (char**) std_realloc(s->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 1));
         result[count++] = cs_copy;
         cs_copy = token + delim_len;
         token = strstr(cs_copy, delim);
     }
-    result = (char**) realloc(result, sizeof(char *) * (count + 2));
-    result[count++] = cs;
+    result = (char**) std_realloc(s->alloc, result, sizeof(char *) * count, sizeof(char *) * (count + 2));
+    result[count++] = cs_copy;
     result[count] = null;
     array_str a;
     array_init(a, count);
     for(usize i = 0; i < count; i++) {
         array_write(a, i, str_from(result[i]));
     }
+    std_free(s->alloc, result, sizeof(char *) * (count + 1));
     str_free(s);
     return a;
 }
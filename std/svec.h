@@ -0,0 +1,288 @@
+#ifndef STD_SVEC_H
+#define STD_SVEC_H
+
+#include "alloc.h"
+#include "types.h"
+#include "vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+svec.h - small vector: a vec with inline storage for the first N elements
+
+svec(T, N) - the type of a small vector. Until C23, typedef this to something before using.
+
+The header and the first N elements live in a single allocation, so a small vector
+costs one malloc and no pointer chase until it grows past N elements, at which point
+the data spills to the heap and it behaves like a normal vec.
+
+An svec starts with the same fields as a vec (data, len, cap), so every vec macro
+that doesn't allocate or free also works on an svec. The aliases below are there
+so code can stick to one prefix.
+
+** Memory management **
+svec_init(v)                        -- initialize small vector
+svec_init_with(v, a)                -- initialize small vector using allocator a (STD_USE_ALLOCATOR only)
+svec_free(v)                        -- free all memory
+svec_reserve(v, n)                  -- reserve size for n elements
+svec_truncate(v, n)                 -- reduce to just the first n elements
+svec_compact(v)                     -- compact down to minimum size, moving back inline if it fits
+svec_clear(v)                       -- len = 0
+svec_is_inline(v)                   -- are the elements still stored inline?
+
+** Properties **
+svec_len(v)                         -- the length of the vector
+svec_is_empty(v)                    -- is the vector empty?
+svec_at(v, i)                       -- return value at index i
+svec_find(v, val, i)                -- stores index of val in i
+svec_first(v)                       -- get first element
+svec_last(v)                        -- get last element
+
+** Operations **
+svec_push(v, val)                   -- pushes a value onto vector
+svec_pop(v)                         -- pops an element off and returns it
+svec_insert(v, i, val)              -- insert a value at index i
+svec_remove(v, val)                 -- remove first occurrence of val
+svec_swap(v, i, j)                  -- swap 2 values
+svec_extend(v, v2)                  -- push all elements from another vector
+svec_extend_from(v, b, n)           -- push n elements from buffer b
+svec_insert_n(v, i, b, n)           -- insert n elements from buffer b at index i
+svec_remove_all(v, val)             -- remove every occurrence of val
+svec_retain(v, pred)                -- keep only the elements where pred(elem) is true, in order
+svec_filter(v, pred)                -- same as svec_retain
+svec_sort(v, fn)                    -- qsort in-place
+svec_reverse(v)                     -- reverse elements in-place
+svec_rotate(v, k)                   -- rotate left by k, element k comes first
+svec_swap_ranges(v, i, j, n)        -- swap n elements at i with n elements at j (not overlapping)
+svec_scatter(dst, src, idx)         -- dst[idx[i]] = src[i] for every element of src
+svec_splice(v, i, n)                -- remove n elements starting at index i
+svec_swapsplice(v, i, n)            -- and replace with last n elements
+
+** Iteration **
+svec_iter(v, t)                     -- stores each value in t
+svec_enum(v, i, t)                  -- enumerate: stores each index in i and each value in t
+
+*/
+
+#define svec(T, N)    \
+  struct {            \
+    T* data;          \
+    usize len;        \
+    usize cap;        \
+    STD_ALLOC_FIELD   \
+    T buf[N];         \
+  }*                  \
+
+
+// predefined types
+
+typedef svec(int, 8)    svec_int;
+typedef svec(char, 16)  svec_char;
+typedef svec(float, 8)  svec_float;
+typedef svec(double, 8) svec_double;
+
+
+#define __sv_unpack(v) \
+  __v_unpack(v), (void*)(v)->buf
+
+
+// number of inline elements
+#define __sv_n(v) \
+  (sizeof((v)->buf) / sizeof(*(v)->buf))
+
+
+// initialize small vector
+#define svec_init(v) \
+  __sv_init_with(v, std_allocator_get())
+
+
+#ifdef STD_USE_ALLOCATOR
+// initialize small vector using allocator a
+#define svec_init_with(v, a) \
+  __sv_init_with(v, a)
+#endif
+
+
+#define __sv_init_with(v, a)                      \
+  do {                                            \
+    (v) = std_calloc((a), 1, sizeof(*(v)));       \
+    if ((v) != null) {                            \
+      std_alloc_init((v), (a));                   \
+      (v)->data = (v)->buf;                       \
+      (v)->cap = __sv_n(v);                       \
+    }                                             \
+  } while(0)
+
+
+// free all memory
+#define svec_free(v)                                                          \
+  do {                                                                        \
+    if ((v)->data != (v)->buf) {                                              \
+      std_free((v)->alloc, (v)->data, (v)->cap * sizeof(*(v)->data));         \
+    }                                                                         \
+    std_free((v)->alloc, (v), sizeof(*(v)));                                  \
+  } while(0)
+
+
+// reserve size for n elements
+#define svec_reserve(v, n) \
+  __sv_reserve(__sv_unpack(v), n)
+
+
+// reduce to just the first n elements
+#define svec_truncate(v, n) \
+  vec_truncate(v, n)
+
+
+// compact down to minimum size, moving back inline if it fits
+#define svec_compact(v) \
+  __sv_compact(__sv_unpack(v), __sv_n(v))
+
+
+// len = 0
+#define svec_clear(v) \
+  vec_clear(v)
+
+
+// are the elements still stored inline?
+#define svec_is_inline(v) \
+  ((v)->data == (v)->buf)
+
+
+#define svec_len(v)                 vec_len(v)
+#define svec_is_empty(v)            vec_is_empty(v)
+#define svec_at(v, i)               vec_at(v, i)
+#define svec_find(v, val, i)        vec_find(v, val, i)
+#define svec_first(v)               vec_first(v)
+#define svec_last(v)                vec_last(v)
+
+
+// pushes a value onto vector
+#define svec_push(v, val) \
+  (__sv_expand(__sv_unpack(v)) ? -1 : ((v)->data[(v)->len++] = (val), 0))
+
+
+// pops an element off and returns it
+#define svec_pop(v) \
+  vec_pop(v)
+
+
+// insert a value at index i
+#define svec_insert(v, i, val) \
+  (__sv_insert(__sv_unpack(v), i) ? -1 : ((v)->data[i] = (val), (v)->len++, 0))
+
+
+// push all elements from another vector
+#define svec_extend(v, v2) \
+  svec_extend_from((v), (v2)->data, (v2)->len)
+
+
+// push n elements from buffer b
+#define svec_extend_from(v, b, n)                                           \
+  do {                                                                      \
+    usize __n = (n);                                                        \
+    __v_check_buf(v, b);                                                    \
+    if (__sv_reserve_grow(__sv_unpack(v), (v)->len + __n) != 0) break;      \
+    memcpy((v)->data + (v)->len, (b), __n * sizeof(*(v)->data));            \
+    (v)->len += __n;                                                        \
+  } while (0)
+
+
+// insert n elements from buffer b at index i
+#define svec_insert_n(v, i, b, n)                                           \
+  (__v_check_buf(v, b),                                                     \
+   __sv_reserve_grow(__sv_unpack(v), (v)->len + (n)) ? -1 :                 \
+   (memmove((v)->data + (i) + (n), (v)->data + (i),                         \
+            ((v)->len - (i)) * sizeof(*(v)->data)),                         \
+    memcpy((v)->data + (i), (b), (n) * sizeof(*(v)->data)),                 \
+    (v)->len += (n), 0))
+
+
+#define svec_remove(v, val)         vec_remove(v, val)
+#define svec_remove_all(v, val)     vec_remove_all(v, val)
+#define svec_retain(v, pred)        vec_retain(v, pred)
+#define svec_filter(v, pred)        vec_retain(v, pred)
+#define svec_swap(v, i, j)          vec_swap(v, i, j)
+#define svec_sort(v, fn)            vec_sort(v, fn)
+#define svec_reverse(v)             vec_reverse(v)
+#define svec_rotate(v, k)           vec_rotate(v, k)
+#define svec_swap_ranges(v, i, j, n) vec_swap_ranges(v, i, j, n)
+#define svec_scatter(dst, src, idx) vec_scatter(dst, src, idx)
+#define svec_splice(v, i, n)        vec_splice(v, i, n)
+#define svec_swapsplice(v, i, n)    vec_swapsplice(v, i, n)
+#define svec_iter(v, t)             vec_iter(v, t)
+#define svec_enum(v, i, t)          vec_enum(v, i, t)
+
+
+// moves data to a heap buffer of n elements, spilling out of the inline buffer if needed
+int __sv_grow(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, void* buf, usize n) {
+  void* ptr;
+  if (*data == buf) {
+    ptr = std_malloc(alloc, n * memsz);
+    if (ptr == null) return -1;
+    memcpy(ptr, buf, *len * memsz);
+  } else {
+    ptr = std_realloc(alloc, *data, *cap * memsz, n * memsz);
+    if (ptr == null) return -1;
+  }
+  *data = ptr;
+  *cap = n;
+  return 0;
+}
+
+
+int __sv_expand(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, void* buf) {
+  if (*len + 1 > *cap) {
+    return __sv_grow(STD_ALLOC_FWD data, len, cap, memsz, buf, *cap << 1);
+  }
+  return 0;
+}
+
+
+int __sv_reserve(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, void* buf, usize n) {
+  if (n > *cap) {
+    return __sv_grow(STD_ALLOC_FWD data, len, cap, memsz, buf, n);
+  }
+  return 0;
+}
+
+
+// room for n elements, doubling the capacity until it fits like the one element push
+int __sv_reserve_grow(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, void* buf, usize n) {
+  if (n <= *cap) return 0;
+  usize c = *cap ? *cap : 1;
+  while (c < n) c <<= 1;
+  return __sv_grow(STD_ALLOC_FWD data, len, cap, memsz, buf, c);
+}
+
+
+int __sv_compact(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, void* buf, usize n) {
+  if (*data == buf) return 0;
+  if (*len <= n) {
+    memcpy(buf, *data, *len * memsz);
+    std_free(alloc, *data, *cap * memsz);
+    *data = buf;
+    *cap = n;
+    return 0;
+  }
+  void* ptr = std_realloc(alloc, *data, *cap * memsz, *len * memsz);
+  if (ptr == null) return -1;
+  *data = ptr;
+  *cap = *len;
+  return 0;
+}
+
+
+int __sv_insert(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, void* buf, usize idx) {
+  int err = __sv_expand(STD_ALLOC_FWD data, len, cap, memsz, buf);
+  if (err) return err;
+  memmove(((char*)(*data)) + (idx + 1) * memsz,
+          ((char*)(*data)) + idx * memsz,
+          (*len - idx) * memsz);
+  return 0;
+}
+
+
+#endif // STD_SVEC_H
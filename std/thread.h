@@ -0,0 +1,492 @@
+#ifndef STD_THREAD_H
+#define STD_THREAD_H
+
+#include "alloc.h"
+#include "queue.h"
+#include "types.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// thread.h - work-stealing thread pool
+// (per-worker Chase-Lev deques, task groups to wait on, parallel for)
+
+// Types
+
+// a set of tasks to wait for, zero-initialize it (task_group g = {0};)
+typedef struct {
+    atomic_uint pending;    // tasks spawned and not finished, plus __TP_SLEEPING, the futex word waiters sleep on
+} task_group;
+
+// set in pending while a thread sleeps in thread_wait, so the last task knows to wake it
+#define __TP_SLEEPING 0x80000000u
+
+// a task: fn(ctx), counted in group
+typedef struct {
+    void (*fn)(void*);
+    void* ctx;
+    task_group* group;
+} __tp_task;
+
+// deque slot, written by the owner and read by thieves
+typedef struct {
+    _Atomic(void*) fn;
+    _Atomic(void*) ctx;
+    _Atomic(void*) group;
+} __tp_slot;
+
+// tasks a worker's deque holds, spawning more runs them on the spot
+#define STD_THREAD_DEQUE 1024
+
+// tasks the pool's queue for spawns from outside threads holds
+#define STD_THREAD_INJECT 4096
+
+// failed rounds of looking for work (half pausing, half yielding) before a worker parks
+#define STD_THREAD_SPIN 64
+
+// threads of thread_default() including the thread using it, 0 for one per online cpu
+#ifndef STD_THREAD_THREADS
+#define STD_THREAD_THREADS 0
+#endif
+
+// a worker and its Chase-Lev deque: the owner pushes and takes at bottom, thieves steal at top
+typedef struct {
+    alignas(STD_QUEUE_LINE) _Atomic isize top;
+    alignas(STD_QUEUE_LINE) _Atomic isize bottom;
+    alignas(STD_QUEUE_LINE) __tp_slot slots[STD_THREAD_DEQUE];
+    pthread_t thread;
+    atomic_int tid;         // kernel thread id for setting affinity, 0 until the worker is running
+    u64 rng;                // picks where to start stealing
+    struct __thread_pool* pool;
+    usize index;
+} __tp_worker;
+
+typedef mpmc(__tp_task) __tp_inject;
+
+// thread pool type
+typedef struct __thread_pool {
+    __tp_worker* workers;
+    usize nworkers;
+    __tp_inject inject;     // spawns from threads that aren't workers
+    atomic_uint epoch;      // futex word parked workers sleep on, bumped to wake them
+    atomic_uint sleepers;
+    atomic_int stop;
+    void* mem;              // what workers was carved out of
+    usize memsz;
+    STD_ALLOC_FIELD
+}* thread_pool;
+
+// Methods
+
+thread_pool thread_pool_new(usize nworkers);            // start nworkers workers, 0 for one less than the online cpus
+void        thread_pool_free(thread_pool p);            // stop and join the workers, no tasks may be pending
+usize       thread_pool_size(thread_pool p);            // number of worker threads
+int         thread_pool_pin(thread_pool p, const int* cpus, usize n);  // pin worker i to cpus[i % n], 0 or -1 with errno
+thread_pool thread_default();                           // shared pool, started on first use, null if it could not be
+
+void        thread_spawn(thread_pool p, task_group* g, void (*fn)(void*), void* ctx);  // run fn(ctx) on the pool as part of g
+void        thread_wait(thread_pool p, task_group* g);  // run tasks until every task of g has finished
+void        thread_parallel_for(thread_pool p, usize n, usize grain,
+                                void (*fn)(void* ctx, usize begin, usize end), void* ctx);  // fn over chunks of [0, n)
+void        thread_parallel_for_static(thread_pool p, usize n, usize grain,
+                                       void (*fn)(void* ctx, usize begin, usize end), void* ctx);  // same, chunk c on thread c % (size + 1)
+
+/*
+
+Each worker owns a deque of tasks. Spawning from a worker pushes onto its own deque,
+and the worker pops from the same end, newest first, so nested work stays in its cache.
+Idle workers steal the oldest task from the other end of a random victim's deque.
+Spawns from other threads go through a shared lock-free queue (mpmc from queue.h). A
+full deque or queue doesn't fail a spawn, the task just runs on the spawning thread.
+
+thread_wait doesn't just block: the waiting thread runs tasks itself (its own first if
+it's a worker, then stolen ones) until the group is done, so tasks can spawn and wait
+on nested groups without tying up workers. It only sleeps when there's nothing left
+to take and the group's tasks are running elsewhere.
+
+A worker with nothing to do retries STD_THREAD_SPIN times, then parks on a futex.
+Spawning only makes the wake syscall when a worker is parked, so a busy pool never
+enters the kernel.
+
+thread_parallel_for calls fn(ctx, begin, end) on chunks of grain indices: the calling
+thread and up to one helper task per worker pull chunks off a shared counter, so
+uneven chunks balance out. Every chunk starts at a multiple of grain.
+
+thread_parallel_for_static hands out the same chunks by a fixed rule instead: thread t
+of the size + 1 (the calling thread is 0, worker i is i + 1) runs chunks t, t + size + 1,
+and so on. Two calls over the same n and grain then put each chunk on the same thread,
+so memory one faults in is local to the thread the other works on, which is what
+first-touch NUMA placement needs (pin the workers with thread_pool_pin so they stay on
+their node). A thread that picks up a second helper task runs the first chunks nobody
+has claimed, so a pool busy with other work still finishes, just without the rule.
+
+*/
+
+
+// DEFINITIONS
+
+
+// the worker the current thread is, null on other threads
+_Thread_local __tp_worker* __tp_self = null;
+
+
+// owner: push a task at bottom, false if the deque is full
+bool __tp_push(__tp_worker* w, __tp_task t) {
+    isize b = atomic_load_explicit(&w->bottom, memory_order_relaxed);
+    isize top = atomic_load_explicit(&w->top, memory_order_acquire);
+    if (b - top >= STD_THREAD_DEQUE) return false;
+    __tp_slot* s = &w->slots[b & (STD_THREAD_DEQUE - 1)];
+    atomic_store_explicit(&s->fn, (void*) t.fn, memory_order_relaxed);
+    atomic_store_explicit(&s->ctx, t.ctx, memory_order_relaxed);
+    atomic_store_explicit(&s->group, (void*) t.group, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    return true;
+}
+
+__tp_task __tp_read(__tp_slot* s) {
+    __tp_task t;
+    t.fn = (void (*)(void*)) atomic_load_explicit(&s->fn, memory_order_relaxed);
+    t.ctx = atomic_load_explicit(&s->ctx, memory_order_relaxed);
+    t.group = atomic_load_explicit(&s->group, memory_order_relaxed);
+    return t;
+}
+
+// owner: take the newest task from bottom
+bool __tp_take(__tp_worker* w, __tp_task* t) {
+    isize b = atomic_load_explicit(&w->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&w->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    isize top = atomic_load_explicit(&w->top, memory_order_relaxed);
+    if (top > b) {
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+        return false;
+    }
+    *t = __tp_read(&w->slots[b & (STD_THREAD_DEQUE - 1)]);
+    if (top == b) {
+        // the last task, race the thieves for it
+        bool won = atomic_compare_exchange_strong_explicit(&w->top, &top, top + 1,
+                                                           memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+// thief: steal the oldest task from top
+bool __tp_steal(__tp_worker* w, __tp_task* t) {
+    isize top = atomic_load_explicit(&w->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    isize b = atomic_load_explicit(&w->bottom, memory_order_acquire);
+    if (top >= b) return false;
+    *t = __tp_read(&w->slots[top & (STD_THREAD_DEQUE - 1)]);
+    return atomic_compare_exchange_strong_explicit(&w->top, &top, top + 1,
+                                                   memory_order_seq_cst, memory_order_relaxed);
+}
+
+// any task to run: our own newest, then the outside queue, then stolen from a random worker
+bool __tp_find(thread_pool p, __tp_worker* self, __tp_task* t) {
+    if (self != null && __tp_take(self, t)) return true;
+    if (mpmc_try_pop(p->inject, *t) == 0) return true;
+    if (p->nworkers == 0) return false;
+    usize start = 0;
+    if (self != null) {
+        self->rng ^= self->rng << 13;
+        self->rng ^= self->rng >> 7;
+        self->rng ^= self->rng << 17;
+        start = self->rng % p->nworkers;
+    }
+    for (usize i = 0; i < p->nworkers; i++) {
+        __tp_worker* v = &p->workers[(start + i) % p->nworkers];
+        if (v != self && __tp_steal(v, t)) return true;
+    }
+    return false;
+}
+
+void __tp_run(__tp_task t) {
+    t.fn(t.ctx);
+    // g may be gone as soon as the count reaches 0, so whether to wake comes from the same atomic
+    task_group* g = t.group;
+    if (atomic_fetch_sub_explicit(&g->pending, 1, memory_order_acq_rel) == (__TP_SLEEPING | 1)) {
+        __q_futex_wake(&g->pending, INT_MAX);
+    }
+}
+
+void __tp_wake(thread_pool p) {
+    // pairs with the fence in __tp_worker_main: either we see the sleeper or it sees the task
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&p->sleepers, memory_order_relaxed) == 0) return;
+    atomic_fetch_add_explicit(&p->epoch, 1, memory_order_relaxed);
+    __q_futex_wake(&p->epoch, 1);
+}
+
+void* __tp_worker_main(void* arg) {
+    __tp_worker* self = arg;
+    thread_pool p = self->pool;
+    __tp_self = self;
+#ifdef __linux__
+    atomic_store_explicit(&self->tid, (int) syscall(SYS_gettid), memory_order_release);
+#endif
+    __tp_task t;
+    for (;;) {
+        int idle = 0;
+        while (!__tp_find(p, self, &t)) {
+            if (atomic_load_explicit(&p->stop, memory_order_acquire)) return null;
+            if (++idle < STD_THREAD_SPIN / 2) {
+                __q_pause();
+            } else if (idle < STD_THREAD_SPIN) {
+                sched_yield();
+            } else {
+                unsigned seen = atomic_load_explicit(&p->epoch, memory_order_acquire);
+                atomic_fetch_add_explicit(&p->sleepers, 1, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+                // a spawn may have come in before it could see us parking
+                bool found = __tp_find(p, self, &t);
+                if (!found && !atomic_load_explicit(&p->stop, memory_order_acquire)) {
+                    __q_futex_wait(&p->epoch, seen);
+                }
+                atomic_fetch_sub_explicit(&p->sleepers, 1, memory_order_relaxed);
+                if (found) break;
+                idle = 0;
+            }
+        }
+        __tp_run(t);
+    }
+}
+
+// one less than the online cpus, leaving one for the thread handing out work
+usize __tp_auto_size() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 1 ? (usize) cpus - 1 : 0;
+}
+
+thread_pool __thread_pool_new(STD_ALLOC_PARAM usize nworkers) {
+    thread_pool p = (thread_pool) std_calloc(alloc, 1, sizeof(struct __thread_pool));
+    if (p == null) return null;
+    std_alloc_init(p, alloc);
+    p->memsz = nworkers * sizeof(__tp_worker) + STD_QUEUE_LINE;
+    p->mem = std_malloc(alloc, p->memsz);
+    mpmc_init(p->inject, STD_THREAD_INJECT);
+    if (p->mem == null || p->inject == null) {
+        if (p->inject != null) mpmc_free(p->inject);
+        std_free(alloc, p->mem, p->memsz);
+        std_free(alloc, p, sizeof(struct __thread_pool));
+        return null;
+    }
+    p->workers = (__tp_worker*) (((uintptr_t) p->mem + STD_QUEUE_LINE - 1) & ~(uintptr_t) (STD_QUEUE_LINE - 1));
+    memset(p->workers, 0, nworkers * sizeof(__tp_worker));
+    // workers steal from each other right away, so the count is set before any starts
+    p->nworkers = nworkers;
+    for (usize i = 0; i < nworkers; i++) {
+        __tp_worker* w = &p->workers[i];
+        w->pool = p;
+        w->index = i;
+        w->rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+    for (usize i = 0; i < nworkers; i++) {
+        if (pthread_create(&p->workers[i].thread, null, __tp_worker_main, &p->workers[i]) != 0) {
+            p->nworkers = i;
+            thread_pool_free(p);
+            return null;
+        }
+    }
+    return p;
+}
+
+// start nworkers workers, 0 for one less than the online cpus
+thread_pool thread_pool_new(usize nworkers) {
+    return __thread_pool_new(STD_ALLOC_DEFAULT nworkers ? nworkers : __tp_auto_size());
+}
+
+// stop and join the workers, no tasks may be pending
+void thread_pool_free(thread_pool p) {
+    atomic_store_explicit(&p->stop, 1, memory_order_release);
+    atomic_fetch_add_explicit(&p->epoch, 1, memory_order_seq_cst);
+    __q_futex_wake(&p->epoch, INT_MAX);
+    for (usize i = 0; i < p->nworkers; i++) {
+        pthread_join(p->workers[i].thread, null);
+    }
+    mpmc_free(p->inject);
+    std_free(p->alloc, p->mem, p->memsz);
+    std_free(p->alloc, p, sizeof(struct __thread_pool));
+}
+
+// number of worker threads
+usize thread_pool_size(thread_pool p) {
+    return p->nworkers;
+}
+
+// pin worker i to cpus[i % n], 0 or -1 with errno
+int thread_pool_pin(thread_pool p, const int* cpus, usize n) {
+#ifdef __linux__
+    if (n == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    // raw syscall, pthread_setaffinity_np and cpu_set_t need _GNU_SOURCE defined before any include
+    for (usize i = 0; i < p->nworkers; i++) {
+        int cpu = cpus[i % n];
+        u64 mask[1024 / 64] = {0};
+        if (cpu < 0 || cpu >= 1024) {
+            errno = EINVAL;
+            return -1;
+        }
+        mask[cpu / 64] = (u64) 1 << (cpu % 64);
+        int tid;
+        while ((tid = atomic_load_explicit(&p->workers[i].tid, memory_order_acquire)) == 0) sched_yield();
+        if (syscall(SYS_sched_setaffinity, tid, sizeof(mask), mask) != 0) return -1;
+    }
+    return 0;
+#else
+    (void) p, (void) cpus, (void) n;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+pthread_once_t __tp_default_once = PTHREAD_ONCE_INIT;
+thread_pool __tp_default = null;
+
+void __tp_default_start() {
+    __tp_default = __thread_pool_new(STD_ALLOC_DEFAULT STD_THREAD_THREADS > 0 ? (usize) (STD_THREAD_THREADS - 1) : __tp_auto_size());
+}
+
+// shared pool, started on first use, null if it could not be
+thread_pool thread_default() {
+    pthread_once(&__tp_default_once, __tp_default_start);
+    return __tp_default;
+}
+
+// run fn(ctx) on the pool as part of g
+void thread_spawn(thread_pool p, task_group* g, void (*fn)(void*), void* ctx) {
+    __tp_task t = { fn, ctx, g };
+    atomic_fetch_add_explicit(&g->pending, 1, memory_order_relaxed);
+    __tp_worker* self = __tp_self;
+    bool queued = self != null && self->pool == p ? __tp_push(self, t) : mpmc_try_push(p->inject, t) == 0;
+    if (!queued) {
+        __tp_run(t);
+        return;
+    }
+    __tp_wake(p);
+}
+
+// run tasks until every task of g has finished
+void thread_wait(thread_pool p, task_group* g) {
+    __tp_worker* self = __tp_self != null && __tp_self->pool == p ? __tp_self : null;
+    __tp_task t;
+    int idle = 0;
+    while ((atomic_load_explicit(&g->pending, memory_order_acquire) & ~__TP_SLEEPING) > 0) {
+        if (__tp_find(p, self, &t)) {
+            __tp_run(t);
+            idle = 0;
+        } else if (++idle < STD_THREAD_SPIN / 2) {
+            __q_pause();
+        } else if (idle < STD_THREAD_SPIN) {
+            sched_yield();
+        } else {
+            // what's left is running on other threads, sleep until it's done
+            unsigned left = atomic_fetch_or_explicit(&g->pending, __TP_SLEEPING, memory_order_acq_rel) | __TP_SLEEPING;
+            if (left != __TP_SLEEPING) __q_futex_wait(&g->pending, left);
+            idle = 0;
+        }
+    }
+    atomic_fetch_and_explicit(&g->pending, ~__TP_SLEEPING, memory_order_relaxed);
+}
+
+
+// shared by the caller and the helper tasks of one thread_parallel_for
+typedef struct {
+    void (*fn)(void* ctx, usize begin, usize end);
+    void* ctx;
+    usize n;
+    usize grain;
+    usize nchunks;
+    atomic_size_t next;     // next chunk to hand out
+} __tp_range;
+
+void __tp_range_task(void* arg) {
+    __tp_range* r = arg;
+    usize c;
+    while ((c = atomic_fetch_add_explicit(&r->next, 1, memory_order_relaxed)) < r->nchunks) {
+        usize begin = c * r->grain;
+        r->fn(r->ctx, begin, begin + r->grain < r->n ? begin + r->grain : r->n);
+    }
+}
+
+// fn over chunks of [0, n)
+void thread_parallel_for(thread_pool p, usize n, usize grain,
+                         void (*fn)(void* ctx, usize begin, usize end), void* ctx) {
+    if (n == 0) return;
+    if (grain == 0) grain = 1;
+    __tp_range r = { .fn = fn, .ctx = ctx, .n = n, .grain = grain, .nchunks = (n + grain - 1) / grain };
+    task_group g = {0};
+    usize helpers = r.nchunks - 1 < p->nworkers ? r.nchunks - 1 : p->nworkers;
+    for (usize i = 0; i < helpers; i++) {
+        thread_spawn(p, &g, __tp_range_task, &r);
+    }
+    __tp_range_task(&r);
+    thread_wait(p, &g);
+}
+
+
+
+// shared by the caller and the helper tasks of one thread_parallel_for_static
+typedef struct {
+    void (*fn)(void* ctx, usize begin, usize end);
+    void* ctx;
+    usize n;
+    usize grain;
+    usize nchunks;
+    usize nthreads;         // chunk c belongs to thread c % nthreads
+    usize nlanes;           // threads with any chunks
+    atomic_bool* taken;     // lanes some thread has run or is running
+    thread_pool pool;
+} __tp_lanes;
+
+// runs the chunks of the thread it's on, or the first lane nobody took if those are done
+void __tp_lane_task(void* arg) {
+    __tp_lanes* r = arg;
+    __tp_worker* self = __tp_self;
+    usize lane = self != null && self->pool == r->pool ? self->index + 1 : 0;
+    if (lane >= r->nlanes || atomic_exchange_explicit(&r->taken[lane], true, memory_order_relaxed)) {
+        // as many tasks as lanes, so one is always left
+        lane = 0;
+        while (atomic_exchange_explicit(&r->taken[lane], true, memory_order_relaxed)) lane++;
+    }
+    for (usize c = lane; c < r->nchunks; c += r->nthreads) {
+        usize begin = c * r->grain;
+        r->fn(r->ctx, begin, begin + r->grain < r->n ? begin + r->grain : r->n);
+    }
+}
+
+// fn over chunks of [0, n), chunk c on thread c % (size + 1)
+void thread_parallel_for_static(thread_pool p, usize n, usize grain,
+                                void (*fn)(void* ctx, usize begin, usize end), void* ctx) {
+    if (n == 0) return;
+    if (grain == 0) grain = 1;
+    __tp_lanes r = { .fn = fn, .ctx = ctx, .n = n, .grain = grain, .nchunks = (n + grain - 1) / grain,
+                     .nthreads = p->nworkers + 1, .pool = p };
+    r.nlanes = r.nchunks < r.nthreads ? r.nchunks : r.nthreads;
+    r.taken = (atomic_bool*) std_calloc(p->alloc, r.nlanes, sizeof(atomic_bool));
+    if (r.taken == null) {
+        thread_parallel_for(p, n, grain, fn, ctx);
+        return;
+    }
+    task_group g = {0};
+    for (usize i = 1; i < r.nlanes; i++) {
+        thread_spawn(p, &g, __tp_lane_task, &r);
+    }
+    __tp_lane_task(&r);
+    thread_wait(p, &g);
+    std_free(p->alloc, r.taken, r.nlanes * sizeof(atomic_bool));
+}
+
+
+#endif // STD_THREAD_H
@@ -1,6 +1,8 @@
 #ifndef STD_VEC_H
 #define STD_VEC_H
 
+#include "alloc.h"
+#include "cpu.h"
 #include "types.h"
 
 #include <stdlib.h>
@@ -15,6 +17,7 @@ vec(T) - the type of a vector. Until C23, typedef this to something before using
 
 ** Memory management **
 vec_init(v)                         -- initialize vector
+vec_init_with(v, a)                 -- initialize vector using allocator a (STD_USE_ALLOCATOR only)
 vec_free(v)                         -- free all memory
 vec_reserve(v, n)                   -- reserve size for n elements
 vec_truncate(v, n)                  -- reduce to just the first n elements
@@ -37,15 +40,47 @@ vec_remove(v, val)                  -- remove first occurrence of val
 vec_swap(v, i, j)                   -- swap 2 values
 vec_extend(v, v2)                   -- push all elements from another vector
 vec_extend_from(v, b, n)            -- push n elements from buffer b
+vec_insert_n(v, i, b, n)            -- insert n elements from buffer b at index i
+vec_remove_all(v, val)              -- remove every occurrence of val
+vec_retain(v, pred)                 -- keep only the elements where pred(elem) is true, in order
+vec_filter(v, pred)                 -- same as vec_retain
 vec_sort(v, fn)                     -- qsort in-place
 vec_reverse(v)                      -- reverse elements in-place
+vec_rotate(v, k)                    -- rotate left by k, element k comes first
+vec_swap_ranges(v, i, j, n)         -- swap n elements at i with n elements at j (not overlapping)
+vec_gather(dst, src, idx, n)        -- dst = src[idx[0]], ..., src[idx[n-1]]
+vec_scatter(dst, src, idx)          -- dst[idx[i]] = src[i] for every element of src
 vec_splice(v, i, n)                 -- remove n elements starting at index i
 vec_swapsplice(v, i, n)             -- and replace with last n elements
 
+** Sorted vectors **
+vec_lower_bound(v, val, i)          -- stores index of first element not less than val in i
+vec_upper_bound(v, val, i)          -- stores index of first element greater than val in i
+vec_bsearch(v, val, i)              -- stores index of val in i, or -1
+vec_sorted_insert(v, val)           -- insert val after any equal elements
+vec_merge(v, a, b)                  -- v = a and b merged, all three sorted
+vec_unique(v)                       -- remove consecutive duplicates in-place
+vec_eytzinger(e, v)                 -- e = sorted v in eytzinger (bfs) order, for read-only lookups
+vec_eytzinger_lower_bound(e, val, i) -- stores index in e of first element not less than val in i, or -1
+
 ** Iteration **
 vec_iter(v, t)                      -- stores each value in t
 vec_enum(v, i, t)                   -- enumerate: stores each index in i and each value in t
 
+Swaps, reverse and rotate move whole words (and 32-byte blocks where there are enough
+elements) instead of single bytes. vec_reverse uses an AVX2 shuffle when the cpu has it
+and the element size divides 16; other sizes under 16 bytes reverse all the bytes, then
+put each element's bytes back in order. vec_rotate swaps blocks in place, or goes through a
+small buffer when one side is short. gather and scatter are typed loops, idx can be
+any integer array or pointer.
+
+vec_remove_all and vec_retain make a single pass, writing every element and only
+advancing the write index for the kept ones, so there's no branch on the predicate.
+
+Sorted vector functions compare with < and ==, so they work on numbers and pointers.
+The searches are branchless; vec_eytzinger_lower_bound also prefetches a few levels
+ahead, which pays off once the table is bigger than cache.
+
 */
 
 #define vec(T)        \
@@ -53,6 +88,7 @@ vec_enum(v, i, t)                   -- enumerate: stores each index in i and eac
     T* data;          \
     usize len;        \
     usize cap;        \
+    STD_ALLOC_FIELD   \
   }*                  \
 
 
@@ -64,23 +100,40 @@ typedef vec(int)    vec_int;
 typedef vec(char)   vec_char;
 typedef vec(float)  vec_float;
 typedef vec(double) vec_double;
+typedef vec(u32)    vec_u32;
+typedef vec(u64)    vec_u64;
 
 
 #define __v_unpack(v) \
+  STD_ALLOC_ARG(v) __v_fields(v)
+
+
+// the fields alone, for helpers that never allocate
+#define __v_fields(v) \
   (void**)&(v)->data, &(v)->len, &(v)->cap, sizeof(*(v)->data)
 
 
 // initialize vector
 #define vec_init(v) \
-  (v = calloc(1, sizeof(struct {void* data; usize len; usize cap;})))
+  __v_init_with(v, std_allocator_get())
+
+
+#ifdef STD_USE_ALLOCATOR
+// initialize vector using allocator a
+#define vec_init_with(v, a) \
+  __v_init_with(v, a)
+#endif
+
+
+#define __v_init_with(v, a) \
+  ((v) = std_calloc((a), 1, sizeof(*(v))), std_alloc_init((v), (a)))
 
 
 // free all memory
-#define vec_free(v)           \
-  do {                          \
-    free((v)->data);            \
-    memset(v, 0, sizeof(*(v))); \
-    free((v));                  \
+#define vec_free(v)                                                 \
+  do {                                                              \
+    std_free((v)->alloc, (v)->data, (v)->cap * sizeof(*(v)->data)); \
+    std_free((v)->alloc, (v), sizeof(*(v)));                        \
   } while(0)
 
 
@@ -165,7 +218,7 @@ typedef vec(double) vec_double;
 
 // swap 2 values
 #define vec_swap(v, i, j) \
-  __v_swap(__v_unpack(v), i, j)
+  __v_swap(__v_fields(v), i, j)
 
 
 // push all elements from another vector
@@ -176,37 +229,230 @@ typedef vec(double) vec_double;
 // push n elements from buffer b
 #define vec_extend_from(v, b, n)                                            \
   do {                                                                      \
-    int __i, __n = (n);                                                     \
+    usize __n = (n);                                                        \
+    __v_check_buf(v, b);                                                    \
     if (__v_reserve_po2(__v_unpack(v), (v)->len + __n) != 0) break;         \
-    for (__i = 0; __i < __n; __i++) {                                       \
-      (v)->data[(v)->len++] = (b)[__i];                                     \
-    }                                                                       \
+    memcpy((v)->data + (v)->len, (b), __n * sizeof(*(v)->data));            \
+    (v)->len += __n;                                                        \
   } while (0)
 
 
+// insert n elements from buffer b at index i
+#define vec_insert_n(v, i, b, n)                                            \
+  (__v_check_buf(v, b),                                                     \
+   __v_insert_n(__v_unpack(v), i, n) ? -1 :                                 \
+   (memcpy((v)->data + (i), (b), (n) * sizeof(*(v)->data)),                 \
+    (v)->len += (n), 0))
+
+
+// fails to compile unless buffer b holds elements of v's type, as it's copied bytewise
+#define __v_check_buf(v, b)                                                 \
+  ((void) sizeof(*(v)->data = *(b)),                                        \
+   (void) sizeof(char[sizeof(*(v)->data) == sizeof(*(b)) ? 1 : -1]))
+
+
+// remove every occurrence of val
+#define vec_remove_all(v, val)                                        \
+  do {                                                                \
+    __typeof__(*(v)->data) __val = (val);                             \
+    usize __r, __w = 0;                                               \
+    for (__r = 0; __r < (v)->len; __r++) {                            \
+      __typeof__(*(v)->data) __x = (v)->data[__r];                    \
+      (v)->data[__w] = __x;                                           \
+      __w += !(__x == __val);                                         \
+    }                                                                 \
+    (v)->len = __w;                                                   \
+  } while (0)
+
+
+// keep only the elements where pred(elem) is true, in order
+#define vec_retain(v, pred)                                           \
+  do {                                                                \
+    usize __r, __w = 0;                                               \
+    for (__r = 0; __r < (v)->len; __r++) {                            \
+      __typeof__(*(v)->data) __x = (v)->data[__r];                    \
+      (v)->data[__w] = __x;                                           \
+      __w += !!(pred(__x));                                           \
+    }                                                                 \
+    (v)->len = __w;                                                   \
+  } while (0)
+
+
+// same as vec_retain
+#define vec_filter(v, pred) \
+  vec_retain(v, pred)
+
+
 // qsort in-place
 #define vec_sort(v, fn) \
   qsort((v)->data, (v)->len, sizeof(*(v)->data), fn)
 
 
 // reverse elements in-place
-#define vec_reverse(v)                                \
-  do {                                                \
-    int __i = (v)->len / 2;                           \
-    while (__i--) {                                   \
-      vec_swap((v), __i, (v)->len - (__i + 1));       \
-    }                                                 \
+#define vec_reverse(v) \
+  __v_reverse((v)->data, (v)->len, sizeof(*(v)->data))
+
+
+// rotate left by k, element k comes first
+#define vec_rotate(v, k) \
+  __v_rotate((v)->data, (v)->len, sizeof(*(v)->data), (k))
+
+
+// swap n elements at i with n elements at j (not overlapping)
+#define vec_swap_ranges(v, i, j, n) \
+  __v_swap_bytes((char*) ((v)->data + (i)), (char*) ((v)->data + (j)), (n) * sizeof(*(v)->data))
+
+
+// dst = src[idx[0]], ..., src[idx[n-1]]
+#define vec_gather(dst, src, idx, n)                                  \
+  do {                                                                \
+    usize __n = (n);                                                  \
+    if (__v_reserve(__v_unpack(dst), __n) != 0) break;                \
+    __typeof__((dst)->data) __d = (dst)->data;                        \
+    const __typeof__(*(src)->data)* __s = (src)->data;                \
+    const __typeof__((idx)[0])* __x = (idx);                          \
+    for (usize __i = 0; __i < __n; __i++) {                           \
+      __d[__i] = __s[__x[__i]];                                       \
+    }                                                                 \
+    (dst)->len = __n;                                                 \
+  } while (0)
+
+
+// dst[idx[i]] = src[i] for every element of src
+#define vec_scatter(dst, src, idx)                                    \
+  do {                                                                \
+    __typeof__((dst)->data) __d = (dst)->data;                        \
+    const __typeof__(*(src)->data)* __s = (src)->data;                \
+    const __typeof__((idx)[0])* __x = (idx);                          \
+    for (usize __i = 0, __n = (src)->len; __i < __n; __i++) {         \
+      __d[__x[__i]] = __s[__i];                                       \
+    }                                                                 \
   } while (0)
 
 
 // remove n elements starting at index i
 #define vec_splice(v, i, n) \
-  (__v_splice(__v_unpack(v), i, n), (v)->len -= (n))
+  (__v_splice(__v_fields(v), i, n), (v)->len -= (n))
 
 
 // remove n elements starting at index i and replace with last n elements
 #define vec_swapsplice(v, i, n) \
-  (__v_swapsplice(__v_unpack(v), i, n), (v)->len -= (n))
+  (__v_swapsplice(__v_fields(v), i, n), (v)->len -= (n))
+
+
+// stores index of first element not less than val in i
+#define vec_lower_bound(v, val, i)                                    \
+  do {                                                                \
+    __typeof__(*(v)->data) __val = (val);                             \
+    __typeof__((v)->data) __b = (v)->data;                            \
+    usize __n = (v)->len;                                             \
+    while (__n > 1) {                                                 \
+      usize __h = __n / 2;                                            \
+      __b = (__b[__h] < __val) ? __b + __h : __b;                     \
+      __n -= __h;                                                     \
+    }                                                                 \
+    (i) = (__b - (v)->data) + (__n == 1 && __b[0] < __val);           \
+  } while (0)
+
+
+// stores index of first element greater than val in i
+#define vec_upper_bound(v, val, i)                                    \
+  do {                                                                \
+    __typeof__(*(v)->data) __val = (val);                             \
+    __typeof__((v)->data) __b = (v)->data;                            \
+    usize __n = (v)->len;                                             \
+    while (__n > 1) {                                                 \
+      usize __h = __n / 2;                                            \
+      __b = (__val < __b[__h]) ? __b : __b + __h;                     \
+      __n -= __h;                                                     \
+    }                                                                 \
+    (i) = (__b - (v)->data) + (__n == 1 && !(__val < __b[0]));        \
+  } while (0)
+
+
+// stores index of val in i, or -1
+#define vec_bsearch(v, val, i)                                        \
+  do {                                                                \
+    __typeof__(*(v)->data) __bsv = (val);                             \
+    usize __bsi;                                                      \
+    vec_lower_bound(v, __bsv, __bsi);                                 \
+    (i) = (__bsi < (v)->len && (v)->data[__bsi] == __bsv) ? __bsi : (usize) -1; \
+  } while (0)
+
+
+// insert val after any equal elements
+#define vec_sorted_insert(v, val)                                     \
+  do {                                                                \
+    __typeof__(*(v)->data) __siv = (val);                             \
+    usize __sii;                                                      \
+    vec_upper_bound(v, __siv, __sii);                                 \
+    vec_insert(v, __sii, __siv);                                      \
+  } while (0)
+
+
+// v = a and b merged, all three sorted
+#define vec_merge(v, a, b)                                            \
+  do {                                                                \
+    usize __i = 0, __j = 0, __k = 0;                                  \
+    usize __na = (a)->len, __nb = (b)->len;                           \
+    if (__v_reserve(__v_unpack(v), __na + __nb) != 0) break;          \
+    while (__i < __na && __j < __nb) {                                \
+      int __tb = (b)->data[__j] < (a)->data[__i];                     \
+      (v)->data[__k++] = __tb ? (b)->data[__j] : (a)->data[__i];      \
+      __j += __tb;                                                    \
+      __i += !__tb;                                                   \
+    }                                                                 \
+    memcpy((v)->data + __k, (a)->data + __i,                          \
+           (__na - __i) * sizeof(*(v)->data));                        \
+    __k += __na - __i;                                                \
+    memcpy((v)->data + __k, (b)->data + __j,                          \
+           (__nb - __j) * sizeof(*(v)->data));                        \
+    (v)->len = __k + (__nb - __j);                                    \
+  } while (0)
+
+
+// remove consecutive duplicates in-place
+#define vec_unique(v)                                                 \
+  do {                                                                \
+    usize __w = 1;                                                    \
+    if ((v)->len < 2) break;                                          \
+    for (usize __r = 1; __r < (v)->len; __r++) {                      \
+      if (!((v)->data[__r] == (v)->data[__w - 1])) {                  \
+        (v)->data[__w++] = (v)->data[__r];                            \
+      }                                                               \
+    }                                                                 \
+    (v)->len = __w;                                                   \
+  } while (0)
+
+
+// e = sorted v in eytzinger (bfs) order, for read-only lookups
+#define vec_eytzinger(e, v)                                           \
+  do {                                                                \
+    if (__v_reserve(__v_unpack(e), (v)->len) != 0) break;             \
+    __v_eytzinger((e)->data, (v)->data, (v)->len, sizeof(*(v)->data)); \
+    (e)->len = (v)->len;                                              \
+  } while (0)
+
+
+// elements per cache line rounded down to a power of two, so the prefetch covers the
+// descendants that many levels down; elements over 32 bytes still prefetch the children
+#define __v_ey_stride(e)                                                                  \
+  (sizeof(*(e)->data) <= 32 ? (usize) 1 << (63 - __builtin_clzll(64 / sizeof(*(e)->data))) : 2)
+
+
+// stores index in e of first element not less than val in i, or -1
+#define vec_eytzinger_lower_bound(e, val, i)                          \
+  do {                                                                \
+    __typeof__(*(e)->data) __val = (val);                             \
+    usize __k = 0, __n = (e)->len;                                    \
+    while (__k < __n) {                                               \
+      __builtin_prefetch((e)->data + __v_ey_stride(e) * (__k + 1) - 1); \
+      __k = 2 * __k + 1 + ((e)->data[__k] < __val);                   \
+    }                                                                 \
+    __k += 1;                                                         \
+    __k >>= __builtin_ffsll(~__k);                                    \
+    (i) = (isize) __k - 1;                                            \
+  } while (0)
 
 
 // stores each value in t
@@ -221,11 +467,11 @@ typedef vec(double) vec_double;
   for (i = 0; i < (v)->len && (((t) = (v)->data[i]), 1); ++i)                               \
 
 
-int __v_expand(void** data, usize* len, usize* cap, usize memsz) {
+int __v_expand(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz) {
   if (*len + 1 > *cap) {
     void *ptr;
     int n = (*cap == 0) ? 1 : *cap << 1;
-    ptr = realloc(*data, n * memsz);
+    ptr = std_realloc(alloc, *data, *cap * memsz, n * memsz);
     if (ptr == null) return -1;
     *data = ptr;
     *cap = n;
@@ -234,10 +480,10 @@ int __v_expand(void** data, usize* len, usize* cap, usize memsz) {
 }
 
 
-int __v_reserve(void** data, usize* len, usize* cap, usize memsz, usize n) {
+int __v_reserve(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, usize n) {
   (void) len;
   if (n > *cap) {
-    void *ptr = realloc(*data, n * memsz);
+    void *ptr = std_realloc(alloc, *data, *cap * memsz, n * memsz);
     if (ptr == null) return -1;
     *data = ptr;
     *cap = n;
@@ -246,24 +492,24 @@ int __v_reserve(void** data, usize* len, usize* cap, usize memsz, usize n) {
 }
 
 
-int __v_reserve_po2(void** data, usize* len, usize* cap, usize memsz, usize n) {
+int __v_reserve_po2(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, usize n) {
   usize n2 = 1;
   if (n == 0) return 0;
   while (n2 < n) n2 <<= 1;
-  return __v_reserve(data, len, cap, memsz, n2);
+  return __v_reserve(STD_ALLOC_FWD data, len, cap, memsz, n2);
 }
 
 
-int __v_compact(void** data, usize* len, usize* cap, usize memsz) {
+int __v_compact(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz) {
   if (*len == 0) {
-    free(*data);
+    std_free(alloc, *data, *cap * memsz);
     *data = null;
     *cap = 0;
     return 0;
   } else {
     void *ptr;
     usize n = *len;
-    ptr = realloc(*data, n * memsz);
+    ptr = std_realloc(alloc, *data, *cap * memsz, n * memsz);
     if (ptr == null) return -1;
     *cap = n;
     *data = ptr;
@@ -272,8 +518,8 @@ int __v_compact(void** data, usize* len, usize* cap, usize memsz) {
 }
 
 
-int __v_insert(void** data, usize* len, usize* cap, usize memsz, usize idx) {
-  int err = __v_expand(data, len, cap, memsz);
+int __v_insert(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, usize idx) {
+  int err = __v_expand(STD_ALLOC_FWD data, len, cap, memsz);
   if (err) return err;
   memmove(((char*)(*data)) + (idx + 1) * memsz,
           ((char*)(*data)) + idx * memsz,
@@ -282,6 +528,16 @@ int __v_insert(void** data, usize* len, usize* cap, usize memsz, usize idx) {
 }
 
 
+int __v_insert_n(STD_ALLOC_PARAM void** data, usize* len, usize* cap, usize memsz, usize idx, usize n) {
+  int err = __v_reserve_po2(STD_ALLOC_FWD data, len, cap, memsz, *len + n);
+  if (err) return err;
+  memmove(((char*)(*data)) + (idx + n) * memsz,
+          ((char*)(*data)) + idx * memsz,
+          (*len - idx) * memsz);
+  return 0;
+}
+
+
 void __v_splice(void **data, usize *len, usize *cap, usize memsz, usize start, usize count) {
   (void) cap;
   memmove(((char*)(*data)) + start * memsz,
@@ -297,20 +553,182 @@ void __v_swapsplice(void **data, usize *len, usize *cap, usize memsz, usize star
           count * memsz);
 }
 
+// fills out in eytzinger order from sorted in, returns next index of in to place
+usize __v_eytzinger_fill(char* out, const char* in, usize n, usize memsz, usize i, usize k) {
+  if (k < n) {
+    i = __v_eytzinger_fill(out, in, n, memsz, i, 2 * k + 1);
+    memcpy(out + k * memsz, in + i * memsz, memsz);
+    i = __v_eytzinger_fill(out, in, n, memsz, i + 1, 2 * k + 2);
+  }
+  return i;
+}
+
+
+void __v_eytzinger(void* out, const void* in, usize n, usize memsz) {
+  __v_eytzinger_fill((char*) out, (const char*) in, n, memsz, 0, 0);
+}
+
+
+// swap n bytes at a and b (not overlapping), a block or a word at a time
+void __v_swap_bytes(char* a, char* b, usize n) {
+  char t[32];
+  for (; n >= 32; n -= 32, a += 32, b += 32) {
+    memcpy(t, a, 32);
+    memcpy(a, b, 32);
+    memcpy(b, t, 32);
+  }
+  for (; n >= 8; n -= 8, a += 8, b += 8) {
+    memcpy(t, a, 8);
+    memcpy(a, b, 8);
+    memcpy(b, t, 8);
+  }
+  for (; n > 0; n--, a++, b++) {
+    char c = *a;
+    *a = *b;
+    *b = c;
+  }
+}
+
+
 void __v_swap(void** data, usize* len, usize* cap, usize memsz, usize idx1, usize idx2) {
-  unsigned char *a, *b, tmp;
-  usize count;
   (void) len;
   (void) cap;
   if (idx1 == idx2) return;
-  a = (unsigned char*) *data + idx1 * memsz;
-  b = (unsigned char*) *data + idx2 * memsz;
-  count = memsz;
-  while (count--) {
-    tmp = *a;
-    *a = *b;
-    *b = tmp;
-    a++, b++;
+  __v_swap_bytes((char*) *data + idx1 * memsz, (char*) *data + idx2 * memsz, memsz);
+}
+
+
+typedef struct { u64 lo, hi; } __v_u128;
+
+// swaps T-sized elements from both ends, with memcpy loads and stores so any alignment
+// and element type is fine
+#define __V_REVERSE(T, p, n)                      \
+  do {                                            \
+    char* __lo = (p);                             \
+    char* __hi = __lo + (n) * sizeof(T);          \
+    for (usize __i = 0; __i < (n) / 2; __i++) {   \
+      T __a, __b;                                 \
+      __hi -= sizeof(T);                          \
+      memcpy(&__a, __lo, sizeof(T));              \
+      memcpy(&__b, __hi, sizeof(T));              \
+      memcpy(__lo, &__b, sizeof(T));              \
+      memcpy(__hi, &__a, sizeof(T));              \
+      __lo += sizeof(T);                          \
+    }                                             \
+  } while (0)
+
+
+// reverses the bytes of each of n m-byte elements
+#define __V_FLIP(p, n, m)                                           \
+  do {                                                              \
+    for (usize __i = 0; __i < (n); __i++, (p) += (m)) {             \
+      for (usize __a = 0, __b = (m) - 1; __a < __b; __a++, __b--) { \
+        char __c = (p)[__a];                                        \
+        (p)[__a] = (p)[__b];                                        \
+        (p)[__b] = __c;                                             \
+      }                                                             \
+    }                                                               \
+  } while (0)
+
+
+#if defined(__x86_64__)
+typedef char __v_v32qi __attribute__((vector_size(32)));
+typedef long long __v_v4di __attribute__((vector_size(32)));
+
+// reverses 32-byte blocks from both ends while 64 bytes are left in the middle,
+// memsz must divide 16, returns the elements done at each end
+__attribute__((target("avx2")))
+usize __v_reverse_avx2(char* p, usize n, usize memsz) {
+  // reverses the elements within each 16-byte lane (vpshufb), the permute swaps the lanes
+  __v_v32qi mask;
+  for (int i = 0; i < 32; i++) {
+    int k = i % 16;
+    mask[i] = (char) ((16 / memsz - 1 - k / memsz) * memsz + k % memsz);
+  }
+  char* lo = p;
+  char* hi = p + n * memsz;
+  while (hi - lo >= 64) {
+    hi -= 32;
+    __v_v32qi a, b;
+    memcpy(&a, lo, 32);
+    memcpy(&b, hi, 32);
+    a = (__v_v32qi) __builtin_ia32_permdi256((__v_v4di) __builtin_ia32_pshufb256(a, mask), 0x4e);
+    b = (__v_v32qi) __builtin_ia32_permdi256((__v_v4di) __builtin_ia32_pshufb256(b, mask), 0x4e);
+    memcpy(lo, &b, 32);
+    memcpy(hi, &a, 32);
+    lo += 32;
+  }
+  return (lo - p) / memsz;
+}
+#endif
+
+
+// reverse n elements of memsz bytes
+void __v_reverse(void* data, usize n, usize memsz) {
+  char* p = (char*) data;
+#if defined(__x86_64__)
+  if (memsz <= 16 && 16 % memsz == 0 && n * memsz >= 64 && std_cpu_has(STD_CPU_AVX2)) {
+    usize done = __v_reverse_avx2(p, n, memsz);
+    p += done * memsz;
+    n -= 2 * done;
+  }
+#endif
+  if (memsz < 16 && (memsz & (memsz - 1)) != 0) {
+    // odd sizes: reverse all the bytes, which has a fast path, then each element's back
+    __v_reverse(p, n * memsz, 1);
+    switch (memsz) {
+      case 3:  __V_FLIP(p, n, 3); break;
+      case 5:  __V_FLIP(p, n, 5); break;
+      case 6:  __V_FLIP(p, n, 6); break;
+      case 7:  __V_FLIP(p, n, 7); break;
+      default: __V_FLIP(p, n, memsz);
+    }
+    return;
+  }
+  switch (memsz) {
+    case 1:  __V_REVERSE(u8, p, n); break;
+    case 2:  __V_REVERSE(u16, p, n); break;
+    case 4:  __V_REVERSE(u32, p, n); break;
+    case 8:  __V_REVERSE(u64, p, n); break;
+    case 16: __V_REVERSE(__v_u128, p, n); break;
+    default:
+      for (usize i = 0, j = n - 1; i < n / 2; i++, j--) {
+        __v_swap_bytes(p + i * memsz, p + j * memsz, memsz);
+      }
+  }
+}
+
+
+// rotate n elements of memsz bytes left by k
+void __v_rotate(void* data, usize n, usize memsz, usize k) {
+  if (n == 0 || k % n == 0) return;
+  char* p = (char*) data;
+  usize l = (k % n) * memsz;
+  usize r = n * memsz - l;
+  char buf[256];
+  // [left l][right r] -> [right][left]: swap the shorter side into its final place and
+  // carry on with what's left, until one side is short enough for the buffer
+  while (l != 0 && r != 0) {
+    if (l <= sizeof(buf)) {
+      memcpy(buf, p, l);
+      memmove(p, p + l, r);
+      memcpy(p + r, buf, l);
+      return;
+    }
+    if (r <= sizeof(buf)) {
+      memcpy(buf, p + l, r);
+      memmove(p + r, p, l);
+      memcpy(p, buf, r);
+      return;
+    }
+    if (l <= r) {
+      __v_swap_bytes(p, p + l, l);
+      p += l;
+      r -= l;
+    } else {
+      __v_swap_bytes(p + l - r, p + l, r);
+      l -= r;
+    }
   }
 }
 
@@ -0,0 +1,355 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef STD_USE_ALLOCATOR
+#define STD_USE_ALLOCATOR
+#endif
+#include "../std.h"
+
+// tracking allocator: counts live blocks and bytes
+typedef struct {
+    long blocks;
+    long bytes;
+    long calls;
+} tracker;
+
+void* track_alloc(void* ctx, usize size) {
+    tracker* t = ctx;
+    t->blocks++;
+    t->bytes += size;
+    t->calls++;
+    return malloc(size);
+}
+
+void* track_realloc(void* ctx, void* ptr, usize old_size, usize new_size) {
+    tracker* t = ctx;
+    if (ptr == null) t->blocks++;
+    t->bytes += (long) new_size - (long) (ptr == null ? 0 : old_size);
+    t->calls++;
+    return realloc(ptr, new_size);
+}
+
+void track_free(void* ctx, void* ptr, usize size) {
+    tracker* t = ctx;
+    t->blocks--;
+    t->bytes -= size;
+    free(ptr);
+}
+
+// Test function for vec_init_with
+void test_vec_init_with() {
+    tracker t = {0};
+    allocator a = { track_alloc, track_realloc, track_free, &t };
+    vec(int) v;
+    vec_init_with(v, &a);
+    for (int i = 0; i < 100; i++) {
+        vec_push(v, i);
+    }
+    vec_compact(v);
+    bool ok = t.calls > 0 && vec_at(v, 99) == 99;
+    vec_free(v);
+    if (ok && t.blocks == 0 && t.bytes == 0) {
+        printf("vec_init_with: PASSED\n");
+    } else {
+        printf("vec_init_with: FAILED\n");
+    }
+}
+
+// Test function for svec_init_with
+void test_svec_init_with() {
+    tracker t = {0};
+    allocator a = { track_alloc, track_realloc, track_free, &t };
+    svec(int, 4) v;
+    svec_init_with(v, &a);
+    for (int i = 0; i < 20; i++) {
+        svec_push(v, i);
+    }
+    svec_free(v);
+    if (t.calls > 0 && t.blocks == 0 && t.bytes == 0) {
+        printf("svec_init_with: PASSED\n");
+    } else {
+        printf("svec_init_with: FAILED\n");
+    }
+}
+
+// Test function for array_init_with
+void test_array_init_with() {
+    tracker t = {0};
+    allocator a = { track_alloc, track_realloc, track_free, &t };
+    array(double) arr;
+    array_init_with(arr, 10, &a);
+    array_fill(arr, 1.5);
+    array_resize(arr, 20);
+    array_free(arr);
+    if (t.calls > 0 && t.blocks == 0 && t.bytes == 0) {
+        printf("array_init_with: PASSED\n");
+    } else {
+        printf("array_init_with: FAILED\n");
+    }
+}
+
+// refuses anything bigger than the size in ctx
+void* small_alloc(void* ctx, usize size) {
+    return size > *(usize*) ctx ? null : malloc(size);
+}
+
+void* small_realloc(void* ctx, void* ptr, usize old_size, usize new_size) {
+    (void) old_size;
+    return new_size > *(usize*) ctx ? null : realloc(ptr, new_size);
+}
+
+void small_free(void* ctx, void* ptr, usize size) {
+    (void) ctx, (void) size;
+    free(ptr);
+}
+
+// Test function for svec_init_with leaving v null when it can't allocate
+void test_svec_init_nomem() {
+    usize limit = 0;
+    allocator a = { small_alloc, small_realloc, small_free, &limit };
+    svec(int, 4) v;
+    svec_init_with(v, &a);
+    if (v == null) {
+        printf("svec_init_nomem: PASSED\n");
+    } else {
+        printf("svec_init_nomem: FAILED\n");
+    }
+}
+
+// Test function for array_resize keeping the old elements when it can't allocate
+void test_array_resize_nomem() {
+    usize limit = 4096;
+    allocator a = { small_alloc, small_realloc, small_free, &limit };
+    allocator* prev = std_allocator_set(&a);
+    array(int) plain;
+    array(int) aligned;
+    array_init(plain, 10);
+    array_init_aligned(aligned, 10, 64);
+    std_allocator_set(prev);
+    array_fill(plain, 7);
+    array_fill(aligned, 8);
+    bool ok = array_resize(plain, 100000) == -1 && array_resize(aligned, 100000) == -1;
+    ok = ok && plain->len == 10 && aligned->len == 10 && plain->data[9] == 7 && aligned->data[9] == 8;
+    ok = ok && array_resize(aligned, 20) == 0 && aligned->data[9] == 8 && (uintptr_t) aligned->data % 64 == 0;
+    array_free(plain);
+    array_free(aligned);
+    if (ok) {
+        printf("array_resize_nomem: PASSED\n");
+    } else {
+        printf("array_resize_nomem: FAILED\n");
+    }
+}
+
+// Test function for slotmap_insert leaving the slot map as it was when it can't allocate
+void test_slotmap_insert_nomem() {
+    usize limit = 256;
+    allocator a = { small_alloc, small_realloc, small_free, &limit };
+    slotmap(int) m;
+    slotmap_init_with(m, &a);
+    slotmap_id ids[32];
+    bool ok = true;
+    for (int i = 0; i < 32; i++) {
+        ids[i] = slotmap_insert(m, i);
+        ok = ok && ids[i] != 0;
+    }
+    // the 33rd needs 64 slots, 512 bytes
+    ok = ok && slotmap_insert(m, 32) == 0 && slotmap_len(m) == 32 && m->slots->len == 32 && m->owners->len == 32;
+    ok = ok && slotmap_remove(m, ids[5]) == 0;
+    slotmap_id again = slotmap_insert(m, 99);
+    ok = ok && again != 0 && slotmap_at(m, again) == 99 && slotmap_at(m, ids[31]) == 31 && slotmap_len(m) == 32;
+    ok = ok && slotmap_reserve(m, 1000) == -1 && slotmap_reserve(m, 32) == 0;
+    slotmap_free(m);
+    if (ok) {
+        printf("slotmap_insert_nomem: PASSED\n");
+    } else {
+        printf("slotmap_insert_nomem: FAILED\n");
+    }
+}
+
+void add_int(int* a, const int* b) {
+    *a += *b;
+}
+
+par_fn2(add_int_fn, int, int, add_int)
+
+// Test function for par_reduce and the scans reporting they couldn't get their scratch
+void test_par_nomem() {
+    array_int v;
+    array_init(v, 1 << 20);
+    array_fill(v, 1);
+    usize limit = 256;
+    allocator a = { small_alloc, small_realloc, small_free, &limit };
+    allocator* prev = std_allocator_set(&a);
+    int sum = 5;
+    bool ok = par_reduce(v, sum, 0, add_int_fn) == -1 && sum == 5;
+    ok = ok && par_inclusive_scan(v, v, 0, add_int_fn) == -1 && v->data[1] == 1;
+    std_allocator_set(prev);
+    ok = ok && par_reduce(v, sum, 0, add_int_fn) == 0 && sum == 5 + (1 << 20);
+    ok = ok && par_inclusive_scan(v, v, 0, add_int_fn) == 0 && v->data[(1 << 20) - 1] == 1 << 20;
+    array_free(v);
+    if (ok) {
+        printf("par_nomem: PASSED\n");
+    } else {
+        printf("par_nomem: FAILED\n");
+    }
+}
+
+// Test function for ser_dump_strs and ser_load_strs taking their blocks from the allocator
+void test_ser_strs_with() {
+    tracker t = {0};
+    allocator a = { track_alloc, track_realloc, track_free, &t };
+    allocator* prev = std_allocator_set(&a);
+    array_str s, r;
+    array_init(s, 3);
+    array_init(r, 0);
+    for (int i = 0; i < 3; i++) {
+        s->data[i] = str_from("abc");
+    }
+    FILE* f = tmpfile();
+    long before = t.calls;
+    bool ok = ser_dump_strs(ser_file(f), s, STD_SER_CRC) == 0 && t.calls > before;
+    rewind(f);
+    before = t.calls;
+    ok = ok && ser_load_strs(ser_file(f), r) == 0 && r->len == 3 && str_equals(r->data[2], (c_str) "abc");
+    // the lengths, the block and the 3 strs with their chars
+    ok = ok && t.calls >= before + 8;
+    fclose(f);
+    for (int i = 0; i < 3; i++) {
+        str_free(s->data[i]);
+        str_free(r->data[i]);
+    }
+    array_free(s);
+    array_free(r);
+    std_allocator_set(prev);
+    if (ok && t.blocks == 0 && t.bytes == 0) {
+        printf("ser_strs_with: PASSED\n");
+    } else {
+        printf("ser_strs_with: FAILED\n");
+    }
+}
+
+typedef struct {
+    tracker t;
+    usize limit;
+} small_tracker;
+
+void* small_track_alloc(void* ctx, usize size) {
+    small_tracker* s = ctx;
+    return size > s->limit ? null : track_alloc(&s->t, size);
+}
+
+void* small_track_realloc(void* ctx, void* ptr, usize old_size, usize new_size) {
+    small_tracker* s = ctx;
+    return new_size > s->limit ? null : track_realloc(&s->t, ptr, old_size, new_size);
+}
+
+void small_track_free(void* ctx, void* ptr, usize size) {
+    track_free(&((small_tracker*) ctx)->t, ptr, size);
+}
+
+typedef struct {
+    char bytes[200];
+} Blob;
+
+SOA_DEFINE(blobs, (int, key), (Blob, blob))
+
+// Test function for soa_reserve leaving every column alone when one can't grow
+void test_soa_reserve_nomem() {
+    small_tracker st = { {0}, 4096 };
+    allocator a = { small_track_alloc, small_track_realloc, small_track_free, &st };
+    allocator* prev = std_allocator_set(&a);
+    blobs b = blobs_new();
+    std_allocator_set(prev);
+    Blob x = { "x" };
+    bool ok = soa_reserve(b, 20) == 0 && blobs_push(b, 7, x) == 0;
+    // the int column fits 30, the blobs don't
+    ok = ok && soa_reserve(b, 30) == -1 && b->cap == 20 && soa_at(b, key, 0) == 7;
+    ok = ok && soa_reserve(b, 16) == 0 && strcmp(soa_at(b, blob, 0).bytes, "x") == 0;
+    soa_free(b);
+    if (ok && st.t.blocks == 0 && st.t.bytes == 0) {
+        printf("soa_reserve_nomem: PASSED\n");
+    } else {
+        printf("soa_reserve_nomem: FAILED\n");
+    }
+}
+
+// Test function for map_init_with
+void test_map_init_with() {
+    tracker t = {0};
+    allocator a = { track_alloc, track_realloc, track_free, &t };
+    map(int) m;
+    map_init_with(m, &a);
+    char key[16];
+    for (int i = 0; i < 50; i++) {
+        sprintf(key, "key%d", i);
+        map_insert(m, key, i);
+    }
+    map_remove(m, "key7");
+    bool ok = map_size(m) == 49 && *(int*) map_get(m, "key42") == 42;
+    map_clear(m);
+    map_insert(m, "again", 1);
+    map_free(m);
+    if (ok && t.blocks == 0 && t.bytes == 0) {
+        printf("map_init_with: PASSED\n");
+    } else {
+        printf("map_init_with: FAILED\n");
+    }
+}
+
+// Test function for str_from_with
+void test_str_from_with() {
+    tracker t = {0};
+    allocator a = { track_alloc, track_realloc, track_free, &t };
+    str s = str_from_with("hello", &a);
+    str_append(s, (c_str) " world");
+    str_prepend(s, '>');
+    bool ok = str_equals(s, (c_str) ">hello world");
+    str_free(s);
+    if (ok && t.calls > 0 && t.blocks == 0 && t.bytes == 0) {
+        printf("str_from_with: PASSED\n");
+    } else {
+        printf("str_from_with: FAILED\n");
+    }
+}
+
+// Test function for std_allocator_set
+void test_std_allocator_set() {
+    tracker t = {0};
+    allocator a = { track_alloc, track_realloc, track_free, &t };
+    allocator* prev = std_allocator_set(&a);
+    array_str parts = str_split((c_str) "a,b,c", ',');
+    vec(int) v;
+    vec_init(v);
+    vec_push(v, 1);
+    std_allocator_set(prev);
+    bool ok = t.blocks > 0 && std_allocator_of(v) == &a && std_allocator_get() == prev;
+    str p;
+    array_iter(parts, p) {
+        str_free(p);
+    }
+    array_free(parts);
+    vec_free(v);
+    if (ok && t.blocks == 0 && t.bytes == 0) {
+        printf("std_allocator_set: PASSED\n");
+    } else {
+        printf("std_allocator_set: FAILED\n");
+    }
+}
+
+int main() {
+    test_vec_init_with();
+    test_svec_init_with();
+    test_array_init_with();
+    test_svec_init_nomem();
+    test_array_resize_nomem();
+    test_slotmap_insert_nomem();
+    test_par_nomem();
+    test_ser_strs_with();
+    test_soa_reserve_nomem();
+    test_map_init_with();
+    test_str_from_with();
+    test_std_allocator_set();
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef STD_USE_ALLOCATOR
+#define STD_USE_ALLOCATOR
+#endif
+#include "../std.h"
+
+// Test function for arena_alloc
+void test_arena_alloc() {
+    arena a = arena_new(0);
+    int* x = arena_alloc(a, 10 * sizeof(int));
+    int* y = arena_alloc(a, 10 * sizeof(int));
+    for (int i = 0; i < 10; i++) {
+        x[i] = i;
+        y[i] = -i;
+    }
+    if (x != y && x[9] == 9 && y[9] == -9 && (uintptr_t) y % STD_ARENA_ALIGN == 0) {
+        printf("arena_alloc: PASSED\n");
+    } else {
+        printf("arena_alloc: FAILED\n");
+    }
+    arena_free(a);
+}
+
+// Test function for arena_alloc_aligned
+void test_arena_alloc_aligned() {
+    arena a = arena_new(0);
+    arena_alloc(a, 3);
+    void* p = arena_alloc_aligned(a, 100, 64);
+    void* q = arena_alloc_aligned(a, 100, 4096);
+    if ((uintptr_t) p % 64 == 0 && (uintptr_t) q % 4096 == 0) {
+        printf("arena_alloc_aligned: PASSED\n");
+    } else {
+        printf("arena_alloc_aligned: FAILED\n");
+    }
+    arena_free(a);
+}
+
+// Test function for allocations bigger than a chunk
+void test_arena_chunks() {
+    arena a = arena_new(256);
+    char* small = arena_alloc(a, 200);
+    char* big = arena_alloc(a, 10000);
+    memset(small, 1, 200);
+    memset(big, 2, 10000);
+    bool ok = small[199] == 1 && big[9999] == 2 && arena_used(a) >= 10200;
+    arena_reset(a);
+    char* again = arena_alloc(a, 200);
+    ok = ok && again == small && arena_used(a) == 200;
+    if (ok) {
+        printf("arena_chunks: PASSED\n");
+    } else {
+        printf("arena_chunks: FAILED\n");
+    }
+    arena_free(a);
+}
+
+// Test function for arena_save and arena_restore
+void test_arena_save_restore() {
+    arena a = arena_new(128);
+    arena_alloc(a, 16);
+    arena_mark m = arena_save(a);
+    void* p = arena_alloc(a, 16);
+    for (int i = 0; i < 100; i++) {
+        arena_alloc(a, 64);
+    }
+    arena_restore(a, m);
+    void* q = arena_alloc(a, 16);
+    if (p == q) {
+        printf("arena_save_restore: PASSED\n");
+    } else {
+        printf("arena_save_restore: FAILED\n");
+    }
+    arena_free(a);
+}
+
+// Test function for containers allocated from an arena
+void test_arena_containers() {
+    arena a = arena_new(1024);
+    vec(int) v;
+    vec_init_with(v, arena_allocator(a));
+    for (int i = 0; i < 1000; i++) {
+        vec_push(v, i);
+    }
+    str s = str_from_with("hello", arena_allocator(a));
+    str_append(s, (c_str) " world");
+    bool ok = vec_at(v, 999) == 999 && str_equals(s, (c_str) "hello world");
+    arena_reset(a);
+    if (ok && arena_used(a) == 0) {
+        printf("arena_containers: PASSED\n");
+    } else {
+        printf("arena_containers: FAILED\n");
+    }
+    arena_free(a);
+}
+
+// Test function for temporaries from the thread default allocator
+void test_arena_default() {
+    arena a = arena_new(0);
+    allocator* prev = std_allocator_set(arena_allocator(a));
+    array_str parts = str_split((c_str) "a,bb,ccc", ',');
+    str mid = str_slice(parts->data[2], 1, 3);
+    std_allocator_set(prev);
+    bool ok = parts->len == 3 && str_equals(parts->data[1], (c_str) "bb") && str_equals(mid, (c_str) "cc");
+    ok = ok && arena_used(a) > 0;
+    arena_reset(a);
+    if (ok && arena_used(a) == 0) {
+        printf("arena_default: PASSED\n");
+    } else {
+        printf("arena_default: FAILED\n");
+    }
+    arena_free(a);
+}
+
+// Test function for str_split on a c_str keeping the last part, with the parts in an arena
+void test_arena_split() {
+    arena a = arena_new(0);
+    allocator* prev = std_allocator_set(arena_allocator(a));
+    array_str parts = str_split((c_str) "a::bb::ccc", (c_str) "::");
+    array_str pair = str_split((c_str) "x,y", ',');
+    std_allocator_set(prev);
+    bool ok = parts->len == 3 && str_equals(parts->data[0], (c_str) "a") && str_equals(parts->data[2], (c_str) "ccc");
+    ok = ok && pair->len == 2 && str_equals(pair->data[1], (c_str) "y");
+    if (ok) {
+        printf("arena_split: PASSED\n");
+    } else {
+        printf("arena_split: FAILED\n");
+    }
+    arena_free(a);
+}
+
+int main() {
+    test_arena_alloc();
+    test_arena_alloc_aligned();
+    test_arena_chunks();
+    test_arena_save_restore();
+    test_arena_containers();
+    test_arena_default();
+    test_arena_split();
+    return 0;
+}
@@ -1,4 +1,7 @@
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include "../std/array.h"
 
 typedef struct {
@@ -58,6 +61,44 @@ int main() {
     // freeialize the array
     array_free(points);
 
+    // aligned arrays keep their alignment across resizes, big ones get mapped
+    array(double) aligned;
+    array_init_aligned(aligned, 1000, 64);
+    bool ok = (uintptr_t) aligned->data % 64 == 0 && aligned->data[999] == 0;
+    aligned->data[999] = 1.5;
+    array_resize(aligned, 2000000);
+    ok = ok && (uintptr_t) aligned->data % 64 == 0 && aligned->data[999] == 1.5 && aligned->data[1999999] == 0;
+    array_resize(aligned, 10);
+    ok = ok && (uintptr_t) aligned->data % 64 == 0 && array_len(aligned) == 10;
+    array_free(aligned);
+    array_init_aligned(aligned, 3, 5);
+    ok = ok && aligned->align == 16 && (uintptr_t) aligned->data % 16 == 0;
+    array_free(aligned);
+    printf("array_init_aligned: %s\n", ok ? "PASSED" : "FAILED");
+
+    // reverse, rotate and gather/scatter through an index permutation
+    array_int nums, perm, back;
+    array_init(nums, 10);
+    array_init(perm, 10);
+    array_init(back, 10);
+    for (int i = 0; i < 10; i++) {
+        array_at(nums, i) = i;
+    }
+    array_reverse(nums);
+    ok = array_first(nums) == 9 && array_last(nums) == 0;
+    array_rotate(nums, 3);
+    ok = ok && array_at(nums, 0) == 6 && array_at(nums, 6) == 0 && array_at(nums, 7) == 9;
+    array_swap_ranges(nums, 0, 5, 5);
+    ok = ok && array_at(nums, 0) == 1 && array_at(nums, 5) == 6;
+    int idx[10] = { 3, 1, 4, 0, 9, 2, 6, 5, 8, 7 };
+    array_gather(perm, nums, idx);
+    array_scatter(back, perm, idx);
+    ok = ok && array_at(perm, 0) == array_at(nums, 3) && memcmp(back->data, nums->data, 10 * sizeof(int)) == 0;
+    printf("array_permute: %s\n", ok ? "PASSED" : "FAILED");
+    array_free(nums);
+    array_free(perm);
+    array_free(back);
+
     return 0;
 }
 
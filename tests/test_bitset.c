@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/bitset.h"
+
+// Test function for bitset_set, bitset_clear, bitset_test and bitset_count
+void test_bitset_basic() {
+    bitset b = bitset_new(1000);
+    bool ok = bitset_len(b) == 1000 && bitset_count(b) == 0;
+    for (usize i = 0; i < 1000; i += 3) {
+        bitset_set(b, i);
+    }
+    bitset_clear(b, 3);
+    bitset_flip(b, 4);
+    ok = ok && bitset_test(b, 0) && !bitset_test(b, 3) && bitset_test(b, 4) && !bitset_test(b, 5);
+    ok = ok && bitset_count(b) == 334;
+    bitset_set_all(b);
+    ok = ok && bitset_count(b) == 1000;
+    bitset_clear_all(b);
+    ok = ok && bitset_count(b) == 0;
+    if (ok) {
+        printf("bitset_basic: PASSED\n");
+    } else {
+        printf("bitset_basic: FAILED\n");
+    }
+    bitset_free(b);
+}
+
+// Test function for bitset_count on a long bitset against a plain loop
+void test_bitset_count() {
+    usize n = 1000003;
+    bitset b = bitset_new(n);
+    usize expected = 0;
+    srand(7);
+    for (usize i = 0; i < n; i++) {
+        if (rand() % 5 == 0) {
+            bitset_set(b, i);
+            expected++;
+        }
+    }
+    if (bitset_count(b) == expected && __bitset_count_base(b->words, b->nwords) == expected) {
+        printf("bitset_count: PASSED\n");
+    } else {
+        printf("bitset_count: FAILED\n");
+    }
+    bitset_free(b);
+}
+
+// Test function for and/or/xor/andnot
+void test_bitset_bulk() {
+    bitset a = bitset_new(200), b = bitset_new(200), c = bitset_new(200);
+    for (usize i = 0; i < 200; i++) {
+        if (i % 2 == 0) bitset_set(a, i);
+        if (i % 3 == 0) bitset_set(b, i);
+    }
+    bitset_or(c, a);
+    bitset_and(c, b);
+    bool ok = bitset_count(c) == 34;
+    bitset_clear_all(c);
+    bitset_or(c, a);
+    bitset_xor(c, b);
+    ok = ok && bitset_count(c) == 100 + 67 - 2 * 34;
+    bitset_andnot(a, b);
+    ok = ok && bitset_count(a) == 100 - 34 && !bitset_test(a, 6) && bitset_test(a, 4);
+    if (ok) {
+        printf("bitset_bulk: PASSED\n");
+    } else {
+        printf("bitset_bulk: FAILED\n");
+    }
+    bitset_free(a);
+    bitset_free(b);
+    bitset_free(c);
+}
+
+// Test function for bitset_iter and bitset_next
+void test_bitset_iter() {
+    bitset b = bitset_new(10000);
+    usize want[] = { 0, 63, 64, 65, 700, 4095, 9999 };
+    for (int k = 0; k < 7; k++) {
+        bitset_set(b, want[k]);
+    }
+    bool ok = true;
+    int k = 0;
+    usize i;
+    bitset_iter(b, i) {
+        ok = ok && k < 7 && i == want[k];
+        k++;
+    }
+    ok = ok && k == 7;
+    ok = ok && bitset_next(b, 1) == 63 && bitset_next(b, 66) == 700 && bitset_next(b, 9999) == 9999;
+    bitset_clear(b, 9999);
+    ok = ok && bitset_next(b, 4096) == 10000;
+    if (ok) {
+        printf("bitset_iter: PASSED\n");
+    } else {
+        printf("bitset_iter: FAILED\n");
+    }
+    bitset_free(b);
+}
+
+// Test function for bitset_rank and bitset_select with and without the index
+void test_bitset_rank_select() {
+    usize n = 100000;
+    bitset b = bitset_new(n);
+    for (usize i = 0; i < n; i++) {
+        if (i % 7 == 0 || i % 11 == 0) bitset_set(b, i);
+    }
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++) {
+        usize r = 0;
+        for (usize i = 0; ok && i <= n; i++) {
+            ok = bitset_rank(b, i) == r;
+            if (i < n && bitset_test(b, i)) {
+                ok = ok && bitset_select(b, r) == i;
+                r++;
+            }
+        }
+        ok = ok && bitset_select(b, r) == n;
+        ok = ok && bitset_build_index(b) == 0;
+    }
+    if (ok) {
+        printf("bitset_rank_select: PASSED\n");
+    } else {
+        printf("bitset_rank_select: FAILED\n");
+    }
+    bitset_free(b);
+}
+
+// Test function for bitset_resize
+void test_bitset_resize() {
+    bitset b = bitset_new(100);
+    bitset_set_all(b);
+    bitset_resize(b, 70);
+    bool ok = bitset_count(b) == 70;
+    bitset_resize(b, 5000);
+    ok = ok && bitset_len(b) == 5000 && bitset_count(b) == 70 && !bitset_test(b, 70);
+    bitset_set(b, 4999);
+    ok = ok && bitset_count(b) == 71;
+    if (ok) {
+        printf("bitset_resize: PASSED\n");
+    } else {
+        printf("bitset_resize: FAILED\n");
+    }
+    bitset_free(b);
+}
+
+int main() {
+    test_bitset_basic();
+    test_bitset_count();
+    test_bitset_bulk();
+    test_bitset_iter();
+    test_bitset_rank_select();
+    test_bitset_resize();
+    return 0;
+}
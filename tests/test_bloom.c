@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/bloom.h"
+
+// Test function for bloom_add and bloom_has with c_str and str keys
+void test_bloom_strings() {
+    bloom b = bloom_new(1000, 0.01);
+    char key[32];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(key, "key-%d", i);
+        bloom_add(b, (c_str) key);
+    }
+    bool ok = bloom_count(b) == 1000;
+    // no false negatives
+    for (int i = 0; i < 1000; i++) {
+        sprintf(key, "key-%d", i);
+        ok = ok && bloom_has(b, (c_str) key);
+    }
+    str s = str_from("key-42");
+    ok = ok && bloom_has(b, s);
+    str_free(s);
+    bloom_clear(b);
+    ok = ok && bloom_count(b) == 0 && !bloom_has(b, (c_str) "key-42");
+    if (ok) {
+        printf("bloom_strings: PASSED\n");
+    } else {
+        printf("bloom_strings: FAILED\n");
+    }
+    bloom_free(b);
+}
+
+// Test function for the false-positive rate staying close to what was asked for
+void test_bloom_fp_rate() {
+    int n = 100000;
+    bloom b = bloom_new(n, 0.01);
+    char key[32];
+    for (int i = 0; i < n; i++) {
+        sprintf(key, "in-%d", i);
+        bloom_add(b, (c_str) key);
+    }
+    int fp = 0;
+    for (int i = 0; i < n; i++) {
+        sprintf(key, "out-%d", i);
+        fp += bloom_has(b, (c_str) key);
+    }
+    if (fp < n * 0.015) {
+        printf("bloom_fp_rate: PASSED\n");
+    } else {
+        printf("bloom_fp_rate: FAILED (%d false positives)\n", fp);
+    }
+    bloom_free(b);
+}
+
+// Test function for raw byte keys
+void test_bloom_bytes() {
+    bloom b = bloom_new(10000, 0.001);
+    for (u64 i = 0; i < 10000; i++) {
+        u64 id = i * 2654435761u;
+        bloom_add_bytes(b, &id, sizeof(id));
+    }
+    bool ok = true;
+    int fp = 0;
+    for (u64 i = 0; i < 10000; i++) {
+        u64 id = i * 2654435761u;
+        ok = ok && bloom_has_bytes(b, &id, sizeof(id));
+        id += 1;
+        fp += bloom_has_bytes(b, &id, sizeof(id));
+    }
+    if (ok && fp < 50) {
+        printf("bloom_bytes: PASSED\n");
+    } else {
+        printf("bloom_bytes: FAILED\n");
+    }
+    bloom_free(b);
+}
+
+// Test function for the map helpers
+void test_bloom_map() {
+    map_int m;
+    map_init(m);
+    map_insert(m, "one", 1);
+    map_insert(m, "two", 2);
+    bloom b = bloom_new(100, 0.01);
+    bloom_add_map(b, m);
+    bloom_map_insert(b, m, "three", 3);
+    bool ok = bloom_map_contains(b, m, "one") && bloom_map_contains(b, m, "three");
+    ok = ok && !bloom_map_contains(b, m, "four") && *(int*) map_get(m, "three") == 3;
+    map_remove(m, "one");
+    ok = ok && !bloom_map_contains(b, m, "one");
+    if (ok) {
+        printf("bloom_map: PASSED\n");
+    } else {
+        printf("bloom_map: FAILED\n");
+    }
+    bloom_free(b);
+    map_free(m);
+}
+
+int main() {
+    test_bloom_strings();
+    test_bloom_fp_rate();
+    test_bloom_bytes();
+    test_bloom_map();
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "../std/cpu.h"
+
+unsigned seen[8];
+
+void* probe(void* arg) {
+    seen[(usize) arg] = std_cpu_features();
+    return null;
+}
+
+// Test function for std_cpu_features called from several threads at once
+void test_cpu_features() {
+    pthread_t threads[8];
+    for (usize i = 0; i < 8; i++) {
+        pthread_create(&threads[i], null, probe, (void*) i);
+    }
+    for (int i = 0; i < 8; i++) {
+        pthread_join(threads[i], null);
+    }
+    bool ok = true;
+    for (int i = 0; i < 8; i++) {
+        ok = ok && seen[i] == std_cpu_features();
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    ok = ok && std_cpu_has(STD_CPU_AVX2) == (bool) __builtin_cpu_supports("avx2");
+    ok = ok && std_cpu_has(STD_CPU_SSE42) == (bool) __builtin_cpu_supports("sse4.2");
+#else
+    ok = ok && std_cpu_features() == 0;
+#endif
+    ok = ok && std_cpu_has(0);
+    if (ok) {
+        printf("cpu_features: PASSED\n");
+    } else {
+        printf("cpu_features: FAILED\n");
+    }
+}
+
+int main() {
+    test_cpu_features();
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/deque.h"
+
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+typedef deque(Point) deque_point;
+
+// Test function for deque_push_back and deque_pop_front (FIFO)
+void test_deque_fifo() {
+    deque_int d;
+    deque_init(d);
+    bool ok = true;
+    int next = 0;
+    // keep a few elements alive so head walks around the ring many times
+    for (int i = 0; i < 1000; i++) {
+        deque_push_back(d, i);
+        if (i % 3 == 2) {
+            ok = ok && deque_pop_front(d) == next++;
+            ok = ok && deque_pop_front(d) == next++;
+        }
+    }
+    while (!deque_is_empty(d)) {
+        ok = ok && deque_pop_front(d) == next++;
+    }
+    if (ok && next == 1000) {
+        printf("deque_fifo: PASSED\n");
+    } else {
+        printf("deque_fifo: FAILED\n");
+    }
+    deque_free(d);
+}
+
+// Test function for deque_push_front and deque_pop_back
+void test_deque_front_back() {
+    deque_int d;
+    deque_init(d);
+    for (int i = 0; i < 10; i++) {
+        deque_push_front(d, i);
+    }
+    deque_push_back(d, 100);
+    bool ok = deque_len(d) == 11 && deque_front(d) == 9 && deque_back(d) == 100;
+    ok = ok && deque_pop_back(d) == 100 && deque_pop_back(d) == 0 && deque_pop_front(d) == 9;
+    ok = ok && deque_len(d) == 8 && deque_front(d) == 8 && deque_back(d) == 1;
+    if (ok) {
+        printf("deque_front_back: PASSED\n");
+    } else {
+        printf("deque_front_back: FAILED\n");
+    }
+    deque_free(d);
+}
+
+// Test function for deque_at and growth while wrapped
+void test_deque_at() {
+    deque_point d;
+    deque_init(d);
+    deque_reserve(d, 8);
+    for (int i = 0; i < 6; i++) {
+        deque_push_back(d, ((Point) { i, -i }));
+    }
+    for (int i = 0; i < 4; i++) {
+        (void) deque_pop_front(d);
+    }
+    // head is now at 4, so these wrap before the ring has to grow
+    for (int i = 6; i < 40; i++) {
+        deque_push_back(d, ((Point) { i, -i }));
+    }
+    bool ok = deque_len(d) == 36 && d->cap == 64;
+    for (usize i = 0; i < deque_len(d); i++) {
+        ok = ok && deque_at(d, i).x == (int) i + 4 && deque_at(d, i).y == -((int) i + 4);
+    }
+    if (ok) {
+        printf("deque_at: PASSED\n");
+    } else {
+        printf("deque_at: FAILED\n");
+    }
+    deque_free(d);
+}
+
+// Test function for the bulk push and pop functions
+void test_deque_bulk() {
+    deque_int d;
+    deque_init(d);
+    int in[100], out[100];
+    for (int i = 0; i < 100; i++) {
+        in[i] = i;
+    }
+    deque_reserve(d, 16);
+    deque_push_back_n(d, in, 10);
+    deque_pop_front_n(d, out, 7);
+    // 3 left at index 7..9, the next pushes wrap
+    deque_push_back_n(d, in + 10, 10);
+    deque_push_front_n(d, in + 50, 3);
+    bool ok = deque_len(d) == 16 && d->cap == 16;
+    int expect[] = { 50, 51, 52, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
+    for (int i = 0; i < 16; i++) {
+        ok = ok && deque_at(d, i) == expect[i];
+    }
+    ok = ok && deque_pop_back_n(d, out, 5) == 5 && out[0] == 15 && out[4] == 19;
+    ok = ok && deque_pop_front_n(d, out, 100) == 11 && out[0] == 50 && out[10] == 14;
+    ok = ok && deque_is_empty(d);
+    if (ok) {
+        printf("deque_bulk: PASSED\n");
+    } else {
+        printf("deque_bulk: FAILED\n");
+    }
+    deque_free(d);
+}
+
+// Test function for deque_iter and deque_enum
+void test_deque_iter() {
+    deque_int d;
+    deque_init(d);
+    for (int i = 1; i <= 5; i++) {
+        deque_push_front(d, i);
+    }
+    int sum = 0, val;
+    usize i;
+    bool ok = true;
+    deque_iter(d, val) {
+        sum += val;
+    }
+    deque_enum(d, i, val) {
+        ok = ok && val == 5 - (int) i;
+    }
+    if (ok && sum == 15) {
+        printf("deque_iter: PASSED\n");
+    } else {
+        printf("deque_iter: FAILED\n");
+    }
+    deque_free(d);
+}
+
+int main() {
+    test_deque_fifo();
+    test_deque_front_back();
+    test_deque_at();
+    test_deque_bulk();
+    test_deque_iter();
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/heap.h"
+
+typedef struct {
+    int priority;
+    int id;
+} Job;
+
+typedef heap(Job) heap_job;
+typedef iheap(int) iheap_int;
+
+#define job_less(a, b) ((a).priority < (b).priority)
+#define greater(a, b) ((a) > (b))
+
+// Test function for heap_push and heap_pop
+void test_heap_push_pop() {
+    heap(int) h;
+    heap_init(h);
+    srand(42);
+    for (int i = 0; i < 10000; i++) {
+        heap_push(h, rand() % 1000);
+    }
+    bool ok = heap_len(h) == 10000;
+    int prev = -1, x;
+    while (ok && !heap_is_empty(h)) {
+        int top = heap_top(h);
+        heap_pop(h, x);
+        ok = x == top && x >= prev;
+        prev = x;
+    }
+    if (ok) {
+        printf("heap_push_pop: PASSED\n");
+    } else {
+        printf("heap_push_pop: FAILED\n");
+    }
+    heap_free(h);
+}
+
+// Test function for the _by variants
+void test_heap_by() {
+    heap_job h;
+    heap(int) m;
+    heap_init(h);
+    heap_init(m);
+    for (int i = 0; i < 100; i++) {
+        heap_push_by(h, ((Job) { (i * 37) % 100, i }), job_less);
+        heap_push_by(m, i, greater);
+    }
+    bool ok = true;
+    Job j;
+    int x;
+    for (int i = 0; i < 100; i++) {
+        heap_pop_by(h, j, job_less);
+        heap_pop_by(m, x, greater);
+        ok = ok && j.priority == i && (j.id * 37) % 100 == i && x == 99 - i;
+    }
+    if (ok) {
+        printf("heap_by: PASSED\n");
+    } else {
+        printf("heap_by: FAILED\n");
+    }
+    heap_free(h);
+    heap_free(m);
+}
+
+// Test function for heap_from_vec and heap_heapify
+void test_heap_from_vec() {
+    vec_int v;
+    heap(int) h;
+    vec_init(v);
+    for (int i = 0; i < 1000; i++) {
+        vec_push(v, (i * 7919) % 1000);
+    }
+    heap_from_vec(h, v);
+    bool ok = v == null && heap_len(h) == 1000;
+    int x;
+    for (int i = 0; ok && i < 1000; i++) {
+        heap_pop(h, x);
+        ok = x == i;
+    }
+    if (ok) {
+        printf("heap_from_vec: PASSED\n");
+    } else {
+        printf("heap_from_vec: FAILED\n");
+    }
+    heap_free(h);
+}
+
+// Test function for iheap with decrease-key, running Dijkstra on a small grid
+void test_iheap_dijkstra() {
+    int w = 30, n = w * w;
+    int* dist = malloc(n * sizeof(int));
+    iheap_int h;
+    iheap_init(h);
+    for (int i = 0; i < n; i++) {
+        dist[i] = 1 << 30;
+    }
+    dist[0] = 0;
+    iheap_push(h, 0, 0);
+    int id, d;
+    while (!iheap_is_empty(h)) {
+        iheap_pop(h, id, d);
+        int nb[4] = { id - 1, id + 1, id - w, id + w };
+        for (int k = 0; k < 4; k++) {
+            int to = nb[k];
+            if (to < 0 || to >= n || (k < 2 && to / w != id / w)) continue;
+            // moving right or down costs 1, left or up costs 3
+            int nd = d + (k % 2 ? 1 : 3);
+            if (nd < dist[to]) {
+                bool in = iheap_contains(h, to);
+                dist[to] = nd;
+                if (in) {
+                    iheap_decrease(h, to, nd);
+                } else {
+                    iheap_push(h, to, nd);
+                }
+            }
+        }
+    }
+    bool ok = dist[n - 1] == 2 * (w - 1) && dist[w - 1] == w - 1 && !iheap_contains(h, 0);
+    if (ok) {
+        printf("iheap_dijkstra: PASSED\n");
+    } else {
+        printf("iheap_dijkstra: FAILED\n");
+    }
+    free(dist);
+    iheap_free(h);
+}
+
+// Test function for iheap_push moving an existing id both ways
+void test_iheap_update() {
+    iheap(double) h;
+    iheap_init(h);
+    for (int i = 0; i < 50; i++) {
+        iheap_push(h, i * 3, (double) i);
+    }
+    iheap_push(h, 120, -1.0);
+    iheap_push(h, 0, 100.0);
+    bool ok = iheap_len(h) == 50 && iheap_top_id(h) == 120 && iheap_key(h, 0) == 100.0;
+    usize id = 0;
+    double key, prev = -2.0;
+    while (ok && !iheap_is_empty(h)) {
+        iheap_pop(h, id, key);
+        ok = key >= prev && id % 3 == 0;
+        prev = key;
+    }
+    ok = ok && prev == 100.0 && id == 0;
+    if (ok) {
+        printf("iheap_update: PASSED\n");
+    } else {
+        printf("iheap_update: FAILED\n");
+    }
+    iheap_free(h);
+}
+
+int main() {
+    test_heap_push_pop();
+    test_heap_by();
+    test_heap_from_vec();
+    test_iheap_dijkstra();
+    test_iheap_update();
+    return 0;
+}
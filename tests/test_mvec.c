@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../std/mvec.h"
+
+typedef struct {
+    int id;
+    float score;
+    char tag[8];
+} Row;
+
+typedef mvec(Row) mvec_row;
+typedef mvec(int) mvec_int;
+
+// a fresh path in /tmp that doesn't exist yet
+void temp_path(char* path) {
+    strcpy(path, "/tmp/test_mvec_XXXXXX");
+    close(mkstemp(path));
+    unlink(path);
+}
+
+// Test function for mvec_open with STD_MVEC_CREATE and mvec_push
+void test_mvec_create() {
+    char path[64];
+    temp_path(path);
+    mvec_row v;
+    bool ok = mvec_open(v, path, STD_MVEC_CREATE) == 0 && mvec_len(v) == 0;
+    for (int i = 0; i < 10000; i++) {
+        Row r = { i, i * 0.5f, "row" };
+        ok = ok && mvec_push(v, r) == 0;
+    }
+    ok = ok && mvec_len(v) == 10000 && v->cap >= 10000;
+    ok = ok && mvec_at(v, 9999).id == 9999 && mvec_at(v, 1234).score == 617.0f;
+    ok = ok && mvec_close(v) == 0;
+    if (ok) {
+        printf("mvec_create: PASSED\n");
+    } else {
+        printf("mvec_create: FAILED\n");
+    }
+    unlink(path);
+}
+
+// Test function for reopening an existing file
+void test_mvec_reopen() {
+    char path[64];
+    temp_path(path);
+    mvec_int v;
+    bool ok = mvec_open(v, path, STD_MVEC_CREATE) == 0;
+    if (ok) {
+        int buffer[] = { 5, 6, 7 };
+        mvec_extend_from(v, buffer, 3);
+        mvec_close(v);
+    }
+
+    ok = ok && mvec_open(v, path, STD_MVEC_WRITE) == 0;
+    if (ok) {
+        ok = mvec_len(v) == 3 && mvec_at(v, 2) == 7;
+        (void) mvec_pop(v);
+        mvec_push(v, 8);
+        mvec_close(v);
+    }
+
+    ok = ok && mvec_open(v, path, STD_MVEC_READ) == 0;
+    if (ok) {
+        int sum = 0, x;
+        vec_iter(v, x) {
+            sum += x;
+        }
+        ok = sum == 19 && mvec_push(v, 1) == -1 && mvec_len(v) == 3;
+        mvec_close(v);
+    }
+    if (ok) {
+        printf("mvec_reopen: PASSED\n");
+    } else {
+        printf("mvec_reopen: FAILED\n");
+    }
+    unlink(path);
+}
+
+// Test function for the header checks
+void test_mvec_validate() {
+    char path[64];
+    temp_path(path);
+    mvec_int v;
+    mvec_row r;
+    bool ok = mvec_open(v, path, STD_MVEC_READ) == -1;
+    ok = ok && mvec_open(v, path, STD_MVEC_CREATE) == 0;
+    if (ok) {
+        mvec_push(v, 1);
+        mvec_close(v);
+    }
+    // element size doesn't match
+    ok = ok && mvec_open(r, path, STD_MVEC_READ) == -1 && errno == EINVAL;
+    // a cap whose size in bytes wraps around to the header's
+    FILE* c = fopen(path, "r+");
+    u64 cap = (u64) 1 << 62;
+    fseek(c, offsetof(mvec_header, cap), SEEK_SET);
+    fwrite(&cap, sizeof(cap), 1, c);
+    fclose(c);
+    ok = ok && mvec_open(v, path, STD_MVEC_READ) == -1 && errno == EINVAL;
+    // not a mvec file
+    FILE* f = fopen(path, "r+");
+    fwrite("garbage!", 1, 8, f);
+    fclose(f);
+    ok = ok && mvec_open(v, path, STD_MVEC_READ) == -1 && errno == EINVAL;
+    if (ok) {
+        printf("mvec_validate: PASSED\n");
+    } else {
+        printf("mvec_validate: FAILED\n");
+    }
+    unlink(path);
+}
+
+// Test function for mvec_flush and mvec_refresh between a writer and a reader
+void test_mvec_flush_refresh() {
+    char path[64];
+    temp_path(path);
+    mvec_int w, r;
+    if (mvec_open(w, path, STD_MVEC_CREATE) != 0) {
+        printf("mvec_flush_refresh: FAILED\n");
+        return;
+    }
+    mvec_push(w, 1);
+    mvec_flush(w);
+    bool ok = mvec_open(r, path, STD_MVEC_READ) == 0;
+    if (ok) {
+        ok = mvec_len(r) == 1;
+        for (int i = 2; i <= 100000; i++) {
+            mvec_push(w, i);
+        }
+        // not flushed yet, the reader still sees the old length
+        ok = ok && mvec_refresh(r) == 0 && mvec_len(r) == 1;
+        ok = ok && mvec_flush(w) == 0;
+        ok = ok && mvec_refresh(r) == 0 && mvec_len(r) == 100000 && mvec_at(r, 99999) == 100000;
+        usize i;
+        vec_lower_bound(r, 5000, i);
+        ok = ok && i == 4999;
+        mvec_close(r);
+    }
+    mvec_close(w);
+    if (ok) {
+        printf("mvec_flush_refresh: PASSED\n");
+    } else {
+        printf("mvec_flush_refresh: FAILED\n");
+    }
+    unlink(path);
+}
+
+int main() {
+    test_mvec_create();
+    test_mvec_reopen();
+    test_mvec_validate();
+    test_mvec_flush_refresh();
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../std/array.h"
+#include "../std/num.h"
+#include "../std/vec.h"
+
+// sizes around the vector widths and unroll factors, plus a big one
+static const usize sizes[] = { 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 100, 1000, 100003 };
+#define NSIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+// Test function for num_sum and num_mean
+void test_num_sum() {
+    bool ok = true;
+    for (usize s = 0; s < NSIZES; s++) {
+        vec_double d;
+        vec_int n;
+        vec_init(d);
+        vec_init(n);
+        double expect = 0;
+        i64 iexpect = 0;
+        for (usize i = 0; i < sizes[s]; i++) {
+            vec_push(d, (double) (i % 17) * 0.5);
+            vec_push(n, (int) (i * 2654435761u));
+            expect += (double) (i % 17) * 0.5;
+            iexpect += (int) (i * 2654435761u);
+        }
+        ok = ok && num_sum(d) == expect && num_sum(n) == iexpect;
+        ok = ok && num_mean(d) == expect / sizes[s];
+        vec_free(d);
+        vec_free(n);
+    }
+    if (ok) {
+        printf("num_sum: PASSED\n");
+    } else {
+        printf("num_sum: FAILED\n");
+    }
+}
+
+// Test function for num_sum_pairwise and num_sum_kahan on float
+void test_num_sum_accuracy() {
+    array_float a;
+    usize n = 10000000;
+    array_init(a, n);
+    for (usize i = 0; i < n; i++) {
+        a->data[i] = 0.1f;
+    }
+    double exact = (double) 0.1f * n;
+    float plain = 0;
+    for (usize i = 0; i < n; i++) {
+        plain += a->data[i];
+    }
+    float pairwise = num_sum_pairwise(a);
+    float kahan = num_sum_kahan(a);
+    bool ok = fabs(pairwise - exact) / exact < 1e-6 && fabs(kahan - exact) / exact < 1e-6;
+    ok = ok && fabs(num_sum(a) - exact) < fabs(plain - exact);
+    if (ok) {
+        printf("num_sum_accuracy: PASSED\n");
+    } else {
+        printf("num_sum_accuracy: FAILED\n");
+    }
+    array_free(a);
+}
+
+// Test function for num_min, num_max, num_argmin and num_argmax
+void test_num_minmax() {
+    bool ok = true;
+    for (usize s = 0; s < NSIZES; s++) {
+        usize n = sizes[s];
+        array_float f;
+        array_double d;
+        array_int x;
+        array_init(f, n);
+        array_init(d, n);
+        array_init(x, n);
+        for (usize i = 0; i < n; i++) {
+            f->data[i] = d->data[i] = x->data[i] = (int) ((i * 7919) % 1009) - 500;
+        }
+        // plant each extreme twice, the first one has to win
+        usize first = n / 3, second = n - 1;
+        f->data[first] = d->data[first] = x->data[first] = -1000;
+        f->data[second] = d->data[second] = x->data[second] = -1000;
+        ok = ok && num_min(f) == -1000 && num_min(d) == -1000 && num_min(x) == -1000;
+        ok = ok && num_argmin(f) == first && num_argmin(d) == first && num_argmin(x) == first;
+        f->data[first] = d->data[first] = x->data[first] = 1000;
+        f->data[second] = d->data[second] = x->data[second] = 1000;
+        ok = ok && num_max(f) == 1000 && num_max(d) == 1000 && num_max(x) == 1000;
+        ok = ok && num_argmax(f) == first && num_argmax(d) == first && num_argmax(x) == first;
+        array_free(f);
+        array_free(d);
+        array_free(x);
+    }
+    // NaN never compares equal to the min found, the index still has to stay in range
+    array_double nan;
+    array_init(nan, 37);
+    for (usize i = 0; i < 37; i++) {
+        nan->data[i] = i % 2 ? 0.0 / 0.0 : (double) i;
+    }
+    nan->data[0] = 0.0 / 0.0;
+    ok = ok && num_argmin(nan) < 37 && num_argmax(nan) < 37;
+    array_free(nan);
+    if (ok) {
+        printf("num_minmax: PASSED\n");
+    } else {
+        printf("num_minmax: FAILED\n");
+    }
+}
+
+// Test function for num_dot and num_norm
+void test_num_dot() {
+    bool ok = true;
+    for (usize s = 0; s < NSIZES; s++) {
+        usize n = sizes[s];
+        vec_float a, b;
+        vec_int x, y;
+        vec_init(a);
+        vec_init(b);
+        vec_init(x);
+        vec_init(y);
+        float fexpect = 0;
+        i64 iexpect = 0;
+        for (usize i = 0; i < n; i++) {
+            vec_push(a, (float) (i % 4));
+            vec_push(b, 0.5f);
+            vec_push(x, 100000 + (int) i);
+            vec_push(y, -100000);
+            fexpect += (float) (i % 4) * 0.5f;
+            iexpect += (i64) (100000 + i) * -100000;
+        }
+        ok = ok && num_dot(a, b) == fexpect && num_dot(x, y) == iexpect;
+        ok = ok && fabs(num_norm(b) - sqrt(0.25 * n)) < 1e-6;
+        vec_free(a);
+        vec_free(b);
+        vec_free(x);
+        vec_free(y);
+    }
+    if (ok) {
+        printf("num_dot: PASSED\n");
+    } else {
+        printf("num_dot: FAILED\n");
+    }
+}
+
+// Test function for num_axpy and num_scale
+void test_num_axpy_scale() {
+    bool ok = true;
+    for (usize s = 0; s < NSIZES; s++) {
+        usize n = sizes[s];
+        array_double x, y;
+        array_int k;
+        array_init(x, n);
+        array_init(y, n);
+        array_init(k, n);
+        for (usize i = 0; i < n; i++) {
+            x->data[i] = i;
+            y->data[i] = 1;
+            k->data[i] = i;
+        }
+        num_axpy(y, 2.0, x);
+        num_scale(x, 0.5);
+        num_scale(k, 3);
+        for (usize i = 0; i < n; i++) {
+            ok = ok && y->data[i] == 1 + 2.0 * i && x->data[i] == 0.5 * i && k->data[i] == 3 * (int) i;
+        }
+        array_free(x);
+        array_free(y);
+        array_free(k);
+    }
+    if (ok) {
+        printf("num_axpy_scale: PASSED\n");
+    } else {
+        printf("num_axpy_scale: FAILED\n");
+    }
+}
+
+// Test function for the baseline kernels matching the dispatched ones
+void test_num_dispatch() {
+    usize n = 1003;
+    float* x = malloc(n * sizeof(float));
+    for (usize i = 0; i < n; i++) {
+        x[i] = (float) ((i * 37) % 101) - 50.5f;
+    }
+    bool ok = __num_sum_float_base(x, n) == __num_sum_float(x, n);
+    ok = ok && __num_min_float_base(x, n) == __num_min_float(x, n);
+    ok = ok && __num_max_float_base(x, n) == __num_max_float(x, n);
+    ok = ok && __num_dot_float_base(x, x, n) == __num_dot_float(x, x, n);
+    if (ok) {
+        printf("num_dispatch: PASSED\n");
+    } else {
+        printf("num_dispatch: FAILED\n");
+    }
+    free(x);
+}
+
+int main() {
+    test_num_sum();
+    test_num_sum_accuracy();
+    test_num_minmax();
+    test_num_dot();
+    test_num_axpy_scale();
+    test_num_dispatch();
+    return 0;
+}
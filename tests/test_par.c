@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+// more threads than cores is fine, it makes sure the pool gets used
+#define STD_PAR_THREADS 4
+#include "../std/array.h"
+#include "../std/par.h"
+#include "../std/vec.h"
+
+#define N 1000000
+
+void twice(double* x) {
+    *x *= 2;
+}
+
+void square(double* out, const int* in) {
+    *out = (double) *in * *in;
+}
+
+void add(long* acc, const long* x) {
+    *acc += *x;
+}
+
+void add_int(int* acc, const int* x) {
+    *acc += *x;
+}
+
+// non-commutative: keeps the first and last value seen
+typedef struct {
+    int first;
+    int last;
+} Span;
+
+void join(Span* acc, const Span* x) {
+    if (acc->first < 0) acc->first = x->first;
+    if (x->last >= 0) acc->last = x->last;
+}
+
+par_fn1(twice_fn, double, twice)
+par_fn2(square_fn, double, int, square)
+par_fn2(add_fn, long, long, add)
+par_fn2(add_int_fn, int, int, add_int)
+par_fn2(join_fn, Span, Span, join)
+
+// Test function for par_for_each
+void test_par_for_each() {
+    vec_double v;
+    vec_init(v);
+    for (int i = 0; i < N; i++) {
+        vec_push(v, i);
+    }
+    par_for_each(v, twice_fn);
+    bool ok = true;
+    for (int i = 0; i < N; i++) {
+        ok = ok && v->data[i] == 2.0 * i;
+    }
+    if (ok && par_threads() == 4) {
+        printf("par_for_each: PASSED\n");
+    } else {
+        printf("par_for_each: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for par_transform
+void test_par_transform() {
+    array_int a;
+    array_double b;
+    array_init(a, N);
+    array_init(b, N);
+    for (int i = 0; i < N; i++) {
+        a->data[i] = i % 1000;
+    }
+    par_transform(b, a, square_fn);
+    bool ok = true;
+    for (int i = 0; i < N; i++) {
+        ok = ok && b->data[i] == (double) (i % 1000) * (i % 1000);
+    }
+    if (ok) {
+        printf("par_transform: PASSED\n");
+    } else {
+        printf("par_transform: FAILED\n");
+    }
+    array_free(a);
+    array_free(b);
+}
+
+// Test function for par_reduce
+void test_par_reduce() {
+    vec(long) v;
+    vec_init(v);
+    for (long i = 0; i < N; i++) {
+        vec_push(v, i);
+    }
+    // acc doesn't have to start at the identity, it's folded in once
+    long sum = 5;
+    par_reduce(v, sum, 0, add_fn);
+
+    array(Span) s;
+    array_init(s, N);
+    for (int i = 0; i < N; i++) {
+        s->data[i] = (Span) { i, i };
+    }
+    Span ends = { -1, -1 };
+    par_reduce(s, ends, ((Span) { -1, -1 }), join_fn);
+
+    if (sum == 5 + (long) N * (N - 1) / 2 && ends.first == 0 && ends.last == N - 1) {
+        printf("par_reduce: PASSED\n");
+    } else {
+        printf("par_reduce: FAILED\n");
+    }
+    vec_free(v);
+    array_free(s);
+}
+
+// Test function for par_inclusive_scan and par_exclusive_scan
+void test_par_scan() {
+    array_int a, inc;
+    array_init(a, N);
+    array_init(inc, N);
+    for (int i = 0; i < N; i++) {
+        a->data[i] = i % 7;
+    }
+    par_inclusive_scan(inc, a, 0, add_int_fn);
+    // in place
+    par_exclusive_scan(a, a, 0, add_int_fn);
+    bool ok = true;
+    int run = 0;
+    for (int i = 0; i < N; i++) {
+        ok = ok && a->data[i] == run;
+        run += i % 7;
+        ok = ok && inc->data[i] == run;
+    }
+    if (ok) {
+        printf("par_scan: PASSED\n");
+    } else {
+        printf("par_scan: FAILED\n");
+    }
+    array_free(a);
+    array_free(inc);
+}
+
+// Test function for short ranges, which run sequentially
+void test_par_small() {
+    vec_int v;
+    vec_init(v);
+    for (int i = 1; i <= 10; i++) {
+        vec_push(v, i);
+    }
+    int sum = 0;
+    par_reduce(v, sum, 0, add_int_fn);
+    par_exclusive_scan(v, v, 0, add_int_fn);
+    if (sum == 55 && v->data[0] == 0 && v->data[9] == 45) {
+        printf("par_small: PASSED\n");
+    } else {
+        printf("par_small: FAILED\n");
+    }
+    vec_free(v);
+}
+
+void count_range(void* ctx, usize begin, usize end) {
+    atomic_fetch_add((atomic_size_t*) ctx, end - begin);
+}
+
+// Test function for par_for
+void test_par_for() {
+    atomic_size_t count = 0;
+    par_for(N, count_range, &count);
+    if (count == N) {
+        printf("par_for: PASSED\n");
+    } else {
+        printf("par_for: FAILED\n");
+    }
+}
+
+// Test function for par_first_touch
+void test_par_first_touch() {
+    array_double a;
+    array_init_aligned(a, N, 64);
+    a->data[N / 2] = 3;
+    par_first_touch(a);
+    vec_int v;
+    vec_init(v);
+    par_first_touch(v);
+    if (a->data[N / 2] == 3 && a->data[0] == 0 && a->data[N - 1] == 0) {
+        printf("par_first_touch: PASSED\n");
+    } else {
+        printf("par_first_touch: FAILED\n");
+    }
+    vec_free(v);
+    array_free(a);
+}
+
+int main() {
+    test_par_for_each();
+    test_par_transform();
+    test_par_reduce();
+    test_par_scan();
+    test_par_small();
+    test_par_for();
+    test_par_first_touch();
+    return 0;
+}
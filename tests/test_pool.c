@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+// back map entries and str headers with pools too
+#ifndef STD_USE_POOL
+#define STD_USE_POOL
+#endif
+#include "../std/map.h"
+#include "../std/pool.h"
+#include "../std/str.h"
+
+typedef struct {
+    int x;
+    int y;
+    double z;
+} Point;
+
+// Test function for pool_alloc
+void test_pool_alloc() {
+    pool p = pool_new(sizeof(Point));
+    Point* a = pool_alloc(p);
+    Point* b = pool_alloc(p);
+    a->x = 1;
+    b->x = 2;
+    if (a != b && a->x == 1 && b->x == 2 && pool_live(p) == 2 && (uintptr_t) a % sizeof(void*) == 0) {
+        printf("pool_alloc: PASSED\n");
+    } else {
+        printf("pool_alloc: FAILED\n");
+    }
+    pool_free(p);
+}
+
+// Test function for pool_release
+void test_pool_release() {
+    pool p = pool_new(sizeof(Point));
+    Point* a = pool_alloc(p);
+    pool_release(p, a);
+    Point* b = pool_alloc(p);
+    if (a == b && pool_live(p) == 1) {
+        printf("pool_release: PASSED\n");
+    } else {
+        printf("pool_release: FAILED\n");
+    }
+    pool_free(p);
+}
+
+// Test function for many objects spanning several slabs
+void test_pool_slabs() {
+    pool p = pool_new(sizeof(Point));
+    int n = 100000;
+    Point** objs = malloc(n * sizeof(Point*));
+    for (int i = 0; i < n; i++) {
+        objs[i] = pool_alloc(p);
+        objs[i]->x = i;
+    }
+    bool ok = pool_live(p) == (usize) n;
+    for (int i = 0; i < n; i++) {
+        ok = ok && objs[i]->x == i;
+    }
+    for (int i = 0; i < n; i += 2) {
+        pool_release(p, objs[i]);
+    }
+    ok = ok && pool_live(p) == (usize) n / 2;
+    if (ok) {
+        printf("pool_slabs: PASSED\n");
+    } else {
+        printf("pool_slabs: FAILED\n");
+    }
+    free(objs);
+    pool_free(p);
+}
+
+pool shared;
+
+void* cache_worker(void* arg) {
+    (void) arg;
+    pool_cache c = pool_cache_new(shared);
+    void* objs[1000];
+    for (int round = 0; round < 100; round++) {
+        for (int i = 0; i < 1000; i++) {
+            objs[i] = pool_cache_alloc(&c);
+            *(int*) objs[i] = i;
+        }
+        for (int i = 0; i < 1000; i++) {
+            if (*(int*) objs[i] != i) return (void*) 1;
+            pool_cache_release(&c, objs[i]);
+        }
+    }
+    pool_cache_flush(&c);
+    return null;
+}
+
+// Test function for pool_cache shared between threads
+void test_pool_cache() {
+    shared = pool_new(sizeof(Point));
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], null, cache_worker, null);
+    }
+    bool ok = true;
+    for (int i = 0; i < 4; i++) {
+        void* ret;
+        pthread_join(threads[i], &ret);
+        ok = ok && ret == null;
+    }
+    if (ok && pool_live(shared) == 0) {
+        printf("pool_cache: PASSED\n");
+    } else {
+        printf("pool_cache: FAILED\n");
+    }
+    pool_free(shared);
+}
+
+#define NSTRS 10000
+
+void* str_maker(void* arg) {
+    str* strs = arg;
+    for (int i = 0; i < NSTRS; i++) {
+        strs[i] = str_from("pooled");
+    }
+    return null;
+}
+
+void* str_freer(void* arg) {
+    str* strs = arg;
+    for (int i = 0; i < NSTRS; i++) {
+        str_free(strs[i]);
+    }
+    return null;
+}
+
+// Test function for map entries and str headers with STD_USE_POOL
+void test_pool_map_str() {
+    map_int m;
+    map_init(m);
+    char key[16];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(key, "k%d", i);
+        map_insert(m, key, i);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        sprintf(key, "k%d", i);
+        map_remove(m, key);
+    }
+    bool ok = map_size(m) == 500 && pool_live(m->entry_pool) == 500 && *(int*) map_get(m, "k7") == 7;
+    map_free(m);
+    // made on one thread and freed on another, both gone before checking: every header
+    // has to be back in the shared pool
+    str* strs = malloc(NSTRS * sizeof(str));
+    pthread_t t;
+    pthread_create(&t, null, str_maker, strs);
+    pthread_join(t, null);
+    pthread_create(&t, null, str_freer, strs);
+    pthread_join(t, null);
+    ok = ok && __str_pool != null && pool_live(__str_pool) == 0;
+    free(strs);
+    if (ok) {
+        printf("pool_map_str: PASSED\n");
+    } else {
+        printf("pool_map_str: FAILED\n");
+    }
+}
+
+int main() {
+    test_pool_alloc();
+    test_pool_release();
+    test_pool_slabs();
+    test_pool_cache();
+    test_pool_map_str();
+    return 0;
+}
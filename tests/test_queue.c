@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../std/queue.h"
+
+typedef struct {
+    u64 seq;
+    u64 check;
+} Msg;
+
+typedef spsc(int) spsc_int;
+typedef spsc(Msg) spsc_msg;
+typedef mpmc(int) mpmc_int;
+typedef mpmc(Msg) mpmc_msg;
+
+#define COUNT 1000000
+
+// Test function for spsc_push and spsc_pop on one thread
+void test_spsc_basic() {
+    spsc_int q;
+    spsc_init(q, 5);
+    bool ok = spsc_cap(q) == 8 && spsc_len(q) == 0;
+    int x = -1;
+    ok = ok && spsc_pop(q, x) == -1 && x == -1;
+    for (int i = 0; i < 8; i++) {
+        ok = ok && spsc_push(q, i) == 0;
+    }
+    ok = ok && spsc_push(q, 8) == -1 && spsc_len(q) == 8;
+    // wrap around a few times
+    for (int i = 0; i < 100; i++) {
+        ok = ok && spsc_pop(q, x) == 0 && x == i && spsc_push(q, i + 8) == 0;
+    }
+    ok = ok && spsc_len(q) == 8;
+    if (ok) {
+        printf("spsc_basic: PASSED\n");
+    } else {
+        printf("spsc_basic: FAILED\n");
+    }
+    spsc_free(q);
+}
+
+// Test function for spsc_push_n and spsc_pop_n across the wrap
+void test_spsc_batch() {
+    spsc_int q;
+    spsc_init(q, 16);
+    int in[32], out[32];
+    for (int i = 0; i < 32; i++) {
+        in[i] = i;
+    }
+    bool ok = spsc_push_n(q, in, 10) == 10 && spsc_pop_n(q, out, 10) == 10;
+    // head and tail are at 10 now, the next 16 wrap
+    ok = ok && spsc_push_n(q, in, 32) == 16 && spsc_push_n(q, in, 1) == 0;
+    ok = ok && spsc_pop_n(q, out, 4) == 4 && spsc_pop_n(q, out + 4, 32) == 12;
+    for (int i = 0; i < 16; i++) {
+        ok = ok && out[i] == i;
+    }
+    ok = ok && spsc_pop_n(q, out, 1) == 0;
+    if (ok) {
+        printf("spsc_batch: PASSED\n");
+    } else {
+        printf("spsc_batch: FAILED\n");
+    }
+    spsc_free(q);
+}
+
+void* producer(void* arg) {
+    spsc_msg q = arg;
+    Msg batch[37];
+    u64 seq = 0;
+    while (seq < COUNT) {
+        // alternate single and batch pushes
+        if (seq % 2 == 0) {
+            Msg m = { seq, seq * 31 };
+            if (spsc_push(q, m) == 0) seq++;
+            else sched_yield();
+        } else {
+            usize n = 0;
+            for (; n < 37 && seq + n < COUNT; n++) {
+                batch[n] = (Msg) { seq + n, (seq + n) * 31 };
+            }
+            usize done = spsc_push_n(q, batch, n);
+            if (done == 0) sched_yield();
+            seq += done;
+        }
+    }
+    return null;
+}
+
+// Test function for a producer and a consumer thread
+void test_spsc_threads() {
+    spsc_msg q;
+    spsc_init(q, 1024);
+    pthread_t t;
+    pthread_create(&t, null, producer, q);
+    bool ok = true;
+    u64 next = 0;
+    Msg batch[50];
+    while (next < COUNT) {
+        usize n = spsc_pop_n(q, batch, 50);
+        if (n == 0) sched_yield();
+        for (usize i = 0; i < n; i++, next++) {
+            ok = ok && batch[i].seq == next && batch[i].check == next * 31;
+        }
+    }
+    pthread_join(t, null);
+    ok = ok && spsc_len(q) == 0;
+    if (ok) {
+        printf("spsc_threads: PASSED\n");
+    } else {
+        printf("spsc_threads: FAILED\n");
+    }
+    spsc_free(q);
+}
+
+// Test function for mpmc_try_push and mpmc_try_pop on one thread
+void test_mpmc_basic() {
+    mpmc_int q;
+    mpmc_init(q, 4);
+    int x = -1;
+    bool ok = mpmc_cap(q) == 4 && mpmc_try_pop(q, x) == -1 && x == -1;
+    for (int i = 0; i < 4; i++) {
+        ok = ok && mpmc_try_push(q, i) == 0;
+    }
+    ok = ok && mpmc_try_push(q, 4) == -1 && mpmc_len(q) == 4;
+    for (int i = 0; i < 50; i++) {
+        ok = ok && mpmc_try_pop(q, x) == 0 && x == i && mpmc_try_push(q, i + 4) == 0;
+    }
+    if (ok) {
+        printf("mpmc_basic: PASSED\n");
+    } else {
+        printf("mpmc_basic: FAILED\n");
+    }
+    mpmc_free(q);
+}
+
+#define THREADS 4
+#define PER_THREAD 200000
+
+mpmc_msg fan;
+u64 totals[THREADS];
+
+void* fan_producer(void* arg) {
+    u64 id = (u64) (usize) arg;
+    for (u64 i = 0; i < PER_THREAD; i++) {
+        Msg m = { id, i };
+        mpmc_push(fan, m);
+    }
+    return null;
+}
+
+void* fan_consumer(void* arg) {
+    u64 id = (u64) (usize) arg;
+    u64 last[THREADS];
+    memset(last, 0, sizeof(last));
+    bool ordered = true;
+    Msg m;
+    for (;;) {
+        mpmc_pop(fan, m);
+        if (m.seq == THREADS) break;
+        // one consumer sees each producer's messages in the order they were pushed
+        ordered = ordered && (m.check == 0 || m.check > last[m.seq]);
+        last[m.seq] = m.check;
+        totals[id] += m.check + 1;
+    }
+    if (!ordered) totals[id] = 0;
+    return null;
+}
+
+// Test function for blocking mpmc_push and mpmc_pop between several threads
+void test_mpmc_threads() {
+    mpmc_init(fan, 64);
+    pthread_t producers[THREADS], consumers[THREADS];
+    for (usize i = 0; i < THREADS; i++) {
+        pthread_create(&consumers[i], null, fan_consumer, (void*) i);
+        pthread_create(&producers[i], null, fan_producer, (void*) i);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(producers[i], null);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        Msg stop = { THREADS, 0 };
+        mpmc_push(fan, stop);
+    }
+    u64 sum = 0;
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(consumers[i], null);
+        sum += totals[i];
+    }
+    if (sum == (u64) THREADS * PER_THREAD * (PER_THREAD + 1) / 2 && mpmc_len(fan) == 0) {
+        printf("mpmc_threads: PASSED\n");
+    } else {
+        printf("mpmc_threads: FAILED\n");
+    }
+    mpmc_free(fan);
+}
+
+int main() {
+    test_spsc_basic();
+    test_spsc_batch();
+    test_spsc_threads();
+    test_mpmc_basic();
+    test_mpmc_threads();
+    return 0;
+}
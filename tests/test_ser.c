@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../std/ser.h"
+#include "../std/span.h"
+
+typedef struct {
+    int id;
+    double value;
+} Record;
+
+typedef vec(Record) vec_record;
+
+// Test function for ser_dump and ser_load_vec through a FILE*
+void test_ser_vec() {
+    FILE* f = tmpfile();
+    vec_record v, w;
+    vec_init(v);
+    vec_init(w);
+    for (int i = 0; i < 100000; i++) {
+        vec_push(v, ((Record) { i, i * 0.25 }));
+    }
+    vec_push(w, ((Record) { -1, -1 }));
+    bool ok = ser_dump(ser_file(f), v, STD_SER_CRC) == 0;
+    rewind(f);
+    ok = ok && ser_load_vec(ser_file(f), w) == 0 && w->len == 100000;
+    ok = ok && memcmp(v->data, w->data, v->len * sizeof(Record)) == 0;
+    if (ok) {
+        printf("ser_vec: PASSED\n");
+    } else {
+        printf("ser_vec: FAILED\n");
+    }
+    fclose(f);
+    vec_free(v);
+    vec_free(w);
+}
+
+// Test function for ser_dump and ser_load_array through a file descriptor
+void test_ser_array() {
+    char path[] = "/tmp/test_ser_XXXXXX";
+    int fd = mkstemp(path);
+    array_double a, b;
+    array_init(a, 1000);
+    array_init(b, 0);
+    for (int i = 0; i < 1000; i++) {
+        a->data[i] = i / 3.0;
+    }
+    bool ok = ser_dump(ser_fd(fd), a, 0) == 0;
+    lseek(fd, 0, SEEK_SET);
+    ok = ok && ser_load_array(ser_fd(fd), b) == 0 && b->len == 1000 && b->data[999] == a->data[999];
+    if (ok) {
+        printf("ser_array: PASSED\n");
+    } else {
+        printf("ser_array: FAILED\n");
+    }
+    close(fd);
+    unlink(path);
+    array_free(a);
+    array_free(b);
+}
+
+// Test function for ser_dump_strs and ser_load_strs
+void test_ser_strs() {
+    FILE* f = tmpfile();
+    int n = 50000;
+    array_str a, b;
+    array_init(a, n + 1);
+    array_init(b, 0);
+    for (int i = 0; i < n; i++) {
+        a->data[i] = str_format("string number %d", i);
+    }
+    // bigger than a block, so it straddles several reads
+    a->data[n] = str_alloc(3 * STD_SER_BLOCK + 7);
+    memset(a->data[n]->chars, 'x', a->data[n]->len);
+    bool ok = ser_dump_strs(ser_file(f), a, STD_SER_CRC) == 0;
+    rewind(f);
+    ok = ok && ser_load_strs(ser_file(f), b) == 0 && b->len == a->len;
+    for (usize i = 0; ok && i < a->len; i++) {
+        ok = str_equals(a->data[i], b->data[i]);
+    }
+    if (ok) {
+        printf("ser_strs: PASSED\n");
+    } else {
+        printf("ser_strs: FAILED\n");
+    }
+    fclose(f);
+    for (usize i = 0; i < a->len; i++) {
+        str_free(a->data[i]);
+    }
+    for (usize i = 0; i < b->len; i++) {
+        str_free(b->data[i]);
+    }
+    array_free(a);
+    array_free(b);
+}
+
+// Test function for several dumps in one stream
+void test_ser_sequence() {
+    FILE* f = tmpfile();
+    vec_int v, w;
+    array_str s, t;
+    vec_init(v);
+    vec_init(w);
+    array_init(s, 2);
+    array_init(t, 0);
+    vec_push(v, 1);
+    vec_push(v, 2);
+    s->data[0] = str_from("a");
+    s->data[1] = str_from("bc");
+    ser_dump(ser_file(f), v, 0);
+    ser_dump_strs(ser_file(f), s, STD_SER_CRC);
+    ser_dump(ser_file(f), v, STD_SER_CRC);
+    rewind(f);
+    bool ok = ser_load_vec(ser_file(f), w) == 0 && w->len == 2;
+    ok = ok && ser_load_strs(ser_file(f), t) == 0 && t->len == 2 && str_equals(t->data[1], (c_str) "bc");
+    ok = ok && ser_load_vec(ser_file(f), w) == 0 && w->len == 2 && w->data[1] == 2;
+    ok = ok && fgetc(f) == EOF;
+    if (ok) {
+        printf("ser_sequence: PASSED\n");
+    } else {
+        printf("ser_sequence: FAILED\n");
+    }
+    fclose(f);
+    vec_free(v);
+    vec_free(w);
+    for (int i = 0; i < 2; i++) {
+        str_free(s->data[i]);
+        str_free(t->data[i]);
+    }
+    array_free(s);
+    array_free(t);
+}
+
+typedef span(Record) span_record;
+
+// Test function for ser_map pointing a span at a dump in place
+void test_ser_map() {
+    FILE* f = tmpfile();
+    vec_record v;
+    vec_init(v);
+    for (int i = 0; i < 100; i++) {
+        vec_push(v, ((Record) { i, i * 0.5 }));
+    }
+    ser_dump(ser_file(f), v, STD_SER_CRC);
+    ser_dump(ser_file(f), v, STD_SER_CRC);
+    vec_push(v, ((Record) { 100, 50 }));
+    ser_dump(ser_file(f), v, 0);
+    rewind(f);
+    span_record s;
+    ser_mapping m;
+    bool ok = ser_map(ser_file(f), s, m) == 0 && s.len == 100 && s.data[99].value == 49.5;
+    ok = ok && memcmp(s.data, v->data, 100 * sizeof(Record)) == 0;
+    // writes don't reach the file
+    s.data[0].id = -1;
+    ok = ok && ser_unmap(m) == 0;
+    // the crc leaves the second payload 4 bytes off the 8 a Record needs, so it's read instead
+    vec_record w;
+    vec_init(w);
+    ok = ok && ser_map(ser_file(f), s, m) == -1 && errno == EINVAL;
+    ok = ok && ser_load_vec(ser_file(f), w) == 0 && w->len == 100;
+    ok = ok && ser_map(ser_file(f), s, m) == 0 && s.len == 101 && s.data[100].id == 100;
+    ok = ok && ser_unmap(m) == 0 && fgetc(f) == EOF;
+    rewind(f);
+    ok = ok && ser_load_vec(ser_file(f), w) == 0 && w->data[0].id == 0;
+    // a flipped payload byte
+    fseek(f, sizeof(ser_header) + 10, SEEK_SET);
+    fputc(0x7f, f);
+    rewind(f);
+    ok = ok && ser_map(ser_file(f), s, m) == -1 && errno == EBADMSG;
+    int fds[2];
+    ok = ok && pipe(fds) == 0 && ser_map(ser_fd(fds[0]), s, m) == -1 && errno == ESPIPE;
+    close(fds[0]);
+    close(fds[1]);
+    if (ok) {
+        printf("ser_map: PASSED\n");
+    } else {
+        printf("ser_map: FAILED\n");
+    }
+    fclose(f);
+    vec_free(v);
+    vec_free(w);
+}
+
+// Test function for rejecting bad input
+void test_ser_bad_input() {
+    FILE* f = tmpfile();
+    vec_int v;
+    vec_double d;
+    vec_init(v);
+    vec_init(d);
+    for (int i = 0; i < 100; i++) {
+        vec_push(v, i);
+    }
+    ser_dump(ser_file(f), v, STD_SER_CRC);
+    // wrong element type
+    rewind(f);
+    bool ok = ser_load_vec(ser_file(f), d) == -1 && errno == EINVAL;
+    // flipped payload byte
+    fseek(f, sizeof(ser_header) + 10, SEEK_SET);
+    fputc(0x7f, f);
+    rewind(f);
+    ok = ok && ser_load_vec(ser_file(f), v) == -1 && errno == EBADMSG;
+    // truncated
+    FILE* g = tmpfile();
+    fwrite("STDSER", 1, 6, g);
+    rewind(g);
+    ok = ok && ser_load_vec(ser_file(g), v) == -1 && errno == EINVAL;
+    // counts and lengths far bigger than the file
+    array_str a;
+    array_init(a, 0);
+    ser_header h = { "STDSER", STD_SER_VERSION, 0, (u64) 1 << 40, 0, 0 };
+    rewind(g);
+    fwrite(&h, sizeof(h), 1, g);
+    rewind(g);
+    ok = ok && ser_load_strs(ser_file(g), a) == -1 && errno == EINVAL && a->len == 0;
+    u64 lens[2] = { 3, (u64) 1 << 50 };
+    h.len = 2;
+    rewind(g);
+    fwrite(&h, sizeof(h), 1, g);
+    fwrite(lens, sizeof(lens), 1, g);
+    fwrite("abc", 1, 3, g);
+    rewind(g);
+    ok = ok && ser_load_strs(ser_file(g), a) == -1 && errno == EINVAL && a->len == 0;
+    // through a pipe the size isn't known, the count just runs out of input
+    int fds[2];
+    ok = ok && pipe(fds) == 0;
+    h.len = (u64) 1 << 40;
+    ok = ok && write(fds[1], &h, sizeof(h)) == sizeof(h) && write(fds[1], lens, sizeof(lens)) == sizeof(lens);
+    close(fds[1]);
+    ok = ok && ser_load_strs(ser_fd(fds[0]), a) == -1 && errno == EINVAL && a->len == 0;
+    close(fds[0]);
+    array_free(a);
+    if (ok) {
+        printf("ser_bad_input: PASSED\n");
+    } else {
+        printf("ser_bad_input: FAILED\n");
+    }
+    fclose(f);
+    fclose(g);
+    vec_free(v);
+    vec_free(d);
+}
+
+int main() {
+    test_ser_vec();
+    test_ser_array();
+    test_ser_strs();
+    test_ser_sequence();
+    test_ser_map();
+    test_ser_bad_input();
+    return 0;
+}
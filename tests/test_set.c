@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/set.h"
+#include "../std/vec.h"
+
+// n sorted distinct values, each of [0, n * spread) with probability 1 / spread
+void random_set_u32(vec_u32 v, usize n, u32 spread) {
+    vec_clear(v);
+    for (u32 x = 0; v->len < n; x++) {
+        if (rand() % spread == 0) vec_push(v, x);
+    }
+}
+
+void random_set_u64(vec_u64 v, usize n, u32 spread) {
+    vec_clear(v);
+    for (u64 x = (u64) 1 << 40; v->len < n; x++) {
+        if (rand() % spread == 0) vec_push(v, x);
+    }
+}
+
+// the same operations one element at a time: 0 intersect, 1 union, 2 difference
+#define NAIVE(out, a, b, op)                                                    \
+  do {                                                                          \
+    vec_clear(out);                                                             \
+    usize i = 0, j = 0;                                                         \
+    while (i < (a)->len || j < (b)->len) {                                      \
+      bool ina = i < (a)->len, inb = j < (b)->len;                              \
+      if (ina && inb && (a)->data[i] == (b)->data[j]) {                         \
+        if (op != 2) vec_push(out, (a)->data[i]);                               \
+        i++, j++;                                                               \
+      } else if (ina && (!inb || (a)->data[i] < (b)->data[j])) {                \
+        if (op != 0) vec_push(out, (a)->data[i]);                               \
+        i++;                                                                    \
+      } else {                                                                  \
+        if (op == 1) vec_push(out, (b)->data[j]);                               \
+        j++;                                                                    \
+      }                                                                         \
+    }                                                                           \
+  } while (0)
+
+#define SAME(x, y) \
+  ((x)->len == (y)->len && ((x)->len == 0 || memcmp((x)->data, (y)->data, (x)->len * sizeof(*(x)->data)) == 0))
+
+// every operation on a and b against NAIVE
+#define CHECK_ALL(a, b, out, want, ok)                                          \
+  do {                                                                          \
+    NAIVE(want, a, b, 0);                                                       \
+    ok = ok && set_intersect(out, a, b) == 0 && SAME(out, want);                \
+    ok = ok && set_intersect_simd(out, a, b) == 0 && SAME(out, want);           \
+    ok = ok && set_intersect_gallop(out, a, b) == 0 && SAME(out, want);         \
+    ok = ok && set_intersect(out, b, a) == 0 && SAME(out, want);                \
+    NAIVE(want, a, b, 1);                                                       \
+    ok = ok && set_union(out, a, b) == 0 && SAME(out, want);                    \
+    NAIVE(want, a, b, 2);                                                       \
+    ok = ok && set_difference(out, a, b) == 0 && SAME(out, want);               \
+    NAIVE(want, b, a, 2);                                                       \
+    ok = ok && set_difference(out, b, a) == 0 && SAME(out, want);               \
+  } while (0)
+
+// Test function for the u32 operations across sizes, densities and size ratios
+void test_set_u32() {
+    vec_u32 a, b, out, want;
+    vec_init(a);
+    vec_init(b);
+    vec_init(out);
+    vec_init(want);
+    srand(11);
+    bool ok = true;
+    usize sizes[] = { 0, 1, 7, 8, 9, 31, 100, 1000, 20000 };
+    u32 spreads[] = { 1, 2, 5 };
+    for (usize x = 0; x < 9; x++) {
+        for (usize y = 0; y < 9; y++) {
+            for (usize s = 0; s < 3; s++) {
+                random_set_u32(a, sizes[x], spreads[s]);
+                random_set_u32(b, sizes[y], spreads[(s + 1) % 3]);
+                CHECK_ALL(a, b, out, want, ok);
+            }
+        }
+    }
+    if (ok) {
+        printf("set_u32: PASSED\n");
+    } else {
+        printf("set_u32: FAILED\n");
+    }
+    vec_free(a);
+    vec_free(b);
+    vec_free(out);
+    vec_free(want);
+}
+
+// Test function for the u64 operations, with values past 32 bits
+void test_set_u64() {
+    vec_u64 a, b, out, want;
+    vec_init(a);
+    vec_init(b);
+    vec_init(out);
+    vec_init(want);
+    srand(13);
+    bool ok = true;
+    usize sizes[] = { 0, 3, 4, 5, 64, 999, 50000 };
+    for (usize x = 0; x < 7; x++) {
+        for (usize y = 0; y < 7; y++) {
+            random_set_u64(a, sizes[x], 3);
+            random_set_u64(b, sizes[y], 2);
+            CHECK_ALL(a, b, out, want, ok);
+        }
+    }
+    // equal low halves must not match
+    vec_clear(a);
+    vec_clear(b);
+    for (u64 i = 0; i < 16; i++) {
+        vec_push(a, i);
+        vec_push(b, i | (u64) 1 << 32);
+    }
+    ok = ok && set_intersect_simd(out, a, b) == 0 && out->len == 0;
+    if (ok) {
+        printf("set_u64: PASSED\n");
+    } else {
+        printf("set_u64: FAILED\n");
+    }
+    vec_free(a);
+    vec_free(b);
+    vec_free(out);
+    vec_free(want);
+}
+
+// Test function for set_union_k against pairwise unions
+void test_set_union_k() {
+    vec_u32 sets[7], out, want, tmp;
+    vec_init(out);
+    vec_init(want);
+    vec_init(tmp);
+    srand(17);
+    for (int i = 0; i < 7; i++) {
+        vec_init(sets[i]);
+        random_set_u32(sets[i], i == 3 ? 0 : (usize) (rand() % 3000), 1 + i % 4);
+    }
+    bool ok = set_union_k(out, sets, 0) == 0 && out->len == 0;
+    ok = ok && set_union_k(out, sets, 1) == 0 && SAME(out, sets[0]);
+    for (usize k = 2; k <= 7; k++) {
+        vec_clear(want);
+        for (usize i = 0; i < k; i++) {
+            set_union(tmp, want, sets[i]);
+            vec_clear(want);
+            vec_extend(want, tmp);
+        }
+        ok = ok && set_union_k(out, sets, k) == 0 && SAME(out, want);
+    }
+    if (ok) {
+        printf("set_union_k: PASSED\n");
+    } else {
+        printf("set_union_k: FAILED\n");
+    }
+    for (int i = 0; i < 7; i++) {
+        vec_free(sets[i]);
+    }
+    vec_free(out);
+    vec_free(want);
+    vec_free(tmp);
+}
+
+int main() {
+    test_set_u32();
+    test_set_u64();
+    test_set_union_k();
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/slotmap.h"
+
+typedef struct {
+    float x, y;
+    int hp;
+} Entity;
+
+typedef slotmap(int) slotmap_int;
+typedef slotmap(Entity) slotmap_entity;
+
+// Test function for slotmap_insert and lookups
+void test_slotmap_insert() {
+    slotmap_int m;
+    slotmap_init(m);
+    slotmap_id a = slotmap_insert(m, 10);
+    slotmap_id b = slotmap_insert(m, 20);
+    slotmap_id c = slotmap_insert(m, 30);
+    bool ok = a != 0 && a != b && b != c && slotmap_len(m) == 3;
+    ok = ok && slotmap_at(m, a) == 10 && *slotmap_get(m, b) == 20 && slotmap_at(m, c) == 30;
+    ok = ok && slotmap_contains(m, c) && !slotmap_contains(m, 0) && slotmap_get(m, 0) == null;
+    ok = ok && !slotmap_contains(m, (slotmap_id) 1 << 32 | 7);
+    *slotmap_get(m, b) += 1;
+    ok = ok && slotmap_at(m, b) == 21;
+    if (ok) {
+        printf("slotmap_insert: PASSED\n");
+    } else {
+        printf("slotmap_insert: FAILED\n");
+    }
+    slotmap_free(m);
+}
+
+// Test function for slotmap_remove keeping other handles and rejecting stale ones
+void test_slotmap_remove() {
+    slotmap_int m;
+    slotmap_init(m);
+    slotmap_id ids[100];
+    for (int i = 0; i < 100; i++) {
+        ids[i] = slotmap_insert(m, i);
+    }
+    bool ok = true;
+    for (int i = 0; i < 100; i += 3) {
+        ok = ok && slotmap_remove(m, ids[i]) == 0;
+    }
+    ok = ok && slotmap_remove(m, ids[0]) == -1 && slotmap_len(m) == 66;
+    for (int i = 0; i < 100; i++) {
+        if (i % 3 == 0) ok = ok && !slotmap_contains(m, ids[i]) && slotmap_get(m, ids[i]) == null;
+        else ok = ok && slotmap_at(m, ids[i]) == i;
+    }
+    // freed slots get reused under a new generation, old handles stay dead
+    slotmap_id again = slotmap_insert(m, 1000);
+    ok = ok && (u32) again == (u32) ids[99] && again != ids[99];
+    ok = ok && !slotmap_contains(m, ids[99]) && slotmap_at(m, again) == 1000 && slotmap_len(m) == 67;
+    if (ok) {
+        printf("slotmap_remove: PASSED\n");
+    } else {
+        printf("slotmap_remove: FAILED\n");
+    }
+    slotmap_free(m);
+}
+
+// Test function for dense iteration and slotmap_id_at
+void test_slotmap_iter() {
+    slotmap_entity m;
+    slotmap_init(m);
+    slotmap_reserve(m, 64);
+    slotmap_id ids[50];
+    for (int i = 0; i < 50; i++) {
+        Entity e = { i, -i, i * 10 };
+        ids[i] = slotmap_insert(m, e);
+    }
+    for (int i = 0; i < 50; i += 2) {
+        slotmap_remove(m, ids[i]);
+    }
+    // values stay packed, and each one's handle leads back to it
+    bool ok = slotmap_values(m)->len == 25;
+    int total = 0;
+    Entity e;
+    slotmap_iter(m, e) {
+        total += e.hp;
+    }
+    ok = ok && total == 10 * (1 + 3 + 5 + 7 + 9 + 11 + 13 + 15 + 17 + 19 + 21 + 23 + 25 +
+                              27 + 29 + 31 + 33 + 35 + 37 + 39 + 41 + 43 + 45 + 47 + 49);
+    slotmap_id id;
+    int seen = 0;
+    slotmap_enum(m, id, e) {
+        seen++;
+        ok = ok && slotmap_get(m, id)->hp == e.hp && e.hp % 20 == 10;
+    }
+    for (usize i = 0; i < slotmap_len(m); i++) {
+        ok = ok && slotmap_get(m, slotmap_id_at(m, i)) == &slotmap_values(m)->data[i];
+    }
+    ok = ok && seen == 25;
+    if (ok) {
+        printf("slotmap_iter: PASSED\n");
+    } else {
+        printf("slotmap_iter: FAILED\n");
+    }
+    slotmap_free(m);
+}
+
+// Test function for slotmap_clear
+void test_slotmap_clear() {
+    slotmap_int m;
+    slotmap_init(m);
+    slotmap_id a = slotmap_insert(m, 1);
+    slotmap_id b = slotmap_insert(m, 2);
+    slotmap_clear(m);
+    bool ok = slotmap_is_empty(m) && !slotmap_contains(m, a) && !slotmap_contains(m, b);
+    slotmap_id c = slotmap_insert(m, 3);
+    slotmap_id d = slotmap_insert(m, 4);
+    ok = ok && c != a && c != b && d != a && d != b && slotmap_at(m, c) == 3 && slotmap_at(m, d) == 4;
+    ok = ok && m->slots->len == 2;
+    if (ok) {
+        printf("slotmap_clear: PASSED\n");
+    } else {
+        printf("slotmap_clear: FAILED\n");
+    }
+    slotmap_free(m);
+}
+
+int main() {
+    test_slotmap_insert();
+    test_slotmap_remove();
+    test_slotmap_iter();
+    test_slotmap_clear();
+    return 0;
+}
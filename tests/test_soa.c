@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/soa.h"
+
+typedef struct {
+    char name[100];
+} Label;
+
+SOA_DEFINE(particles, (float, x), (float, y), (int, id))
+SOA_DEFINE(labeled, (int, key), (Label, label), (char, flag))
+
+// Test function for name_push and the column layout
+void test_soa_push() {
+    particles p = particles_new();
+    for (int i = 0; i < 100; i++) {
+        particles_push(p, (float) i, (float) -i, i * 10);
+    }
+    float* xs = soa_col(p, x);
+    bool ok = soa_len(p) == 100 && p->cap >= 100;
+    for (int i = 0; i < 100; i++) {
+        ok = ok && xs[i] == (float) i && soa_at(p, y, i) == (float) -i && soa_at(p, id, i) == i * 10;
+    }
+    if (ok) {
+        printf("soa_push: PASSED\n");
+    } else {
+        printf("soa_push: FAILED\n");
+    }
+    soa_free(p);
+}
+
+// Test function for soa_reserve
+void test_soa_reserve() {
+    particles p = particles_new();
+    soa_reserve(p, 1000);
+    float* xs = p->x;
+    int* ids = p->id;
+    for (int i = 0; i < 1000; i++) {
+        particles_push(p, 0, 0, i);
+    }
+    if (p->cap == 1000 && p->x == xs && p->id == ids && soa_at(p, id, 999) == 999) {
+        printf("soa_reserve: PASSED\n");
+    } else {
+        printf("soa_reserve: FAILED\n");
+    }
+    soa_free(p);
+}
+
+// Test function for soa_swapsplice
+void test_soa_swapsplice() {
+    labeled l = labeled_new();
+    Label lb;
+    for (int i = 0; i < 7; i++) {
+        sprintf(lb.name, "label-%d", i);
+        labeled_push(l, i, lb, 'a' + i);
+    }
+    soa_swapsplice(l, 1, 1);
+    soa_swapsplice(l, soa_len(l) - 1, 1);
+    bool ok = soa_len(l) == 5;
+    ok = ok && soa_at(l, key, 1) == 6 && strcmp(soa_at(l, label, 1).name, "label-6") == 0 && soa_at(l, flag, 1) == 'g';
+    ok = ok && soa_at(l, key, 4) == 4 && soa_at(l, flag, 4) == 'e';
+    // the last 2 records replace the first 2
+    soa_swapsplice(l, 0, 2);
+    ok = ok && soa_len(l) == 3 && soa_at(l, key, 0) == 3 && soa_at(l, key, 1) == 4 && soa_at(l, key, 2) == 2;
+    ok = ok && strcmp(soa_at(l, label, 1).name, "label-4") == 0;
+    if (ok) {
+        printf("soa_swapsplice: PASSED\n");
+    } else {
+        printf("soa_swapsplice: FAILED\n");
+    }
+    soa_free(l);
+}
+
+// Test function for soa_swap
+void test_soa_swap() {
+    labeled l = labeled_new();
+    Label a = { "first" };
+    Label b = { "second" };
+    labeled_push(l, 1, a, 'x');
+    labeled_push(l, 2, b, 'y');
+    soa_swap(l, 0, 1);
+    bool ok = soa_at(l, key, 0) == 2 && strcmp(soa_at(l, label, 0).name, "second") == 0 && soa_at(l, flag, 0) == 'y';
+    ok = ok && soa_at(l, key, 1) == 1 && strcmp(soa_at(l, label, 1).name, "first") == 0 && soa_at(l, flag, 1) == 'x';
+    if (ok) {
+        printf("soa_swap: PASSED\n");
+    } else {
+        printf("soa_swap: FAILED\n");
+    }
+    soa_free(l);
+}
+
+// Test function for soa_enum, soa_pop, soa_truncate and soa_clear
+void test_soa_enum() {
+    particles p = particles_new();
+    for (int i = 0; i < 10; i++) {
+        particles_push(p, 1.5f, 0, i);
+    }
+    float sum = 0;
+    usize i;
+    soa_enum(p, i) {
+        sum += soa_at(p, x, i);
+    }
+    bool ok = sum == 15.0f;
+    soa_pop(p);
+    ok = ok && soa_len(p) == 9;
+    soa_truncate(p, 4);
+    ok = ok && soa_len(p) == 4 && soa_at(p, id, 3) == 3;
+    soa_clear(p);
+    ok = ok && soa_is_empty(p);
+    if (ok) {
+        printf("soa_enum: PASSED\n");
+    } else {
+        printf("soa_enum: FAILED\n");
+    }
+    soa_free(p);
+}
+
+int main() {
+    test_soa_push();
+    test_soa_reserve();
+    test_soa_swapsplice();
+    test_soa_swap();
+    test_soa_enum();
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/array.h"
+#include "../std/sort.h"
+#include "../std/vec.h"
+
+typedef struct {
+    int id;
+    double latency;
+} Sample;
+
+typedef topk(int) topk_int;
+typedef topk(Sample) topk_sample;
+
+#define by_latency(a, b) ((a).latency < (b).latency)
+#define slower(a, b) ((a).latency > (b).latency)
+
+int cmp_int(const void* a, const void* b) {
+    int x = *(const int*) a, y = *(const int*) b;
+    return (x > y) - (x < y);
+}
+
+// fill v with n values of the given shape: random, few distinct, sorted, reversed, organ pipe
+void fill(vec_int v, int n, int shape) {
+    vec_clear(v);
+    for (int i = 0; i < n; i++) {
+        int x = shape == 0 ? rand() % 1000 : shape == 1 ? rand() % 3 : shape == 2 ? i : shape == 3 ? n - i : (i < n / 2 ? i : n - i);
+        vec_push(v, x);
+    }
+}
+
+// is data[k] the sorted value with nothing bigger before it and nothing smaller after?
+bool selected(vec_int v, int* sorted, usize k) {
+    bool ok = v->data[k] == sorted[k];
+    for (usize i = 0; i < v->len; i++) {
+        ok = ok && (i < k ? v->data[i] <= v->data[k] : v->data[i] >= v->data[k]);
+    }
+    return ok;
+}
+
+// Test function for vec_nth_element against a full sort
+void test_nth_element() {
+    vec_int v;
+    vec_init(v);
+    srand(3);
+    int sizes[] = { 1, 2, 5, 16, 17, 100, 1000, 4097 };
+    bool ok = true;
+    for (int shape = 0; shape < 5; shape++) {
+        for (usize s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+            int n = sizes[s];
+            fill(v, n, shape);
+            int* orig = malloc(n * sizeof(int));
+            int* sorted = malloc(n * sizeof(int));
+            memcpy(orig, v->data, n * sizeof(int));
+            memcpy(sorted, v->data, n * sizeof(int));
+            qsort(sorted, n, sizeof(int), cmp_int);
+            usize ks[] = { 0, n / 4, n / 2, n - 1 };
+            for (int j = 0; j < 4; j++) {
+                memcpy(v->data, orig, n * sizeof(int));
+                vec_nth_element(v, ks[j]);
+                ok = ok && selected(v, sorted, ks[j]);
+            }
+            free(orig);
+            free(sorted);
+        }
+    }
+    // out of range leaves it alone
+    fill(v, 10, 3);
+    vec_nth_element(v, 10);
+    ok = ok && v->data[0] == 10 && v->data[9] == 1;
+    if (ok) {
+        printf("vec_nth_element: PASSED\n");
+    } else {
+        printf("vec_nth_element: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for vec_nth_element_by picking quantiles out of structs
+void test_nth_element_by() {
+    vec(Sample) v;
+    vec_init(v);
+    for (int i = 0; i < 1000; i++) {
+        Sample s = { i, (i * 7919) % 1000 / 10.0 };
+        vec_push(v, s);
+    }
+    usize p50 = 999 / 2, p99 = 999 * 99 / 100;
+    vec_nth_element_by(v, p99, by_latency);
+    bool ok = v->data[p99].latency == 98.9;
+    vec_nth_element_by(v, p50, by_latency);
+    ok = ok && v->data[p50].latency == 49.9;
+    for (usize i = 0; i < v->len; i++) {
+        ok = ok && (i < p50 ? v->data[i].latency <= 49.9 : v->data[i].latency >= 49.9);
+    }
+    if (ok) {
+        printf("vec_nth_element_by: PASSED\n");
+    } else {
+        printf("vec_nth_element_by: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for vec_partial_sort and array_partial_sort
+void test_partial_sort() {
+    vec_int v;
+    vec_init(v);
+    srand(5);
+    bool ok = true;
+    for (int shape = 0; shape < 5; shape++) {
+        fill(v, 2000, shape);
+        int* orig = malloc(2000 * sizeof(int));
+        int* sorted = malloc(2000 * sizeof(int));
+        memcpy(orig, v->data, 2000 * sizeof(int));
+        memcpy(sorted, v->data, 2000 * sizeof(int));
+        qsort(sorted, 2000, sizeof(int), cmp_int);
+        usize ks[] = { 0, 1, 10, 1999, 2000, 5000 };
+        for (int j = 0; j < 6; j++) {
+            memcpy(v->data, orig, 2000 * sizeof(int));
+            vec_partial_sort(v, ks[j]);
+            usize k = ks[j] < 2000 ? ks[j] : 2000;
+            ok = ok && memcmp(v->data, sorted, k * sizeof(int)) == 0;
+            for (usize i = k; i < 2000; i++) {
+                ok = ok && v->data[i] >= sorted[k - (k > 0)];
+            }
+        }
+        free(orig);
+        free(sorted);
+    }
+    array_int a;
+    array_init(a, 8);
+    int vals[8] = { 5, 1, 7, 3, 8, 2, 6, 4 };
+    memcpy(a->data, vals, sizeof(vals));
+    array_partial_sort(a, 3);
+    ok = ok && a->data[0] == 1 && a->data[1] == 2 && a->data[2] == 3;
+    array_nth_element(a, 6);
+    ok = ok && a->data[6] == 7;
+    if (ok) {
+        printf("vec_partial_sort: PASSED\n");
+    } else {
+        printf("vec_partial_sort: FAILED\n");
+    }
+    array_free(a);
+    vec_free(v);
+}
+
+// Test function for the streaming top-k accumulator
+void test_topk() {
+    topk_int t;
+    topk_init(t, 10);
+    srand(7);
+    int* all = malloc(10000 * sizeof(int));
+    for (int i = 0; i < 10000; i++) {
+        all[i] = rand();
+        topk_push(t, all[i]);
+    }
+    qsort(all, 10000, sizeof(int), cmp_int);
+    bool ok = topk_len(t) == 10 && topk_min(t) == all[9990];
+    topk_sort(t);
+    ok = ok && memcmp(t->data, all + 9990, 10 * sizeof(int)) == 0;
+    // still a heap after sorting, so it keeps going
+    topk_push(t, all[9999] + 1);
+    ok = ok && topk_len(t) == 10 && topk_min(t) == all[9991];
+    topk_clear(t);
+    topk_push(t, 3);
+    ok = ok && topk_len(t) == 1 && topk_min(t) == 3;
+    if (ok) {
+        printf("topk: PASSED\n");
+    } else {
+        printf("topk: FAILED\n");
+    }
+    free(all);
+    topk_free(t);
+}
+
+// Test function for topk_push_by keeping the slowest and the fastest samples
+void test_topk_by() {
+    topk_sample slow, fast;
+    topk_init(slow, 3);
+    topk_init(fast, 3);
+    for (int i = 0; i < 100; i++) {
+        Sample s = { i, (i * 37) % 100 };
+        topk_push_by(slow, s, by_latency);
+        topk_push_by(fast, s, slower);
+    }
+    topk_sort_by(slow, by_latency);
+    topk_sort_by(fast, slower);
+    bool ok = slow->data[0].latency == 97 && slow->data[2].latency == 99;
+    ok = ok && fast->data[0].latency == 2 && fast->data[2].latency == 0 && fast->data[2].id == 0;
+    topk_sample none;
+    topk_init(none, 0);
+    Sample s = { 1, 1 };
+    topk_push_by(none, s, by_latency);
+    ok = ok && topk_len(none) == 0;
+    if (ok) {
+        printf("topk_by: PASSED\n");
+    } else {
+        printf("topk_by: FAILED\n");
+    }
+    topk_free(none);
+    topk_free(slow);
+    topk_free(fast);
+}
+
+typedef struct {
+    int key;
+    int seq;
+} Keyed;
+
+typedef vec(Keyed) vec_keyed;
+
+#define by_key(a, b) ((a).key < (b).key)
+
+int cmp_keyed(const void* a, const void* b) {
+    const Keyed *x = a, *y = b;
+    return x->key != y->key ? (x->key > y->key) - (x->key < y->key) : (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+// n keys of the given shape, seq numbering them in order: random, few distinct, sorted,
+// reversed, sorted with a random tail appended, sawtooth of ascending and descending runs
+void fill_keyed(vec_keyed v, int n, int shape) {
+    vec_clear(v);
+    for (int i = 0; i < n; i++) {
+        int x = shape == 0 ? rand() % 100000 : shape == 1 ? rand() % 4 : shape == 2 ? i / 3 : shape == 3 ? n - i
+              : shape == 4 ? (i < n - n / 20 ? i : rand() % n) : (i / 100 % 2 ? i % 100 : 100 - i % 100);
+        Keyed k = { x, i };
+        vec_push(v, k);
+    }
+}
+
+// Test function for vec_stable_sort_by against qsort on (key, seq)
+void test_stable_sort() {
+    vec_keyed v, tmp;
+    vec_init(v);
+    vec_init(tmp);
+    srand(19);
+    int sizes[] = { 0, 1, 2, 31, 64, 65, 1000, 4099, 100000 };
+    bool ok = true;
+    for (int shape = 0; shape < 6; shape++) {
+        for (usize s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+            int n = sizes[s];
+            fill_keyed(v, n, shape);
+            Keyed* want = malloc((n + 1) * sizeof(Keyed));
+            if (n > 0) memcpy(want, v->data, n * sizeof(Keyed));
+            qsort(want, n, sizeof(Keyed), cmp_keyed);
+            vec_stable_sort_by(v, tmp, by_key);
+            ok = ok && (n == 0 || memcmp(v->data, want, n * sizeof(Keyed)) == 0);
+            free(want);
+        }
+    }
+    if (ok) {
+        printf("vec_stable_sort: PASSED\n");
+    } else {
+        printf("vec_stable_sort: FAILED\n");
+    }
+    vec_free(v);
+    vec_free(tmp);
+}
+
+// Test function for stable sorting already sorted input and reusing tmp
+void test_stable_sort_adaptive() {
+    vec_int v, tmp;
+    vec_init(v);
+    vec_init(tmp);
+    for (int i = 0; i < 10000; i++) {
+        vec_push(v, i / 2);
+    }
+    // sorted input never needs the scratch buffer
+    vec_stable_sort(v, tmp);
+    bool ok = tmp->cap == 0;
+    for (int i = 0; i < 10000; i++) {
+        ok = ok && v->data[i] == i / 2;
+    }
+    // appended out of order entries
+    for (int i = 0; i < 100; i++) {
+        vec_push(v, 5000 - i * 37);
+    }
+    vec_stable_sort(v, tmp);
+    usize cap = tmp->cap;
+    ok = ok && cap >= 10100;
+    for (usize i = 1; i < v->len; i++) {
+        ok = ok && v->data[i - 1] <= v->data[i];
+    }
+    // sorting again reuses tmp
+    vec_reverse(v);
+    vec_stable_sort(v, tmp);
+    ok = ok && tmp->cap == cap && v->data[0] == 0 && v->data[10099] == 5000;
+    array_int a;
+    array_init(a, 6);
+    int vals[6] = { 3, 1, 2, 3, 1, 2 };
+    memcpy(a->data, vals, sizeof(vals));
+    array_stable_sort(a, tmp);
+    ok = ok && a->data[0] == 1 && a->data[1] == 1 && a->data[4] == 3 && a->data[5] == 3;
+    if (ok) {
+        printf("vec_stable_sort_adaptive: PASSED\n");
+    } else {
+        printf("vec_stable_sort_adaptive: FAILED\n");
+    }
+    array_free(a);
+    vec_free(v);
+    vec_free(tmp);
+}
+
+int main() {
+    test_nth_element();
+    test_nth_element_by();
+    test_partial_sort();
+    test_topk();
+    test_topk_by();
+    test_stable_sort();
+    test_stable_sort_adaptive();
+    return 0;
+}
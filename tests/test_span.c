@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/array.h"
+#include "../std/span.h"
+#include "../std/vec.h"
+
+int cmp_int(const void* a, const void* b) {
+    return *(const int*) a - *(const int*) b;
+}
+
+int sum(span_int s) {
+    int total = 0, x;
+    span_iter(s, x) {
+        total += x;
+    }
+    return total;
+}
+
+// Test function for building spans over vec and array without copying
+void test_span_views() {
+    vec_int v;
+    vec_init(v);
+    for (int i = 0; i < 10; i++) {
+        vec_push(v, i);
+    }
+    array_int a;
+    array_init(a, 4);
+    span_int s, t, u;
+    span_of(s, v);
+    span_from(t, v, 3, 4);
+    span_of(u, a);
+    bool ok = s.data == v->data && span_len(s) == 10 && sum(s) == 45;
+    ok = ok && t.data == v->data + 3 && span_first(t) == 3 && span_last(t) == 6 && sum(t) == 18;
+    ok = ok && u.data == a->data && span_len(u) == 4 && !span_is_empty(u);
+    // writes through the span land in the container
+    span_at(t, 0) = 100;
+    ok = ok && v->data[3] == 100;
+    int buf[3] = { 7, 8, 9 };
+    span_init(u, buf, 3);
+    ok = ok && sum(u) == 24;
+    if (ok) {
+        printf("span_views: PASSED\n");
+    } else {
+        printf("span_views: FAILED\n");
+    }
+    array_free(a);
+    vec_free(v);
+}
+
+// Test function for span_sub, span_take and span_drop
+void test_span_sub() {
+    int buf[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    span_int s;
+    span_init(s, buf, 8);
+    span_int mid = span_sub(s, 2, 4);
+    bool ok = mid.data == buf + 2 && mid.len == 4 && span_sub(mid, 1, 2).data[0] == 3;
+    ok = ok && span_take(s, 3).len == 3 && span_drop(s, 3).len == 5 && span_first(span_drop(s, 3)) == 3;
+    // consume a buffer a chunk at a time
+    int chunks = 0, total = 0;
+    while (!span_is_empty(s)) {
+        usize n = span_len(s) < 3 ? span_len(s) : 3;
+        total += sum(span_take(s, n));
+        s = span_drop(s, n);
+        chunks++;
+    }
+    ok = ok && chunks == 3 && total == 28 && span_drop(mid, 4).len == 0;
+    if (ok) {
+        printf("span_sub: PASSED\n");
+    } else {
+        printf("span_sub: FAILED\n");
+    }
+}
+
+// Test function for span_fill, span_copy, span_sort and span_reverse
+void test_span_ops() {
+    int buf[10] = { 5, 3, 9, 1, 7, 2, 8, 0, 6, 4 };
+    span_int s, lo, hi;
+    span_init(s, buf, 10);
+    lo = span_take(s, 5);
+    hi = span_drop(s, 5);
+    span_sort(lo, cmp_int);
+    bool ok = buf[0] == 1 && buf[4] == 9 && buf[5] == 2;
+    span_reverse(lo);
+    ok = ok && buf[0] == 9 && buf[2] == 5 && buf[4] == 1;
+    span_copy(hi, lo);
+    ok = ok && memcmp(buf, buf + 5, 5 * sizeof(int)) == 0;
+    // only as much as fits, overlapping is fine
+    span_copy(span_sub(s, 1, 2), s);
+    ok = ok && buf[1] == 9 && buf[2] == 7 && buf[3] == 3;
+    span_fill(hi, -1);
+    ok = ok && buf[4] == 1 && buf[5] == -1 && buf[9] == -1;
+    span_swap(s, 0, 9);
+    ok = ok && buf[0] == -1 && buf[9] == 9;
+    if (ok) {
+        printf("span_ops: PASSED\n");
+    } else {
+        printf("span_ops: FAILED\n");
+    }
+}
+
+// Test function for span_find and the sorted searches
+void test_span_search() {
+    int buf[8] = { 1, 3, 3, 5, 8, 13, 21, 34 };
+    span_int s;
+    span_init(s, buf, 8);
+    usize i, j, k, m;
+    span_find(s, 8, i);
+    span_find(s, 4, j);
+    bool ok = i == 4 && j == (usize) -1;
+    span_lower_bound(s, 3, i);
+    span_upper_bound(s, 3, j);
+    ok = ok && i == 1 && j == 3;
+    span_int tail = span_drop(s, 4);
+    span_bsearch(tail, 21, k);
+    span_bsearch(tail, 5, m);
+    ok = ok && k == 2 && m == (usize) -1;
+    usize idx;
+    int x, seen = 0;
+    span_enum(tail, idx, x) {
+        seen += x == buf[4 + idx];
+    }
+    ok = ok && seen == 4;
+    if (ok) {
+        printf("span_search: PASSED\n");
+    } else {
+        printf("span_search: FAILED\n");
+    }
+}
+
+int main() {
+    test_span_views();
+    test_span_sub();
+    test_span_ops();
+    test_span_search();
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../std/svec.h"
+
+// Test function for svec_init
+void test_svec_init() {
+    svec(int, 4) v;
+    svec_init(v);
+    if (v->len == 0 && v->cap == 4 && svec_is_inline(v)) {
+        printf("svec_init: PASSED\n");
+    } else {
+        printf("svec_init: FAILED\n");
+    }
+    svec_free(v);
+}
+
+// Test function for svec_push staying inline
+void test_svec_push_inline() {
+    svec(int, 4) v;
+    svec_init(v);
+    for (int i = 0; i < 4; i++) {
+        svec_push(v, i * 10);
+    }
+    if (v->len == 4 && svec_is_inline(v) && svec_at(v, 3) == 30) {
+        printf("svec_push_inline: PASSED\n");
+    } else {
+        printf("svec_push_inline: FAILED\n");
+    }
+    svec_free(v);
+}
+
+// Test function for svec_push spilling to the heap
+void test_svec_push_spill() {
+    svec(int, 4) v;
+    svec_init(v);
+    for (int i = 0; i < 100; i++) {
+        svec_push(v, i);
+    }
+    bool ok = v->len == 100 && !svec_is_inline(v);
+    for (int i = 0; i < 100; i++) {
+        ok = ok && svec_at(v, i) == i;
+    }
+    if (ok) {
+        printf("svec_push_spill: PASSED\n");
+    } else {
+        printf("svec_push_spill: FAILED\n");
+    }
+    svec_free(v);
+}
+
+// Test function for svec_insert
+void test_svec_insert() {
+    svec(int, 4) v;
+    svec_init(v);
+    svec_push(v, 1);
+    svec_push(v, 2);
+    svec_push(v, 3);
+    svec_push(v, 4);
+    svec_insert(v, 1, 42);
+    if (v->len == 5 && svec_at(v, 0) == 1 && svec_at(v, 1) == 42 && svec_at(v, 4) == 4) {
+        printf("svec_insert: PASSED\n");
+    } else {
+        printf("svec_insert: FAILED\n");
+    }
+    svec_free(v);
+}
+
+// Test function for svec_compact
+void test_svec_compact() {
+    svec(int, 4) v;
+    svec_init(v);
+    for (int i = 0; i < 10; i++) {
+        svec_push(v, i);
+    }
+    svec_truncate(v, 3);
+    svec_compact(v);
+    if (svec_is_inline(v) && v->cap == 4 && svec_at(v, 2) == 2) {
+        printf("svec_compact: PASSED\n");
+    } else {
+        printf("svec_compact: FAILED\n");
+    }
+    svec_free(v);
+}
+
+// Test function for svec_extend_from
+void test_svec_extend_from() {
+    svec(int, 2) v;
+    svec_init(v);
+    int buffer[] = {1, 2, 3};
+    svec_extend_from(v, buffer, 3);
+    bool ok = v->len == 3 && svec_at(v, 0) == 1 && svec_at(v, 2) == 3;
+    // one element at a time still doubles the capacity
+    for (int i = 0; i < 1000; i++) {
+        svec_extend_from(v, buffer, 1);
+        svec_insert_n(v, 0, buffer + 2, 1);
+    }
+    ok = ok && v->len == 2003 && v->cap == 2048 && svec_at(v, 0) == 3 && svec_at(v, 2002) == 1;
+    if (ok) {
+        printf("svec_extend_from: PASSED\n");
+    } else {
+        printf("svec_extend_from: FAILED\n");
+    }
+    svec_free(v);
+}
+
+// Test function for svec_iter
+void test_svec_iter() {
+    svec_int v;
+    svec_init(v);
+    svec_push(v, 1);
+    svec_push(v, 2);
+    svec_push(v, 3);
+    int sum = 0;
+    int i;
+    svec_iter(v, i) {
+        sum += i;
+    }
+    if (sum == 6) {
+        printf("svec_iter: PASSED\n");
+    } else {
+        printf("svec_iter: FAILED\n");
+    }
+    svec_free(v);
+}
+
+// Test function for svec_remove
+void test_svec_remove() {
+    svec_int v;
+    svec_init(v);
+    svec_push(v, 1);
+    svec_push(v, 2);
+    svec_push(v, 3);
+    svec_remove(v, 2);
+    if (v->len == 2 && svec_at(v, 1) == 3) {
+        printf("svec_remove: PASSED\n");
+    } else {
+        printf("svec_remove: FAILED\n");
+    }
+    svec_free(v);
+}
+
+int main() {
+    test_svec_init();
+    test_svec_push_inline();
+    test_svec_push_spill();
+    test_svec_insert();
+    test_svec_compact();
+    test_svec_extend_from();
+    test_svec_iter();
+    test_svec_remove();
+    return 0;
+}
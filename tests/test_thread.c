@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../std/thread.h"
+
+#define TASKS 10000
+#define N 1000000
+
+typedef struct {
+    atomic_size_t count;
+    atomic_size_t sum;
+} Counter;
+
+void count_one(void* ctx) {
+    Counter* c = ctx;
+    atomic_fetch_add(&c->count, 1);
+}
+
+// Test function for thread_spawn and thread_wait from outside the pool
+void test_spawn_wait() {
+    thread_pool p = thread_pool_new(4);
+    Counter c = {0};
+    task_group g = {0};
+    for (int i = 0; i < TASKS; i++) {
+        thread_spawn(p, &g, count_one, &c);
+    }
+    thread_wait(p, &g);
+    bool ok = atomic_load(&c.count) == TASKS && atomic_load(&g.pending) == 0 && thread_pool_size(p) == 4;
+    // the group can be used again
+    thread_spawn(p, &g, count_one, &c);
+    thread_wait(p, &g);
+    ok = ok && atomic_load(&c.count) == TASKS + 1;
+    if (ok) {
+        printf("spawn_wait: PASSED\n");
+    } else {
+        printf("spawn_wait: FAILED\n");
+    }
+    thread_pool_free(p);
+}
+
+typedef struct {
+    thread_pool pool;
+    usize lo, hi;
+    u64 sum;
+} Range;
+
+// sums [lo, hi) by splitting in two tasks and waiting on them, recursively
+void sum_range(void* ctx) {
+    Range* r = ctx;
+    if (r->hi - r->lo <= 1000) {
+        r->sum = 0;
+        for (usize i = r->lo; i < r->hi; i++) r->sum += i;
+        return;
+    }
+    usize mid = r->lo + (r->hi - r->lo) / 2;
+    Range left = { r->pool, r->lo, mid, 0 }, right = { r->pool, mid, r->hi, 0 };
+    task_group g = {0};
+    thread_spawn(r->pool, &g, sum_range, &left);
+    thread_spawn(r->pool, &g, sum_range, &right);
+    thread_wait(r->pool, &g);
+    r->sum = left.sum + right.sum;
+}
+
+// Test function for tasks that spawn and wait on nested groups
+void test_nested() {
+    thread_pool p = thread_pool_new(3);
+    Range r = { p, 0, N, 0 };
+    sum_range(&r);
+    if (r.sum == (u64) N * (N - 1) / 2) {
+        printf("nested: PASSED\n");
+    } else {
+        printf("nested: FAILED\n");
+    }
+    thread_pool_free(p);
+}
+
+typedef struct {
+    u8* seen;
+    usize grain;
+    atomic_int misaligned;
+} Marks;
+
+void mark(void* ctx, usize begin, usize end) {
+    Marks* m = ctx;
+    if (begin % m->grain != 0 || end - begin > m->grain) atomic_store(&m->misaligned, 1);
+    for (usize i = begin; i < end; i++) m->seen[i]++;
+}
+
+// Test function for thread_parallel_for
+void test_parallel_for() {
+    thread_pool p = thread_pool_new(4);
+    Marks m = { .seen = calloc(N, 1), .grain = 777 };
+    thread_parallel_for(p, N, m.grain, mark, &m);
+    bool ok = !atomic_load(&m.misaligned);
+    for (usize i = 0; i < N; i++) {
+        ok = ok && m.seen[i] == 1;
+    }
+    // one element, and nothing at all
+    memset(m.seen, 0, N);
+    thread_parallel_for(p, 1, m.grain, mark, &m);
+    thread_parallel_for(p, 0, m.grain, mark, &m);
+    ok = ok && m.seen[0] == 1 && m.seen[1] == 0;
+    if (ok) {
+        printf("parallel_for: PASSED\n");
+    } else {
+        printf("parallel_for: FAILED\n");
+    }
+    free(m.seen);
+    thread_pool_free(p);
+}
+
+typedef struct {
+    pthread_t* who;
+    usize grain;
+    atomic_int twice;
+} Owners;
+
+void own(void* ctx, usize begin, usize end) {
+    Owners* o = ctx;
+    (void) end;
+    if (o->who[begin / o->grain] != 0) atomic_store(&o->twice, 1);
+    o->who[begin / o->grain] = pthread_self();
+}
+
+// Test function for thread_parallel_for_static
+void test_parallel_for_static() {
+    thread_pool p = thread_pool_new(3);
+    Marks m = { .seen = calloc(N, 1), .grain = 777 };
+    thread_parallel_for_static(p, N, m.grain, mark, &m);
+    bool ok = !atomic_load(&m.misaligned);
+    for (usize i = 0; i < N; i++) {
+        ok = ok && m.seen[i] == 1;
+    }
+    // a thread runs all of its chunks, every 4th one
+    usize nchunks = (N + 999) / 1000;
+    Owners o = { .who = calloc(nchunks, sizeof(pthread_t)), .grain = 1000 };
+    thread_parallel_for_static(p, N, o.grain, own, &o);
+    ok = ok && !atomic_load(&o.twice);
+    for (usize c = 4; c < nchunks; c++) {
+        ok = ok && pthread_equal(o.who[c], o.who[c - 4]);
+    }
+    // fewer chunks than threads
+    memset(m.seen, 0, N);
+    thread_parallel_for_static(p, 2 * m.grain, m.grain, mark, &m);
+    thread_parallel_for_static(p, 0, m.grain, mark, &m);
+    ok = ok && m.seen[0] == 1 && m.seen[2 * m.grain - 1] == 1 && m.seen[2 * m.grain] == 0;
+    if (ok) {
+        printf("parallel_for_static: PASSED\n");
+    } else {
+        printf("parallel_for_static: FAILED\n");
+    }
+    free(o.who);
+    free(m.seen);
+    thread_pool_free(p);
+}
+
+typedef struct {
+    thread_pool pool;
+    Counter* c;
+} Caller;
+
+void* spawn_many(void* arg) {
+    Caller* c = arg;
+    task_group g = {0};
+    for (int i = 0; i < TASKS; i++) {
+        thread_spawn(c->pool, &g, count_one, c->c);
+    }
+    thread_wait(c->pool, &g);
+    return null;
+}
+
+// Test function for several outside threads spawning on one pool at once
+void test_many_callers() {
+    thread_pool p = thread_pool_new(2);
+    Counter c = {0};
+    Caller caller = { p, &c };
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) pthread_create(&threads[i], null, spawn_many, &caller);
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], null);
+    if (atomic_load(&c.count) == 4 * TASKS) {
+        printf("many_callers: PASSED\n");
+    } else {
+        printf("many_callers: FAILED\n");
+    }
+    thread_pool_free(p);
+}
+
+// Test function for thread_pool_pin and the default pool
+void test_pin_default() {
+    thread_pool p = thread_pool_new(2);
+    int cpus[] = { 0 };
+    // cpu 0 is always there, unless the affinity mask of the process leaves it out
+    bool ok = thread_pool_pin(p, cpus, 1) == 0 || errno == EINVAL;
+    ok = ok && thread_pool_pin(p, cpus, 0) == -1;
+    Counter c = {0};
+    task_group g = {0};
+    for (int i = 0; i < 100; i++) thread_spawn(p, &g, count_one, &c);
+    thread_wait(p, &g);
+    ok = ok && atomic_load(&c.count) == 100;
+    thread_pool_free(p);
+    ok = ok && thread_default() != null && thread_default() == thread_default();
+    if (ok) {
+        printf("pin_default: PASSED\n");
+    } else {
+        printf("pin_default: FAILED\n");
+    }
+}
+
+int main() {
+    test_spawn_wait();
+    test_nested();
+    test_parallel_for();
+    test_parallel_for_static();
+    test_many_callers();
+    test_pin_default();
+    return 0;
+}
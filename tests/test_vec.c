@@ -224,6 +224,71 @@ void test_vec_extend() {
     vec_free(v2);
 }
 
+// Test function for vec_insert_n
+void test_vec_insert_n() {
+    vec(int) v;
+    vec_init(v);
+    int buffer[] = {1, 2, 6, 7};
+    int mid[] = {3, 4, 5};
+    vec_extend_from(v, buffer, 4);
+    vec_insert_n(v, 2, mid, 3);
+    vec_insert_n(v, 7, mid, 1);
+    vec_insert_n(v, 0, mid, 0);
+    bool ok = v->len == 8 && v->data[7] == 3;
+    for (int i = 0; i < 7; i++) {
+        ok = ok && v->data[i] == i + 1;
+    }
+    if (ok) {
+        printf("vec_insert_n: PASSED\n");
+    } else {
+        printf("vec_insert_n: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for vec_remove_all
+void test_vec_remove_all() {
+    vec(int) v;
+    vec_init(v);
+    int buffer[] = {7, 1, 7, 7, 2, 3, 7};
+    vec_extend_from(v, buffer, 7);
+    vec_remove_all(v, 7);
+    if (v->len == 3 && v->data[0] == 1 && v->data[1] == 2 && v->data[2] == 3) {
+        printf("vec_remove_all: PASSED\n");
+    } else {
+        printf("vec_remove_all: FAILED\n");
+    }
+    vec_free(v);
+}
+
+static bool is_even(int x) {
+    return x % 2 == 0;
+}
+
+#define IS_POSITIVE(x) ((x) > 0)
+
+// Test function for vec_retain and vec_filter
+void test_vec_retain() {
+    vec(int) v;
+    vec_init(v);
+    for (int i = -5; i <= 10; i++) {
+        vec_push(v, i);
+    }
+    vec_retain(v, is_even);
+    bool ok = v->len == 8 && v->data[0] == -4 && v->data[7] == 10;
+    vec_filter(v, IS_POSITIVE);
+    ok = ok && v->len == 5;
+    for (int i = 0; i < 5; i++) {
+        ok = ok && v->data[i] == 2 * (i + 1);
+    }
+    if (ok) {
+        printf("vec_retain: PASSED\n");
+    } else {
+        printf("vec_retain: FAILED\n");
+    }
+    vec_free(v);
+}
+
 // Test function for vec_at
 void test_vec_at() {
     vec(int) v;
@@ -330,6 +395,116 @@ void test_vec_reverse() {
     vec_free(v);
 }
 
+typedef struct {
+    u8 b[3];
+} rgb;
+
+typedef struct {
+    u64 a, b;
+} pair;
+
+// Test function for vec_reverse at every element-size path and odd lengths
+void test_vec_reverse_sizes() {
+    bool ok = true;
+    for (usize n = 0; n < 300; n += 7) {
+        vec(u8) a;
+        vec(u16) b;
+        vec(u32) c;
+        vec(double) d;
+        vec(pair) e;
+        vec(rgb) f;
+        vec_init(a); vec_init(b); vec_init(c); vec_init(d); vec_init(e); vec_init(f);
+        for (usize i = 0; i < n; i++) {
+            vec_push(a, (u8) i);
+            vec_push(b, (u16) i);
+            vec_push(c, (u32) i);
+            vec_push(d, (double) i);
+            vec_push(e, ((pair) { i, ~i }));
+            vec_push(f, ((rgb) { { (u8) i, (u8) (i >> 8), 7 } }));
+        }
+        vec_reverse(a); vec_reverse(b); vec_reverse(c); vec_reverse(d); vec_reverse(e); vec_reverse(f);
+        for (usize i = 0; i < n; i++) {
+            usize j = n - 1 - i;
+            ok = ok && a->data[i] == (u8) j && b->data[i] == (u16) j && c->data[i] == j && d->data[i] == j;
+            ok = ok && e->data[i].a == j && e->data[i].b == ~j;
+            ok = ok && f->data[i].b[0] == (u8) j && f->data[i].b[1] == (u8) (j >> 8) && f->data[i].b[2] == 7;
+        }
+        vec_free(a); vec_free(b); vec_free(c); vec_free(d); vec_free(e); vec_free(f);
+    }
+    if (ok) {
+        printf("vec_reverse_sizes: PASSED\n");
+    } else {
+        printf("vec_reverse_sizes: FAILED\n");
+    }
+}
+
+// Test function for vec_rotate against a rotated copy
+void test_vec_rotate() {
+    bool ok = true;
+    usize sizes[] = { 0, 1, 2, 5, 64, 100, 1000, 4099 };
+    for (usize s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        usize n = sizes[s];
+        usize ks[] = { 0, 1, 3, n / 2, n > 0 ? n - 1 : 0, n, 2 * n + 1, 97 };
+        for (usize t = 0; t < sizeof(ks) / sizeof(ks[0]); t++) {
+            vec(rgb) v;
+            vec_init(v);
+            for (usize i = 0; i < n; i++) {
+                vec_push(v, ((rgb) { { (u8) i, (u8) (i >> 8), (u8) (i >> 16) } }));
+            }
+            vec_rotate(v, ks[t]);
+            for (usize i = 0; i < n; i++) {
+                usize j = (i + ks[t]) % n;
+                ok = ok && v->data[i].b[0] == (u8) j && v->data[i].b[1] == (u8) (j >> 8);
+            }
+            vec_free(v);
+        }
+    }
+    if (ok) {
+        printf("vec_rotate: PASSED\n");
+    } else {
+        printf("vec_rotate: FAILED\n");
+    }
+}
+
+// Test function for vec_swap_ranges, vec_gather and vec_scatter
+void test_vec_permute() {
+    vec(double) v;
+    vec(double) g;
+    vec(double) back;
+    vec_init(v);
+    vec_init(g);
+    vec_init(back);
+    for (int i = 0; i < 100; i++) {
+        vec_push(v, i);
+    }
+    vec_swap_ranges(v, 10, 60, 30);
+    bool ok = v->data[10] == 60 && v->data[39] == 89 && v->data[60] == 10 && v->data[89] == 39 && v->data[40] == 40;
+    vec_swap_ranges(v, 10, 60, 30);
+    // a permutation and its inverse
+    u32 idx[100];
+    for (u32 i = 0; i < 100; i++) {
+        idx[i] = (i * 37 + 11) % 100;
+    }
+    vec_gather(g, v, idx, 100);
+    ok = ok && g->len == 100 && g->data[0] == 11 && g->data[1] == 48;
+    vec_reserve(back, 100);
+    back->len = 100;
+    vec_scatter(back, g, idx);
+    for (int i = 0; i < 100; i++) {
+        ok = ok && back->data[i] == i;
+    }
+    vec_gather(g, v, idx, 3);
+    ok = ok && g->len == 3 && g->data[2] == 85;
+    if (ok) {
+        printf("vec_permute: PASSED\n");
+    } else {
+        printf("vec_permute: FAILED\n");
+    }
+    vec_free(v);
+    vec_free(g);
+    vec_free(back);
+}
+
 // Test function for vec_iter
 void test_vec_iter() {
     vec(int) v;
@@ -375,6 +550,129 @@ void test_vec_enum() {
     vec_free(v);
 }
 
+// Test function for vec_lower_bound and vec_upper_bound
+void test_vec_bounds() {
+    vec(int) v;
+    vec_init(v);
+    int buffer[] = {1, 3, 3, 3, 5, 8};
+    vec_extend_from(v, buffer, 6);
+    usize lo, hi, end, start;
+    vec_lower_bound(v, 3, lo);
+    vec_upper_bound(v, 3, hi);
+    vec_lower_bound(v, 9, end);
+    vec_upper_bound(v, 0, start);
+    if (lo == 1 && hi == 4 && end == 6 && start == 0) {
+        printf("vec_bounds: PASSED\n");
+    } else {
+        printf("vec_bounds: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for vec_bsearch
+void test_vec_bsearch() {
+    vec(int) v;
+    vec_init(v);
+    for (int i = 0; i < 100; i++) {
+        vec_push(v, i * 2);
+    }
+    int found, missing;
+    vec_bsearch(v, 42, found);
+    vec_bsearch(v, 43, missing);
+    if (found == 21 && missing == -1) {
+        printf("vec_bsearch: PASSED\n");
+    } else {
+        printf("vec_bsearch: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for vec_sorted_insert
+void test_vec_sorted_insert() {
+    vec(int) v;
+    vec_init(v);
+    int values[] = {5, 1, 4, 1, 3};
+    for (int i = 0; i < 5; i++) {
+        vec_sorted_insert(v, values[i]);
+    }
+    if (v->len == 5 && v->data[0] == 1 && v->data[1] == 1 && v->data[2] == 3 && v->data[3] == 4 && v->data[4] == 5) {
+        printf("vec_sorted_insert: PASSED\n");
+    } else {
+        printf("vec_sorted_insert: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for vec_merge
+void test_vec_merge() {
+    vec(int) a;
+    vec(int) b;
+    vec(int) v;
+    vec_init(a);
+    vec_init(b);
+    vec_init(v);
+    int ba[] = {1, 4, 6, 9};
+    int bb[] = {2, 4, 5, 10, 11};
+    vec_extend_from(a, ba, 4);
+    vec_extend_from(b, bb, 5);
+    vec_merge(v, a, b);
+    int expected[] = {1, 2, 4, 4, 5, 6, 9, 10, 11};
+    if (v->len == 9 && memcmp(v->data, expected, sizeof(expected)) == 0) {
+        printf("vec_merge: PASSED\n");
+    } else {
+        printf("vec_merge: FAILED\n");
+    }
+    vec_free(a);
+    vec_free(b);
+    vec_free(v);
+}
+
+// Test function for vec_unique
+void test_vec_unique() {
+    vec(int) v;
+    vec_init(v);
+    int buffer[] = {1, 1, 2, 3, 3, 3, 4, 4};
+    vec_extend_from(v, buffer, 8);
+    vec_unique(v);
+    if (v->len == 4 && v->data[0] == 1 && v->data[1] == 2 && v->data[2] == 3 && v->data[3] == 4) {
+        printf("vec_unique: PASSED\n");
+    } else {
+        printf("vec_unique: FAILED\n");
+    }
+    vec_free(v);
+}
+
+// Test function for vec_eytzinger
+void test_vec_eytzinger() {
+    vec(int) v;
+    vec(int) e;
+    vec_init(v);
+    vec_init(e);
+    for (int i = 0; i < 1000; i++) {
+        vec_push(v, i * 3);
+    }
+    vec_eytzinger(e, v);
+    bool ok = e->len == v->len;
+    for (int x = -1; x < 3001; x++) {
+        isize k;
+        usize lo;
+        vec_eytzinger_lower_bound(e, x, k);
+        vec_lower_bound(v, x, lo);
+        if (lo == v->len) {
+            ok = ok && k == -1;
+        } else {
+            ok = ok && k >= 0 && e->data[k] == v->data[lo];
+        }
+    }
+    if (ok) {
+        printf("vec_eytzinger: PASSED\n");
+    } else {
+        printf("vec_eytzinger: FAILED\n");
+    }
+    vec_free(v);
+    vec_free(e);
+}
+
 int main() {
     test_vec_init();
     test_vec_reserve();
@@ -390,14 +688,26 @@ int main() {
     test_vec_swap();
     test_vec_extend_from();
     test_vec_extend();
+    test_vec_insert_n();
+    test_vec_remove_all();
+    test_vec_retain();
     test_vec_at();
     test_vec_first();
     test_vec_last();
     test_vec_sort();
     test_vec_find();
     test_vec_reverse();
+    test_vec_reverse_sizes();
+    test_vec_rotate();
+    test_vec_permute();
     test_vec_iter();
     test_vec_enum();
+    test_vec_bounds();
+    test_vec_bsearch();
+    test_vec_sorted_insert();
+    test_vec_merge();
+    test_vec_unique();
+    test_vec_eytzinger();
     return 0;
 }
    